@@ -23,6 +23,7 @@
 
 #include <GenericInterface.h>
 #include <Converter.h>
+#include <SubImage.h>
 
 using namespace filtrme;
 using namespace genericinterface;
@@ -92,8 +93,8 @@ void FilteringService::applyAlgorithm(Filtering* algo)
     if (_siw != NULL)
     {
         const Image* whole_image = _siw->getImage();
-        const Image* im = whole_image->crop(_siw->getSelection());
-        Image_t<int>* im2 = Converter<Image>::convertToInt(*im);
+        const SubImage im(*whole_image, _siw->getSelection());
+        Image_t<int>* im2 = Converter<Image>::convertToInt(im);
         im2 = (*algo)(im2);
         Image* im_res = Converter<Image>::makeDisplayable(*im2);
         StandardImageWindow* siw_res = new StandardImageWindow(_siw->getPath(), _gi, im_res);
@@ -23,6 +23,7 @@
 #include "../Widgets/ImageWidgets/StandardImageWindow.h"
 
 #include <Converter.h>
+#include <SubImage.h>
 
 using namespace genericinterface;
 using namespace imagein;
@@ -52,9 +53,10 @@ void AlgorithmService::applyAlgorithm(GenericAlgorithm_t<Image::depth_t>* algo)
     if (siw != NULL)
     {
         const Image* whole_image = siw->getImage();
-        const Image* im = whole_image->crop(siw->selection());
+        //The algorithm reads the selection in place rather than in a copy.
+        const SubImage im(*whole_image, siw->selection());
 
-        Image* im_res = (*algo)(im);
+        Image* im_res = (*algo)(&im);
         //im_res = Converter<Image>::makeDisplayable(*im_res);
 
         StandardImageWindow* siw_res = new StandardImageWindow(siw->getPath(), im_res);
@@ -124,6 +124,10 @@ void GenericHistogramView::populate(const imagein::Image* image)
   grid->setMajPen(QPen(Qt::black, 0, Qt::DotLine));
   grid->attach(_qwtPlot);
 
+	std::vector<imagein::Histogram> histograms;
+	if(!_projection)
+		histograms = imagein::Histogram::computeAll(*image, _rectangle);
+
 	for(unsigned int i = 0; i < image->getNbChannels(); ++i)
 	{
 		/*imagein::Array<unsigned int>* histogram;
@@ -168,10 +172,10 @@ void GenericHistogramView::populate(const imagein::Image* image)
             graphicalHisto->setValues(imagein::ProjectionHistogram(*image, _value, _horizontal, _rectangle, i));
         }
         else if(_cumulated) {
-            graphicalHisto->setValues(imagein::CumulatedHistogram(*image, i, _rectangle));
+            graphicalHisto->setValues(imagein::CumulatedHistogram(histograms[i]));
         }
         else {
-            graphicalHisto->setValues(imagein::Histogram(*image, i, _rectangle));
+            graphicalHisto->setValues(histograms[i]);
         }
         if(_horizontal)
 			graphicalHisto->setOrientation(Qt::Horizontal);
@@ -186,6 +190,10 @@ void GenericHistogramView::update(const imagein::Image* image, imagein::Rectangl
   
   emit(updateApplicationArea(rect));
   
+  std::vector<imagein::Histogram> histograms;
+  if(!_projection)
+    histograms = imagein::Histogram::computeAll(*image, _rectangle);
+
   for(unsigned int i = 0; i < image->getNbChannels(); ++i)
 	{
 		/*const imagein::Array<unsigned int>& histogram;
@@ -204,7 +212,7 @@ void GenericHistogramView::update(const imagein::Image* image, imagein::Rectangl
 		if(_projection)
             _graphicalHistos[i]->setValues(imagein::ProjectionHistogram(*image, _value, _horizontal, _rectangle, i));
 		else
-            _graphicalHistos[i]->setValues(imagein::Histogram(*image, i, _rectangle));
+            _graphicalHistos[i]->setValues(histograms[i]);
 	}
 }
 
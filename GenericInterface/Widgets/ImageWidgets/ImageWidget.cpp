@@ -42,6 +42,11 @@ void ImageWidget::paintEvent (QPaintEvent* /*event*/ ) {
 
 QImage ImageWidget::convertImage(const imagein::Image* img)
 {
+    //The loops below read the lines one after the other, so the padding of aligned lines is removed first.
+    if(!img->isContiguous()) {
+        const imagein::Image packed(*img, img->getLayout());
+        return convertImage(&packed);
+    }
     unsigned int channels = img->getNbChannels();
 //    bool hasAlpha = (channels== 4 || channels == 2);
 //    QImage qImg(img->getWidth(), img->getHeight(), (hasAlpha ? QImage::Format_ARGB32 : QImage::Format_RGB32));
@@ -51,6 +56,9 @@ QImage ImageWidget::convertImage(const imagein::Image* img)
     //Pour chaque pixel de l'image Qt, on récupère les données correspondantes de l'image ImageIn grace   l'itérateur
     Image::const_iterator it = img->begin();
     int size = qImg.width()*qImg.height();
+    //The channels of a pixel are channelStride apart, so interleaved images are read in place.
+    const unsigned int pixelStride = img->getPixelStride();
+    const unsigned int channelStride = img->getChannelStride();
     switch(channels) {
         case 0: break;
         case 1:
@@ -58,7 +66,7 @@ QImage ImageWidget::convertImage(const imagein::Image* img)
             for(int i = 0; i < size; ++i) {
                 const imagein::Image::depth_t gray = *(it);
                 data[i] = qRgb(gray, gray, gray);
-                ++it;
+                it += pixelStride;
             }
             break;
         }
@@ -66,9 +74,9 @@ QImage ImageWidget::convertImage(const imagein::Image* img)
         {
             for(int i = 0; i < size; ++i) {
                 const imagein::Image::depth_t gray = *(it);
-                const imagein::Image::depth_t alpha = *(it + size);
+                const imagein::Image::depth_t alpha = *(it + channelStride);
                 data[i] = qRgba(gray, gray, gray, alpha);
-                ++it;
+                it += pixelStride;
             }
             break;
         }
@@ -76,10 +84,10 @@ QImage ImageWidget::convertImage(const imagein::Image* img)
         {
             for(int i = 0; i < size; ++i) {
                 const imagein::Image::depth_t red = *(it);
-                const imagein::Image::depth_t green = *(it + size );
-                const imagein::Image::depth_t blue = *(it + size*2 );
+                const imagein::Image::depth_t green = *(it + channelStride);
+                const imagein::Image::depth_t blue = *(it + channelStride*2);
                 data[i] = qRgb(red, green, blue);
-                ++it;
+                it += pixelStride;
             }
             break;
         }
@@ -87,12 +95,12 @@ QImage ImageWidget::convertImage(const imagein::Image* img)
         {
             for(int i = 0; i < size; ++i) {
                 const imagein::Image::depth_t red = *(it);
-                const imagein::Image::depth_t green = *(it + size );
-                const imagein::Image::depth_t blue = *(it + size*2 );
-//                const imagein::Image::depth_t alpha = *(it + size*3 );
+                const imagein::Image::depth_t green = *(it + channelStride);
+                const imagein::Image::depth_t blue = *(it + channelStride*2);
+//                const imagein::Image::depth_t alpha = *(it + channelStride*3);
 //                data[i] = qRgba(red, green, blue, alpha);
                 data[i] = qRgb(red, green, blue);
-                ++it;
+                it += pixelStride;
             }
         }
     }
@@ -132,11 +132,12 @@ void StandardImageWindow::updateStatusBar()
     //Statistics
     QString stats("min : %1\t max : %2\t mean : %3\t standard deviation : %4");
     QString min="", max="", mean="", dev="";
+    const ImageStatistics statistics = _image->getStatistics();
     for(unsigned int c = 0; c < _image->getNbChannels(); ++c) {
-        min += QString("%1").arg(_image->min(c));
-        max += QString("%1").arg(_image->max(c));
-        mean += QString("%1").arg(_image->mean(c), 0, 'f', 1);
-        dev += QString("%1").arg(_image->deviation(c), 0, 'f', 1);
+        min += QString("%1").arg(statistics[c].min);
+        max += QString("%1").arg(statistics[c].max);
+        mean += QString("%1").arg(statistics[c].mean(), 0, 'f', 1);
+        dev += QString("%1").arg(statistics[c].deviation(), 0, 'f', 1);
         if(c < _image->getNbChannels()-1)  {
             min+=" "; max+=" "; mean+=" "; dev+=" ";
         }
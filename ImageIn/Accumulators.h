@@ -0,0 +1,58 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ACCUMULATORS_H
+#define ACCUMULATORS_H
+
+#include "mystdint.h"
+
+namespace imagein
+{
+    /*!
+     * \brief Types used to accumulate the values of an image, and the squares of these values.
+     *
+     * The sums of integer values are 64 bits integers, and so are the sums of their squares up to 16 bits values.
+     * The other sums are doubles.
+     *
+     * \tparam isInteger true if the values are integers
+     * \tparam isSmall true if the values have at most 16 bits
+     */
+    template <bool isInteger, bool isSmall>
+    struct SumAccumulators
+    {
+        typedef double sum_t;
+        typedef double square_t;
+    };
+
+    template <>
+    struct SumAccumulators<true, true>
+    {
+        typedef int64_t sum_t;
+        typedef int64_t square_t;
+    };
+
+    template <>
+    struct SumAccumulators<true, false>
+    {
+        typedef int64_t sum_t;
+        typedef double square_t;
+    };
+}
+
+#endif // ACCUMULATORS_H
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ADAPTIVEBINARIZATION_H
+#define ADAPTIVEBINARIZATION_H
+
+#include "../Image.h"
+#include "../GrayscaleImage.h"
+#include "../Algorithm.h"
+#include "../SlidingHistogram.h"
+
+#include <limits>
+
+namespace imagein 
+{
+    namespace algorithm
+    {
+        /*!
+         * \brief Binarization with a threshold computed for each pixel from its neighbourhood.
+         * 
+         * Unlike Binarization_t and Otsu_t, the threshold follows the local level of the image, which is needed when the
+         * lighting is uneven, as in scanned or photographed documents. The threshold of a pixel is computed from the values
+         * in a square window of (2*radius+1) x (2*radius+1) pixels around it, clipped to the image :
+         *  - METHOD_NIBLACK : T = m + k*s, m and s being the mean and the standard deviation of the window.
+         *  - METHOD_SAUVOLA : T = m * (1 + k*(s/R - 1)), which is less sensitive to the noise of the background.
+         *  - METHOD_LOCAL_OTSU : the Otsu threshold of the histogram of the window.
+         *
+         * As with Binarization_t, the pixels with value <= T are black, the others are white.
+         *
+         * The window is a SlidingHistogram, so the cost per pixel doesn't depend on the radius. Images that are not 8-bit are
+         * quantized to 256 levels between their minimum and maximum values, and the thresholds are computed on these levels.
+         *
+         * Arity : 1 \n
+         * Input type : GrayscaleImage_t<D> \n
+         * Output type : GraysaleImage_t<D> \n
+         * Complexity : O(n*m) with n and m being the width and height of the image, times 256 for METHOD_LOCAL_OTSU.
+         *
+         * \tparam D the depth of the input and output image
+         */
+        template <typename D>
+        class AdaptiveBinarization_t : public Algorithm_t<GrayscaleImage_t<D>, 1>
+        {
+            public:
+                //! Way of computing the threshold of a pixel.
+                enum Method { METHOD_NIBLACK, METHOD_SAUVOLA, METHOD_LOCAL_OTSU };
+
+                /*!
+                 * \brief Constructor with the usual parameters of the method.
+                 *
+                 * k is -0.2 for METHOD_NIBLACK and 0.5 for METHOD_SAUVOLA, R is 128.
+                 *
+                 * \param method The way of computing the thresholds.
+                 * \param radius The radius of the window.
+                 */
+                AdaptiveBinarization_t(Method method = METHOD_SAUVOLA, unsigned int radius = 7)
+                  : _method(method), _radius(radius), _k(method == METHOD_NIBLACK ? -0.2 : 0.5), _r(128.) {}
+
+                /*!
+                 * \brief Constructor with given parameters.
+                 *
+                 * \param method The way of computing the thresholds.
+                 * \param radius The radius of the window.
+                 * \param k The weight of the standard deviation, for METHOD_NIBLACK and METHOD_SAUVOLA.
+                 * \param r The dynamic range of the standard deviation, for METHOD_SAUVOLA, on 256 levels.
+                 */
+                AdaptiveBinarization_t(Method method, unsigned int radius, double k, double r = 128.)
+                  : _method(method), _radius(radius), _k(k), _r(r) {}
+
+            protected:
+
+                /*! Implementation of the algorithm.
+                 * 
+                 * see the documentation of GenericAlgorithm_t, SpecificAlgorithm_t and Algorithm_t for
+                 * informations on the Algorithm interface.
+                 */
+                GrayscaleImage_t<D>* algorithm(const std::vector<const Image_t<D>*>& imgs);
+            
+            private:
+                class StripTask;
+
+                //! Binarizes the lines [begin, end[, given the 8 bits levels of the lines of the image.
+                void binarizeStrip(const std::vector<const uint8_t*>& lines, GrayscaleImage_t<D>* result, unsigned int begin, unsigned int end) const;
+
+                //! Returns the threshold of the pixel at the center of the window, on 256 levels.
+                inline double threshold(const SlidingHistogram& window) const;
+
+                //! Returns the Otsu threshold of the histogram of a window.
+                static unsigned int otsuThreshold(const SlidingHistogram& window);
+
+                Method _method;
+                unsigned int _radius;
+                double _k;
+                double _r;
+        };
+
+        typedef AdaptiveBinarization_t<depth_default_t> AdaptiveBinarization; //!< Standard Algorithm with default depth. See Image_t::depth_default_t
+    }
+}
+
+#include "AdaptiveBinarization.tpp"
+
+#endif
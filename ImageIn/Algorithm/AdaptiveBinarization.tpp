@@ -0,0 +1,183 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//#include "AdaptiveBinarization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "../ThreadPool.h"
+
+namespace imagein {
+	namespace algorithm {
+		template<typename D>
+		class AdaptiveBinarization_t<D>::StripTask : public ParallelTask
+		{
+			public:
+				StripTask(const AdaptiveBinarization_t<D>& algo, const std::vector<const uint8_t*>& lines, GrayscaleImage_t<D>* result,
+				          const std::vector<unsigned int>& rows)
+				 : _algo(algo), _lines(lines), _result(result), _rows(rows) {}
+
+				void run(unsigned int begin, unsigned int end) {
+					for(unsigned int s = begin ; s < end ; ++s) {
+						_algo.binarizeStrip(_lines, _result, _rows[s], _rows[s+1]);
+					}
+				}
+
+			private:
+				const AdaptiveBinarization_t<D>& _algo;
+				const std::vector<const uint8_t*>& _lines;
+				GrayscaleImage_t<D>* _result;
+				const std::vector<unsigned int>& _rows;
+		};
+
+		template<typename D>
+		GrayscaleImage_t<D>* AdaptiveBinarization_t<D>::algorithm(const std::vector<const Image_t<D>*>& imgs)
+		{
+			if(imgs.at(0)->getNbChannels()>1) {
+				throw ImageTypeException(__LINE__, __FILE__);
+			}
+			const Image_t<D>* img = imgs.at(0);
+			const unsigned int width = img->getWidth();
+			const unsigned int height = img->getHeight();
+
+			//The 8 bits levels of each line, read directly from 8-bit images.
+			std::vector<const uint8_t*> lines(height);
+			std::vector<uint8_t> levels;
+			if(std::numeric_limits<D>::is_integer && sizeof(D) == 1) {
+				for(unsigned int j = 0 ; j < height ; ++j) {
+					lines[j] = reinterpret_cast<const uint8_t*>(img->begin() + j * img->getRowStride());
+				}
+			}
+			else {
+				levels.resize(static_cast<std::size_t>(width) * height);
+				double min = std::numeric_limits<double>::max(), max = -min;
+				for(unsigned int j = 0 ; j < height ; ++j) {
+					const D* line = img->begin() + j * img->getRowStride();
+					for(unsigned int i = 0 ; i < width ; ++i) {
+						const double v = static_cast<double>(line[i]);
+						if(v < min) min = v;
+						if(v > max) max = v;
+					}
+				}
+				const double scale = (max > min) ? 255. / (max - min) : 0.;
+				for(unsigned int j = 0 ; j < height ; ++j) {
+					const D* line = img->begin() + j * img->getRowStride();
+					uint8_t* out = &levels[static_cast<std::size_t>(j) * width];
+					for(unsigned int i = 0 ; i < width ; ++i) {
+						out[i] = static_cast<uint8_t>((static_cast<double>(line[i]) - min) * scale + 0.5);
+					}
+					lines[j] = out;
+				}
+			}
+
+			GrayscaleImage_t<D>* result = new GrayscaleImage_t<D>(width, height);
+
+			//Each strip fills its window with the lines around its first line, so the radius may exceed the height of a strip.
+			const unsigned int minStripHeight = 32;
+			unsigned int nStrips = ThreadPool::instance().getNbThreads();
+			nStrips = std::max(1u, std::min(nStrips, height / minStripHeight));
+			std::vector<unsigned int> rows(nStrips + 1);
+			for(unsigned int s = 0 ; s <= nStrips ; ++s) {
+				rows[s] = (s * height) / nStrips;
+			}
+			StripTask strips(*this, lines, result, rows);
+			ThreadPool::instance().parallelFor(strips, 0, nStrips, 1);
+
+			return result;
+		}
+
+		template<typename D>
+		void AdaptiveBinarization_t<D>::binarizeStrip(const std::vector<const uint8_t*>& lines, GrayscaleImage_t<D>* result, unsigned int begin, unsigned int end) const
+		{
+			if(begin >= end) return;
+			const unsigned int width = result->getWidth();
+			const unsigned int height = result->getHeight();
+			const D white = std::numeric_limits<D>::max();
+			SlidingHistogram window(width, _radius, _method == METHOD_LOCAL_OTSU);
+
+			//Lines [first, last] of the window of the line begin.
+			for(unsigned int j = (begin > _radius ? begin - _radius : 0) ; j <= begin + _radius && j < height ; ++j) {
+				window.addLine(lines[j]);
+			}
+			for(unsigned int j = begin ; j < end ; ++j) {
+				if(j > begin) {
+					if(j > _radius) window.removeLine(lines[j - _radius - 1]);
+					if(j + _radius < height) window.addLine(lines[j + _radius]);
+				}
+				const uint8_t* in = lines[j];
+				D* out = result->begin() + j * result->getRowStride();
+				window.startLine();
+				for(unsigned int i = 0 ; i < width ; ++i) {
+					if(i > 0) window.moveRight();
+					out[i] = (in[i] <= threshold(window)) ? 0 : white;
+				}
+			}
+		}
+
+		template<typename D>
+		inline double AdaptiveBinarization_t<D>::threshold(const SlidingHistogram& window) const
+		{
+			if(_method == METHOD_LOCAL_OTSU) {
+				return otsuThreshold(window);
+			}
+			const double count = window.getCount();
+			const double mean = window.getSum() / count;
+			const double variance = std::max(0., window.getSumOfSquares() / count - mean * mean);
+			const double deviation = std::sqrt(variance);
+			if(_method == METHOD_NIBLACK) {
+				return mean + _k * deviation;
+			}
+			return mean * (1. + _k * (deviation / _r - 1.));
+		}
+
+		template<typename D>
+		unsigned int AdaptiveBinarization_t<D>::otsuThreshold(const SlidingHistogram& window)
+		{
+			//Same criterion as Otsu_t : the threshold maximizing the between-class variance.
+			//The weights and sums are accumulated as integers. The variances are stored and their maximum is found
+			//without branching, as the variances of sparse histograms go up and down unpredictably.
+			const unsigned int* bins = window.getBins();
+			const unsigned int nPixel = window.getCount();
+			const double n = nPixel;
+			const double sum = static_cast<double>(window.getSum());
+			unsigned int first = 0;
+			while(bins[first] == 0) ++first;
+			double variances[256];
+			double maxVariance = 0;
+			unsigned int weightb = 0;
+			uint64_t sumb = 0;
+			for(unsigned int thresh = first ; thresh < 256 ; ++thresh) {
+				weightb += bins[thresh];
+				if(weightb == nPixel) break;
+				sumb += static_cast<uint64_t>(thresh) * bins[thresh];
+				//weightb*weightw*(meanb-meanw)^2, with the means expanded.
+				const double weight = weightb;
+				const double diff = static_cast<double>(sumb) * n - sum * weight;
+				const double variance = diff * diff / (weight * (n - weight));
+				variances[thresh] = variance;
+				maxVariance = (variance > maxVariance) ? variance : maxVariance;
+			}
+			if(maxVariance == 0) return 0;
+			unsigned int chosenThreshold = first;
+			while(variances[chosenThreshold] != maxVariance) ++chosenThreshold;
+			return chosenThreshold;
+		}
+	}
+}
@@ -23,6 +23,9 @@
 #include "../Image.h"
 #include "../GrayscaleImage.h"
 #include "../Algorithm.h"
+#include "../LookupTable.h"
+
+#include <limits>
 
 namespace imagein 
 {
@@ -72,6 +75,14 @@ namespace imagein
                 Binarization_t(D infThreshold, D supThreshold, bool blackBand = false) 
                   : _threshold(infThreshold), _threshold2(supThreshold), _blackBand(blackBand) {};
 
+                /*!
+                 * \brief Binarizes an image in place, without creating another image.
+                 *
+                 * \param img The image to binarize.
+                 * \throw ImageTypeException if the image has more than one channel.
+                 */
+                void applyInPlace(Image_t<D>& img) const;
+
             protected:
 
                 /*! Implementation of the algorithm.
@@ -82,6 +93,18 @@ namespace imagein
                 GrayscaleImage_t<D>* algorithm(const std::vector<const Image_t<D>*>& imgs);
             
             private:
+                //! Returns the binarized value of a pixel.
+                inline D binarize(D value) const {
+                    if(_threshold2 > _threshold) { //if there's 2 thresholds
+                        const bool inBand = (_threshold < value && value < _threshold2);
+                        return (inBand == _blackBand) ? std::numeric_limits<D>::max() : 0;
+                    }
+                    return (value <= _threshold) ? 0 : std::numeric_limits<D>::max();
+                }
+
+                //! Returns the table of binarize(), for 8 bits depths.
+                LookupTable lookupTable() const;
+
                 D _threshold;
                 D _threshold2;
                 bool _blackBand;
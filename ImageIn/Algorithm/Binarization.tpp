@@ -32,28 +32,44 @@ namespace imagein {
 			if(imgs.at(0)->getNbChannels()>1) {
 				throw ImageTypeException(__LINE__, __FILE__);
 			}
-            const GrayscaleImage_t<D>* img = Converter<GrayscaleImage_t<D> >::convert(*imgs.at(0));
+            const Image_t<D>* img = imgs.at(0);
 
-			D* data = new D[img->getWidth() * img->getHeight()];
-			D* out = data;
-			for(typename GrayscaleImage_t<D>::const_iterator it = img->begin() ; it != img->end() ; ++it) {
-				if(_threshold2 > _threshold) { //if there's 2 thresholds
-					if(_threshold < *it && *it < _threshold2) { 
-						*(out++) = (_blackBand) ? std::numeric_limits<D>::max() : 0;
-					}
-					else {
-						*(out++) = (!_blackBand) ? std::numeric_limits<D>::max() : 0;
-					}
-				}
-				else {
-					*(out++) = (*it <= _threshold) ? 0 : std::numeric_limits<D>::max();
-				}
-			
+			GrayscaleImage_t<D>* result = new GrayscaleImage_t<D>(img->getWidth(), img->getHeight());
+			if(std::numeric_limits<D>::is_integer && sizeof(D) == 1) {
+				lookupTable().apply(*img, *result);
+				return result;
+			}
+			typename GrayscaleImage_t<D>::channel_iterator out = result->channelBegin(0);
+			for(typename Image_t<D>::const_channel_iterator it = img->channelBegin(0) ; it != img->channelEnd(0) ; ++it, ++out) {
+				*out = binarize(*it);
 			}
-
-			GrayscaleImage_t<D>* result = new GrayscaleImage_t<D>(img->getWidth(), img->getHeight(), data);
-            delete img;
             return result;
 		}
+
+		template<typename D>
+		void Binarization_t<D>::applyInPlace(Image_t<D>& img) const
+		{
+			if(img.getNbChannels()>1) {
+				throw ImageTypeException(__LINE__, __FILE__);
+			}
+			if(std::numeric_limits<D>::is_integer && sizeof(D) == 1) {
+				lookupTable().applyInPlace(img);
+				return;
+			}
+			const typename Image_t<D>::channel_iterator end = img.channelEnd(0);
+			for(typename Image_t<D>::channel_iterator it = img.channelBegin(0) ; it != end ; ++it) {
+				*it = binarize(*it);
+			}
+		}
+
+		template<typename D>
+		LookupTable Binarization_t<D>::lookupTable() const
+		{
+			LookupTable table;
+			for(unsigned int v = 0; v < 256; ++v) {
+				table[v] = static_cast<uint8_t>(binarize(static_cast<D>(v)));
+			}
+			return table;
+		}
 	}
 }
@@ -24,10 +24,11 @@
 #include "../GrayscaleImage.h"
 #include "../Algorithm.h"
 #include "../RgbImage.h"
+#include "../ThreadPool.h"
+#include "../Rectangle.h"
 
 #include <vector>
-#include <list>
-#include <map>
+#include <algorithm>
 
 namespace imagein 
 {
@@ -42,6 +43,16 @@ namespace imagein
          *
          * Explanation of the algorithm : http://en.wikipedia.org/wiki/Connected-component_labeling
          *
+         * The first pass visits the neighbours of each pixel in the order of the decision tree of Wu, Otoo and Suzuki, which
+         * minimizes the number of neighbours read and of merges. The equivalences between labels are stored in a flat
+         * union-find with path compression and union by rank, so the whole labeling is linear in the number of pixels.
+         *
+         * By default, the image is cut in horizontal strips which are labeled in parallel in the ThreadPool, then the labels
+         * of the pixels on each side of the boundaries between strips are merged. The result is the same as the sequential labeling.
+         *
+         * The statistics of each component (area, bounding box, centroid and perimeter) are accumulated during the labeling,
+         * and the image of the labels can be obtained instead of the coloured image with label().
+         *
          * Arity : 1 \n
          * Input type :  GrayscaleImage_t<D> \n
          * Output type : RgbImage_t<D> \n
@@ -56,6 +67,15 @@ namespace imagein
 				//! Connectivity to use for the objects.
 				typedef enum {CONNECT_8, CONNECT_4} Connectivity;
 				
+				//! Measures of a connected component.
+				struct ComponentStats
+				{
+					unsigned int area; //!< Number of pixels of the component.
+					Rectangle boundingBox; //!< Smallest rectangle containing the component.
+					double centroidX, centroidY; //!< Average position of the pixels of the component.
+					unsigned int perimeter; //!< Number of sides of the pixels of the component which are on its border.
+				};
+				
                 /*!
                  * \brief Default constructor. Allows to specify the parameters of the algorithm.
                  *
@@ -66,10 +86,31 @@ namespace imagein
                  * Binary Image.
                  */
                 ComponentLabeling_t(Connectivity connect = CONNECT_8, bool blackBackground = false, bool binarizeInput = false) 
-				 : _connect(connect), _blackBackground(blackBackground), _binarizeInput(binarizeInput) {};
+				 : _connect(connect), _blackBackground(blackBackground), _binarizeInput(binarizeInput), _parallel(true) {};
+			 
+                /*!
+                 * \brief Enables or disables the labeling of the image by strips in parallel.
+                 *
+                 * The result doesn't depend on it. Enabled by default.
+                 */
+                inline void setParallel(bool parallel) { _parallel = parallel; }
+			 
+                /*!
+                 * \brief Labels the connected components of an image.
+                 *
+                 * The background has the label 0, and the i-th component, in the order of their first pixel, has the label i+1.
+                 *
+                 * \param img The image to label, which must be a GrayscaleImage_t.
+                 * \return A new image of the labels.
+                 * \throw ImageTypeException if img isn't a GrayscaleImage_t.
+                 */
+                GrayscaleImage_t<unsigned int>* label(const Image_t<D>* img);
 			 
                 //! Returns the number of components found in the image.
-				unsigned int getNbComponents() const { return _nameToColour.size(); };
+				unsigned int getNbComponents() const { return _componentStats.size(); };
+				
+                //! Returns the measures of the components, the component of label i+1 being at index i.
+				const std::vector<ComponentStats>& getComponentStats() const { return _componentStats; }
 
                 //!Returns the average size of the components.
 				double getAverageComponentSize() const;
@@ -88,30 +129,87 @@ namespace imagein
 				Connectivity _connect;
 				bool _blackBackground;
 				bool _binarizeInput;
-				std::map<unsigned int, unsigned int> _nameToColour;
-				std::map<unsigned int, unsigned int> _nameToSize;
+				bool _parallel;
+				//! Measures of each component, the components being numbered in the order of their first pixel.
+				std::vector<ComponentStats> _componentStats;
+				
+				//Sums accumulated for each label during the first pass.
+				struct Accumulator
+				{
+					unsigned int area, minX, minY, maxX, maxY, perimeter;
+					double sumX, sumY;
+					
+					Accumulator(unsigned int x, unsigned int y)
+					 : area(0), minX(x), minY(y), maxX(x), maxY(y), perimeter(0), sumX(0), sumY(0) {}
+					
+					inline void add(unsigned int x, unsigned int y, unsigned int sides) {
+						++area;
+						minX = std::min(minX, x);
+						maxX = std::max(maxX, x);
+						maxY = y;
+						sumX += x;
+						sumY += y;
+						perimeter += sides;
+					}
+					
+					Accumulator& operator+=(const Accumulator& other) {
+						area += other.area;
+						minX = std::min(minX, other.minX);
+						minY = std::min(minY, other.minY);
+						maxX = std::max(maxX, other.maxX);
+						maxY = std::max(maxY, other.maxY);
+						perimeter += other.perimeter;
+						sumX += other.sumX;
+						sumY += other.sumY;
+						return *this;
+					}
+				};
 				
 				class DisjointSet
 				{
 					public:
 						
-						//Insert a new subset with its representative
-						void makeSet();
+						//Inserts a new set of one element, and returns this element.
+						unsigned int makeSet();
+						
+						//Merges the sets of two elements, and returns the representative of the union.
+						unsigned int merge(unsigned int e1, unsigned int e2);
+						
+						//Returns the representative of the set of an element, compressing the path to it.
+						unsigned int find(unsigned int e);
 						
-						//Merge two sets
-						void merge(unsigned int s1, unsigned int s2);
+						//Returns the number of elements.
+						unsigned int size() const { return _parent.size(); }
 						
-						//Finds in which subset an element is. If it is in several subset, the first is returned.
-						unsigned int find(unsigned int e) const;
+						//Appends the elements of another set, their numbers being shifted by the size of this one.
+						void append(const DisjointSet& other);
 						
 						//Clears the table.
-						void clear() { _tab.clear(); }
+						void clear() { _parent.clear(); _rank.clear(); }
 						
 					private:
-						std::vector<std::list<unsigned int>* > _tab;
+						std::vector<unsigned int> _parent;
+						std::vector<unsigned char> _rank;
 				};
 				
 				DisjointSet _synonyms;
+				
+				/*!
+				 * \brief First pass on the lines [firstRow, endRow[, the line before being considered as background.
+				 *
+				 * \param labels The labels of the image, the labels of the strip being numbered from 0 in set.
+				 * \param set Receives the equivalences between the labels of the strip.
+				 * \param stats Receives the sums of each label of the strip.
+				 */
+				void labelStrip(const GrayscaleImage_t<D>* img, D foreground, unsigned int* labels, unsigned int firstRow, unsigned int endRow,
+				                DisjointSet& set, std::vector<Accumulator>& stats) const;
+				
+				//! Labels a binary image, the labels being numbered as in label(), and computes the statistics of the components.
+				void labelBinary(const GrayscaleImage_t<D>* img, unsigned int* labels);
+				
+				//! Tasks labeling and relabeling the strips in the ThreadPool.
+				class StripTask;
+				class RelabelTask;
         };
 
         typedef ComponentLabeling_t<depth_default_t> ComponentLabeling; //!< Standard Algorithm with default depth. See Image_t::depth_default_t
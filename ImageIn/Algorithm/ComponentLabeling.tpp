@@ -28,145 +28,46 @@ namespace imagein {
 	namespace algorithm {
 
 		template <typename D>
-		RgbImage_t<D>* ComponentLabeling_t<D>::algorithm(const std::vector<const Image_t<D>*>& imgs)
+		GrayscaleImage_t<unsigned int>* ComponentLabeling_t<D>::label(const Image_t<D>* image)
 		{
-			_nameToColour.clear();
-			_nameToSize.clear();
-			_synonyms.clear();
-			
-			const GrayscaleImage_t<D>* img = dynamic_cast<const GrayscaleImage_t<D>*>(imgs.at(0));
+			const GrayscaleImage_t<D>* img = dynamic_cast<const GrayscaleImage_t<D>*>(image);
 			if(img == NULL) {
 				throw ImageTypeException(__LINE__, __FILE__);
 			}
 			
 			//Binarize input image if needed
+			const GrayscaleImage_t<D>* binarized = NULL;
 			if(_binarizeInput) {
 				Otsu_t<D> o;
-				img = o(img);
+				img = binarized = o(img);
 			}
 			
-			//foreground color
-			D foreground = (_blackBackground) ? std::numeric_limits<D>::max() : 0; 
-			
-			//Create label matrix.
-			unsigned int* labels = new unsigned int[img->getWidth() * img->getHeight()];
+			GrayscaleImage_t<unsigned int>* result = new GrayscaleImage_t<unsigned int>(img->getWidth(), img->getHeight());
+			labelBinary(img, result->begin());
+			delete binarized;
 			
-			//First pass.
-			unsigned int curLabel = 0;
-			
-			if(img->getPixel(0, 0) == foreground) { //first cell
-				labels[0] = curLabel++;
-				_synonyms.makeSet();
-			}
-			else {
-				labels[0] = -1;
-			}	
-			
-			for(unsigned int i = 1 ; i < img->getWidth() ; ++i) { //first line
-				if(img->getPixel(i, 0) == foreground) {
-					if(img->getPixel(i-1, 0) == foreground) {
-						labels[i] = labels[i-1];
-					}
-					else {
-						labels[i] = curLabel++;
-						_synonyms.makeSet();
-					}
-				}
-				else {
-					labels[i] = -1;
-				}
+			return result;
+		}
+		
+		template <typename D>
+		RgbImage_t<D>* ComponentLabeling_t<D>::algorithm(const std::vector<const Image_t<D>*>& imgs)
+		{
+			const GrayscaleImage_t<D>* img = dynamic_cast<const GrayscaleImage_t<D>*>(imgs.at(0));
+			if(img == NULL) {
+				throw ImageTypeException(__LINE__, __FILE__);
 			}
 			
-			for(unsigned int j = 1 ; j < img->getHeight() ; ++j) {
-				
-				//first cell
-				if(img->getPixel(0, j) == foreground) {
-					std::vector<unsigned int> neighbours;
-
-					if(_connect == CONNECT_8 && img->getPixel(1, j-1) == foreground) {
-						neighbours.push_back(labels[1+(j-1)*img->getWidth()]);
-					}
-					if(img->getPixel(0, j-1) == foreground) {
-						neighbours.push_back(labels[(j-1)*img->getWidth()]);
-					}
-					
-					if(neighbours.size() == 0) {
-						labels[j*img->getWidth()] = curLabel++;
-						_synonyms.makeSet();
-					}
-					else {
-						std::sort(neighbours.begin(), neighbours.end());
-						labels[j*img->getWidth()] = neighbours[0];
-						for(unsigned int k = 1 ; k < neighbours.size() ; ++k) {
-							_synonyms.merge(neighbours.at(0), neighbours.at(k));
-						}
-					}
-				}
-				else {
-					labels[j*img->getWidth()] = -1;
-				}
-				
-				//rest of the line
-				for(unsigned int i = 1 ; i < img->getWidth() ; ++i) {
-					if(img->getPixel(i, j) == foreground) {
-						std::vector<unsigned int> neighbours;
-						if(_connect == CONNECT_8) {
-							if(img->getPixel(i-1, j-1) == foreground) {
-								neighbours.push_back(labels[i-1+(j-1)*img->getWidth()]);
-							}
-							
-							try { //we may be on the last cell...
-								if(img->getPixel(i+1, j-1) == foreground) {
-									neighbours.push_back(labels[i+1+(j-1)*img->getWidth()]);
-								}
-							}
-							catch(std::out_of_range) {}
-						}
-						if(img->getPixel(i, j-1) == foreground) {
-							neighbours.push_back(labels[i+(j-1)*img->getWidth()]);
-						}
-						if(img->getPixel(i-1, j) == foreground) {
-							neighbours.push_back(labels[i-1+j*img->getWidth()]);
-						}
-						
-						if(neighbours.size() == 0) {
-							labels[i + j*img->getWidth()] = curLabel++;
-							_synonyms.makeSet();
-						}
-						else {
-							std::sort(neighbours.begin(), neighbours.end());
-							labels[i + j*img->getWidth()] = neighbours.at(0);
-							for(unsigned int k = 1 ; k < neighbours.size() ; ++k) {
-								if(neighbours.at(0) != neighbours.at(k)) {
-									_synonyms.merge(neighbours.at(0), neighbours.at(k));
-								}
-							}
-						}
-					}
-					else {
-						labels[i + j*img->getWidth()] = -1;
-					}
-				}
+			//Binarize input image if needed
+			const GrayscaleImage_t<D>* binarized = NULL;
+			if(_binarizeInput) {
+				Otsu_t<D> o;
+				img = binarized = o(img);
 			}
-			//end first pass. Each pixel has a label, synonyms table is full.
 			
-			//second pass
-			unsigned int colourNo = 0;
-			for(unsigned int j = 0 ; j < img->getHeight() ; ++j) {
-				for(unsigned int i = 0 ; i < img->getWidth() ; ++i) {
-					if(img->getPixel(i, j) == foreground) {
-						unsigned int name = _synonyms.find(labels[i + j*img->getWidth()]);
-						labels[i + j*img->getWidth()] = name;
-						if(_nameToColour.count(name) == 0) {
-							_nameToColour.insert(std::pair<unsigned int, unsigned int>(name, colourNo++));
-							_nameToSize.insert(std::pair<unsigned int, unsigned int>(name, 0));
-						}
-						
-						_nameToSize[name]++;
-					}
-						
-				}
-			}
+			const unsigned int width = img->getWidth();
+			const unsigned int height = img->getHeight();
+			std::vector<unsigned int> labels(width * height);
+			labelBinary(img, &labels[0]);
 			
 			D** colours;
 			if(getNbComponents() > 0) {
@@ -217,18 +118,20 @@ namespace imagein {
 			
 			int step = (getNbComponents() / 3) - 1;
 			
-			D* data = new D[img->getWidth() * img->getHeight() * 3];
-			for(unsigned int j = 0 ; j < img->getHeight() ; ++j) {
-				for(unsigned int i = 0 ; i < img->getWidth() ; ++i) {
-					if(img->getPixel(i, j) == foreground) {
-						data[3*i + 3*j*img->getWidth()] = colours[((_nameToColour.find(labels[i + j*img->getWidth()])->second) * step)%getNbComponents()][0];
-						data[3*i + 3*j*img->getWidth() + 1] = colours[((_nameToColour.find(labels[i + j*img->getWidth()])->second) * step)%getNbComponents()][1];
-						data[3*i + 3*j*img->getWidth() + 2] = colours[((_nameToColour.find(labels[i + j*img->getWidth()])->second) * step)%getNbComponents()][2];
+			RgbImage_t<D>* result = new RgbImage_t<D>(width, height);
+			const unsigned int size = width * height;
+			D* data = result->begin();
+			for(unsigned int j = 0, p = 0 ; j < height ; ++j) {
+				const D* pixels = img->begin() + j * img->getRowStride();
+				for(unsigned int i = 0 ; i < width ; ++i, ++p) {
+					if(labels[p] != 0) {
+						const D* colour = colours[((labels[p] - 1) * step) % getNbComponents()];
+						data[p] = colour[0];
+						data[p + size] = colour[1];
+						data[p + 2*size] = colour[2];
 					}
 					else {
-						data[3*i + 3*j*img->getWidth()] = img->getPixel(i,j);
-						data[3*i + 3*j*img->getWidth() + 1] = img->getPixel(i,j);
-						data[3*i + 3*j*img->getWidth() + 2] = img->getPixel(i,j);
+						data[p] = data[p + size] = data[p + 2*size] = pixels[i];
 					}
 				}
 			}
@@ -236,61 +139,287 @@ namespace imagein {
 			for(unsigned int i = 0 ; i < getNbComponents() ; ++i) {
 				delete[] colours[i];
 			}
-			delete[] colours;
+			if(getNbComponents() > 0) {
+				delete[] colours;
+			}
+			delete binarized;
 			
-			return new RgbImage_t<D>(img->getWidth(), img->getHeight(), data);
+			return result;
 		}
 
+		template <typename D>
+		void ComponentLabeling_t<D>::labelBinary(const GrayscaleImage_t<D>* img, unsigned int* labels)
+		{
+			_componentStats.clear();
+			_synonyms.clear();
+			
+			//foreground color
+			D foreground = (_blackBackground) ? std::numeric_limits<D>::max() : 0; 
+			
+			const unsigned int width = img->getWidth();
+			const unsigned int height = img->getHeight();
+			const unsigned int background = std::numeric_limits<unsigned int>::max();
+			
+			//Strips of at least minStripHeight lines, one for each thread.
+			const unsigned int minStripHeight = 32;
+			unsigned int nStrips = _parallel ? ThreadPool::instance().getNbThreads() : 1;
+			nStrips = std::max(1u, std::min(nStrips, height / minStripHeight));
+			std::vector<unsigned int> rows(nStrips + 1);
+			for(unsigned int s = 0 ; s <= nStrips ; ++s) {
+				rows[s] = (s * height) / nStrips;
+			}
+			
+			//First pass, each strip having its own labels.
+			std::vector<DisjointSet> sets(nStrips);
+			std::vector<std::vector<Accumulator> > stats(nStrips);
+			StripTask strips(*this, img, foreground, labels, rows, sets, stats);
+			ThreadPool::instance().parallelFor(strips, 0, nStrips, 1);
+			
+			//The labels of the strip s are shifted by offsets[s] in the merged table.
+			std::vector<unsigned int> offsets(nStrips);
+			std::vector<Accumulator> labelStats;
+			for(unsigned int s = 0 ; s < nStrips ; ++s) {
+				offsets[s] = _synonyms.size();
+				_synonyms.append(sets[s]);
+				labelStats.insert(labelStats.end(), stats[s].begin(), stats[s].end());
+			}
+			
+			//Merge the labels of the components which cross the boundaries between strips.
+			//a b c
+			//  e
+			for(unsigned int s = 1 ; s < nStrips ; ++s) {
+				const unsigned int* lrow = labels + rows[s] * width;
+				const unsigned int* lprev = lrow - width;
+				for(unsigned int i = 0 ; i < width ; ++i) {
+					if(lrow[i] == background) continue;
+					const unsigned int e = offsets[s] + lrow[i];
+					if(lprev[i] != background) {
+						_synonyms.merge(e, offsets[s-1] + lprev[i]);
+						if(_connect == CONNECT_8) continue; //a and c are neighbours of b.
+					}
+					if(_connect == CONNECT_8) {
+						if(i > 0 && lprev[i-1] != background) _synonyms.merge(e, offsets[s-1] + lprev[i-1]);
+						if(i + 1 < width && lprev[i+1] != background) _synonyms.merge(e, offsets[s-1] + lprev[i+1]);
+					}
+				}
+			}
+			//end first pass. Each pixel has a label, synonyms table is full.
+			
+			//The first pixel of a component in raster order always gets a new label, and the labels of the strips
+			//are in raster order too, so numbering the sets in the order of their smallest label numbers the components
+			//in the order of their first pixel.
+			std::vector<unsigned int> labelToComponent(_synonyms.size());
+			std::vector<Accumulator> components;
+			std::vector<unsigned int> rootToComponent(_synonyms.size(), background);
+			for(unsigned int l = 0 ; l < _synonyms.size() ; ++l) {
+				const unsigned int root = _synonyms.find(l);
+				if(rootToComponent[root] == background) {
+					rootToComponent[root] = components.size();
+					components.push_back(labelStats[l]);
+				}
+				else {
+					components[rootToComponent[root]] += labelStats[l];
+				}
+				labelToComponent[l] = rootToComponent[root];
+			}
+			
+			_componentStats.resize(components.size());
+			for(unsigned int c = 0 ; c < components.size() ; ++c) {
+				const Accumulator& acc = components[c];
+				ComponentStats& component = _componentStats[c];
+				component.area = acc.area;
+				component.boundingBox = Rectangle(acc.minX, acc.minY, acc.maxX - acc.minX + 1, acc.maxY - acc.minY + 1);
+				component.centroidX = acc.sumX / static_cast<double>(acc.area);
+				component.centroidY = acc.sumY / static_cast<double>(acc.area);
+				component.perimeter = acc.perimeter;
+			}
+			
+			//second pass
+			RelabelTask relabel(labels, width, rows, offsets, labelToComponent);
+			ThreadPool::instance().parallelFor(relabel, 0, nStrips, 1);
+		}
+
+		template <typename D>
+		void ComponentLabeling_t<D>::labelStrip(const GrayscaleImage_t<D>* img, D foreground, unsigned int* labels, unsigned int firstRow, unsigned int endRow,
+		                                        DisjointSet& set, std::vector<Accumulator>& stats) const
+		{
+			const unsigned int width = img->getWidth();
+			const unsigned int height = img->getHeight();
+			const unsigned int rowStride = img->getRowStride();
+			const unsigned int background = std::numeric_limits<unsigned int>::max();
+			
+			//The label of a neighbour is background if it's out of the strip or not in the foreground.
+			//a b c
+			//d e
+			for(unsigned int j = firstRow ; j < endRow ; ++j) {
+				const D* row = img->begin() + j * rowStride;
+				unsigned int* lrow = labels + j * width;
+				const unsigned int* lprev = lrow - width;
+				const bool top = (j == firstRow);
+				
+				for(unsigned int i = 0 ; i < width ; ++i) {
+					if(row[i] != foreground) {
+						lrow[i] = background;
+						continue;
+					}
+					const unsigned int b = top ? background : lprev[i];
+					const unsigned int d = (i > 0) ? lrow[i-1] : background;
+					unsigned int e;
+					
+					if(_connect == CONNECT_4) {
+						if(b != background) {
+							e = (d != background) ? set.merge(b, d) : b;
+						}
+						else {
+							e = (d != background) ? d : set.makeSet();
+						}
+					}
+					//b is a neighbour of a, c and d : if it is in the foreground, they are already in its set.
+					else if(b != background) {
+						e = b;
+					}
+					else {
+						const unsigned int a = (!top && i > 0) ? lprev[i-1] : background;
+						const unsigned int c = (!top && i + 1 < width) ? lprev[i+1] : background;
+						if(c != background) {
+							if(a != background) e = set.merge(c, a);
+							else if(d != background) e = set.merge(c, d);
+							else e = c;
+						}
+						else if(a != background) e = a;
+						else if(d != background) e = d;
+						else e = set.makeSet();
+					}
+					
+					lrow[i] = e;
+					if(e >= stats.size()) stats.push_back(Accumulator(i, j));
+					
+					//The sides of the pixel which are on the border of the component.
+					unsigned int sides = 0;
+					if(j == 0 || (row - rowStride)[i] != foreground) ++sides;
+					if(j + 1 == height || (row + rowStride)[i] != foreground) ++sides;
+					if(i == 0 || row[i-1] != foreground) ++sides;
+					if(i + 1 == width || row[i+1] != foreground) ++sides;
+					stats[e].add(i, j, sides);
+				}
+			}
+		}
+		
+		template <typename D>
+		class ComponentLabeling_t<D>::StripTask : public ParallelTask
+		{
+			public:
+				StripTask(const ComponentLabeling_t<D>& algo, const GrayscaleImage_t<D>* img, D foreground, unsigned int* labels,
+				          const std::vector<unsigned int>& rows, std::vector<DisjointSet>& sets, std::vector<std::vector<Accumulator> >& stats)
+				 : _algo(algo), _img(img), _foreground(foreground), _labels(labels), _rows(rows), _sets(sets), _stats(stats) {}
+				
+				void run(unsigned int begin, unsigned int end) {
+					for(unsigned int s = begin ; s < end ; ++s) {
+						_algo.labelStrip(_img, _foreground, _labels, _rows[s], _rows[s+1], _sets[s], _stats[s]);
+					}
+				}
+				
+			private:
+				const ComponentLabeling_t<D>& _algo;
+				const GrayscaleImage_t<D>* _img;
+				D _foreground;
+				unsigned int* _labels;
+				const std::vector<unsigned int>& _rows;
+				std::vector<DisjointSet>& _sets;
+				std::vector<std::vector<Accumulator> >& _stats;
+		};
+		
+		template <typename D>
+		class ComponentLabeling_t<D>::RelabelTask : public ParallelTask
+		{
+			public:
+				RelabelTask(unsigned int* labels, unsigned int width, const std::vector<unsigned int>& rows,
+				            const std::vector<unsigned int>& offsets, const std::vector<unsigned int>& labelToComponent)
+				 : _labels(labels), _width(width), _rows(rows), _offsets(offsets), _labelToComponent(labelToComponent) {}
+				
+				void run(unsigned int begin, unsigned int end) {
+					const unsigned int background = std::numeric_limits<unsigned int>::max();
+					for(unsigned int s = begin ; s < end ; ++s) {
+						unsigned int* last = _labels + _rows[s+1] * _width;
+						for(unsigned int* label = _labels + _rows[s] * _width ; label < last ; ++label) {
+							*label = (*label != background) ? _labelToComponent[_offsets[s] + *label] + 1 : 0;
+						}
+					}
+				}
+				
+			private:
+				unsigned int* _labels;
+				unsigned int _width;
+				const std::vector<unsigned int>& _rows;
+				const std::vector<unsigned int>& _offsets;
+				const std::vector<unsigned int>& _labelToComponent;
+		};
+
 		template <typename D>
 		double ComponentLabeling_t<D>::getAverageComponentSize() const
 		{
 			double average = 0;
-			for(std::map<unsigned int, unsigned int>::const_iterator it = _nameToSize.begin() ; it != _nameToSize.end() ; ++it) {
-				average += static_cast<double>(it->second);
+			for(typename std::vector<ComponentStats>::const_iterator it = _componentStats.begin() ; it != _componentStats.end() ; ++it) {
+				average += static_cast<double>(it->area);
 			}
-			return average/static_cast<double>(_nameToSize.size());
+			return average/static_cast<double>(_componentStats.size());
 		}
 
 		//DisjointSet Implementation
 		//----------------------------
 
 		template<typename D>
-		void ComponentLabeling_t<D>::DisjointSet::makeSet()
+		unsigned int ComponentLabeling_t<D>::DisjointSet::makeSet()
 		{
-			unsigned int n = _tab.size();
-			_tab.push_back(new std::list<unsigned int>(1, n));
+			unsigned int n = _parent.size();
+			_parent.push_back(n);
+			_rank.push_back(0);
+			return n;
+		}
+
+		template<typename D>
+		void ComponentLabeling_t<D>::DisjointSet::append(const DisjointSet& other)
+		{
+			const unsigned int offset = _parent.size();
+			for(unsigned int e = 0 ; e < other._parent.size() ; ++e) {
+				_parent.push_back(other._parent[e] + offset);
+			}
+			_rank.insert(_rank.end(), other._rank.begin(), other._rank.end());
 		}
 
 		template<typename D> 
-		void ComponentLabeling_t<D>::DisjointSet::merge(unsigned int s1, unsigned int s2)
+		unsigned int ComponentLabeling_t<D>::DisjointSet::merge(unsigned int e1, unsigned int e2)
 		{
-			if(_tab[s2] != _tab[s1]) {
-				_tab[s1]->splice(_tab[s1]->end(), *(_tab[s2]));
-				delete _tab[s2];
-				
-				std::list<unsigned int>* toReplace = _tab[s2];
-				for(std::vector<std::list<unsigned int> *>::iterator it = _tab.begin() ; it != _tab.end() ; ++it) {
-					if(*it == toReplace) {
-						*it = _tab[s1];
-					}
-				}
-				
+			unsigned int r1 = find(e1);
+			unsigned int r2 = find(e2);
+			if(r1 == r2) {
+				return r1;
+			}
+			//Union by rank : the shallower tree is attached under the root of the deeper one.
+			if(_rank[r1] < _rank[r2]) {
+				std::swap(r1, r2);
 			}
+			_parent[r2] = r1;
+			if(_rank[r1] == _rank[r2]) {
+				++_rank[r1];
+			}
+			return r1;
 		}
 
 		template<typename D> 
-		unsigned int ComponentLabeling_t<D>::DisjointSet::find(unsigned int e) const
+		unsigned int ComponentLabeling_t<D>::DisjointSet::find(unsigned int e)
 		{
-			for(unsigned int i = 0 ; i < _tab.size() ; ++i) {
-				
-				std::list<unsigned int>* cur = _tab[i];
-				
-				if(i == e) return i; //If we're searching for a set representative, we know it's in that set
-				
-				if(std::find(cur->begin(), cur->end(), e) != cur->end()) {
-					return i;
-				}
+			unsigned int root = e;
+			while(_parent[root] != root) {
+				root = _parent[root];
+			}
+			//Path compression : every element on the way now points to the root.
+			while(_parent[e] != root) {
+				const unsigned int next = _parent[e];
+				_parent[e] = root;
+				e = next;
 			}
+			return root;
 		}
 	}
 }
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Fft.h"
+
+#include <cmath>
+#include <stdexcept>
+
+using namespace imagein::algorithm;
+
+typedef std::complex<double> Complex;
+
+/*
+ * Product of two complex numbers. operator* of std::complex handles the infinite and NaN cases,
+ * which makes it several times slower, and they can't happen here.
+ */
+static inline Complex mul(const Complex& a, const Complex& b) {
+    return Complex(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+}
+
+Fft::Fft(unsigned int size) : _size(size)
+{
+    if(!isNiceSize(size)) {
+        throw std::invalid_argument("Fft : the size must only have 2, 3 and 5 as prime factors");
+    }
+
+    //Radix 4 steps first, they need fewer operations than two radix 2 steps.
+    unsigned int n = size;
+    const unsigned int radices[] = {4, 2, 3, 5};
+    for(unsigned int r = 0; r < 4; ++r) {
+        while(n % radices[r] == 0 && n > 1) {
+            n /= radices[r];
+            _radices.push_back(radices[r]);
+            _subSizes.push_back(n);
+        }
+    }
+
+    const double pi = 3.14159265358979323846;
+    _twiddles.resize(size);
+    _inverseTwiddles.resize(size);
+    for(unsigned int k = 0; k < size; ++k) {
+        const double angle = -2. * pi * k / size;
+        _twiddles[k] = Complex(std::cos(angle), std::sin(angle));
+        _inverseTwiddles[k] = std::conj(_twiddles[k]);
+    }
+}
+
+bool Fft::isNiceSize(unsigned int n)
+{
+    if(n == 0) return false;
+    while(n % 2 == 0) n /= 2;
+    while(n % 3 == 0) n /= 3;
+    while(n % 5 == 0) n /= 5;
+    return n == 1;
+}
+
+unsigned int Fft::niceSize(unsigned int n)
+{
+    if(n <= 1) return 1;
+    while(!isNiceSize(n)) ++n;
+    return n;
+}
+
+void Fft::transform(const Complex* in, Complex* out, unsigned int stride, bool inverse) const
+{
+    if(_size == 1) {
+        out[0] = in[0];
+        return;
+    }
+    work(out, in, 1, stride, 0, inverse);
+}
+
+/*
+ * Recursive decimation in time : the input is split in p interleaved sequences (p being the radix of the step),
+ * whose transforms are written one after the other in out, then combined by the butterflies of the step.
+ */
+void Fft::work(Complex* out, const Complex* in, unsigned int stride, unsigned int inStride,
+               unsigned int factor, bool inverse) const
+{
+    const std::vector<Complex>& twiddles = inverse ? _inverseTwiddles : _twiddles;
+    const unsigned int p = _radices[factor];
+    const unsigned int m = _subSizes[factor];
+
+    if(m == 1) {
+        for(unsigned int q = 0; q < p; ++q) {
+            out[q] = in[q * stride * inStride];
+        }
+    }
+    else {
+        for(unsigned int q = 0; q < p; ++q) {
+            work(out + q * m, in + q * stride * inStride, stride * p, inStride, factor + 1, inverse);
+        }
+    }
+
+    if(p == 2) {
+        for(unsigned int k = 0; k < m; ++k) {
+            const Complex t = mul(out[k + m], twiddles[k * stride]);
+            out[k + m] = out[k] - t;
+            out[k] += t;
+        }
+        return;
+    }
+
+    if(p == 4) {
+        //Multiplication by -i for the forward transform, by i for the inverse one.
+        for(unsigned int k = 0; k < m; ++k) {
+            const Complex a0 = out[k];
+            const Complex a1 = mul(out[k + m], twiddles[k * stride]);
+            const Complex a2 = mul(out[k + 2*m], twiddles[2 * k * stride]);
+            const Complex a3 = mul(out[k + 3*m], twiddles[3 * k * stride]);
+            const Complex s02 = a0 + a2, d02 = a0 - a2;
+            const Complex s13 = a1 + a3, d13 = a1 - a3;
+            const Complex rot = inverse ? Complex(-d13.imag(), d13.real()) : Complex(d13.imag(), -d13.real());
+            out[k] = s02 + s13;
+            out[k + m] = d02 + rot;
+            out[k + 2*m] = s02 - s13;
+            out[k + 3*m] = d02 - rot;
+        }
+        return;
+    }
+
+    if(p == 3) {
+        //twiddles[stride * m] is the third root of unity of the transform.
+        const double epi3 = twiddles[stride * m].imag();
+        for(unsigned int k = 0; k < m; ++k) {
+            const Complex a1 = mul(out[k + m], twiddles[k * stride]);
+            const Complex a2 = mul(out[k + 2*m], twiddles[2 * k * stride]);
+            const Complex sum = a1 + a2;
+            const Complex diff = (a1 - a2) * epi3;
+            const Complex half = out[k] - sum * 0.5;
+            out[k] += sum;
+            out[k + m] = Complex(half.real() - diff.imag(), half.imag() + diff.real());
+            out[k + 2*m] = Complex(half.real() + diff.imag(), half.imag() - diff.real());
+        }
+        return;
+    }
+
+    //Radix 5 : ya and yb are the fifth roots of unity of the transform.
+    const Complex ya = twiddles[stride * m];
+    const Complex yb = twiddles[2 * stride * m];
+    for(unsigned int k = 0; k < m; ++k) {
+        const Complex a0 = out[k];
+        const Complex a1 = mul(out[k + m], twiddles[k * stride]);
+        const Complex a2 = mul(out[k + 2*m], twiddles[2 * k * stride]);
+        const Complex a3 = mul(out[k + 3*m], twiddles[3 * k * stride]);
+        const Complex a4 = mul(out[k + 4*m], twiddles[4 * k * stride]);
+        const Complex s14 = a1 + a4, d14 = a1 - a4;
+        const Complex s23 = a2 + a3, d23 = a2 - a3;
+
+        out[k] = a0 + s14 + s23;
+
+        const Complex b1 = a0 + s14 * ya.real() + s23 * yb.real();
+        const Complex c1(d14.imag() * ya.imag() + d23.imag() * yb.imag(), -d14.real() * ya.imag() - d23.real() * yb.imag());
+        out[k + m] = b1 - c1;
+        out[k + 4*m] = b1 + c1;
+
+        const Complex b2 = a0 + s14 * yb.real() + s23 * ya.real();
+        const Complex c2(-d14.imag() * yb.imag() + d23.imag() * ya.imag(), d14.real() * yb.imag() - d23.real() * ya.imag());
+        out[k + 2*m] = b2 + c2;
+        out[k + 3*m] = b2 - c2;
+    }
+}
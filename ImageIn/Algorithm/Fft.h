@@ -0,0 +1,77 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FFT_H
+#define FFT_H
+
+#include <complex>
+#include <vector>
+
+namespace imagein
+{
+	namespace algorithm
+	{
+        /*!
+         * \brief One-dimensional discrete Fourier transform of a fixed size.
+         *
+         * The size must only have 2, 3 and 5 as prime factors (see niceSize()). The twiddle factors
+         * are computed by the constructor, so an Fft object should be reused for all the transforms
+         * of the same size. transform() doesn't modify the object and can be called from several threads.
+         */
+        class Fft
+        {
+            public:
+                /*!
+                 * \brief Prepares the transforms of the given size.
+                 *
+                 * \throw std::invalid_argument if size is 0 or has a prime factor other than 2, 3 or 5.
+                 */
+                explicit Fft(unsigned int size);
+
+                inline unsigned int getSize() const { return _size; }
+
+                /*!
+                 * \brief Computes the transform of size values spaced by stride.
+                 *
+                 * \param in The first value of the input.
+                 * \param out Where the size consecutive values of the result are written, must not overlap the input.
+                 * \param stride The spacing between two values of the input.
+                 * \param inverse Computes the inverse transform. The result is not divided by the size.
+                 */
+                void transform(const std::complex<double>* in, std::complex<double>* out, unsigned int stride, bool inverse) const;
+
+                //! Returns true if n only has 2, 3 and 5 as prime factors.
+                static bool isNiceSize(unsigned int n);
+
+                //! Returns the smallest size greater or equal to n which only has 2, 3 and 5 as prime factors.
+                static unsigned int niceSize(unsigned int n);
+
+            private:
+                void work(std::complex<double>* out, const std::complex<double>* in, unsigned int stride, unsigned int inStride,
+                          unsigned int factor, bool inverse) const;
+
+                unsigned int _size;
+                //! Radices of the successive steps, and the size of the sub-transforms of each step.
+                std::vector<unsigned int> _radices, _subSizes;
+                std::vector<std::complex<double> > _twiddles, _inverseTwiddles;
+        };
+	}
+}
+
+#endif //FFT_H
@@ -111,6 +111,44 @@ Filter::~Filter ()
 //  return make_pair (_i, _j);
 //}
 
+bool Filter::isSeparable(std::vector<double>& hKernel, std::vector<double>& vKernel, double epsilon) const
+{
+  //The coefficient with the greatest magnitude is used as pivot : its row and column give the two kernels
+  unsigned int pi = 0, pj = 0;
+  double pivot = 0.;
+  for(unsigned int j = 0; j < getHeight(); ++j) {
+    for(unsigned int i = 0; i < getWidth(); ++i) {
+      if(std::abs(getPixelAt(i, j)) > std::abs(pivot)) {
+        pivot = getPixelAt(i, j);
+        pi = i;
+        pj = j;
+      }
+    }
+  }
+
+  hKernel.assign(getWidth(), 0.);
+  vKernel.assign(getHeight(), 1.);
+  if(pivot == 0.) return true;
+
+  for(unsigned int i = 0; i < getWidth(); ++i) {
+    hKernel[i] = getPixelAt(i, pj) / pivot;
+  }
+  for(unsigned int j = 0; j < getHeight(); ++j) {
+    vKernel[j] = getPixelAt(pi, j);
+  }
+
+  //The filter is of rank 1 if every coefficient is the product of its row and column factors
+  const double tolerance = epsilon * std::abs(pivot);
+  for(unsigned int j = 0; j < getHeight(); ++j) {
+    for(unsigned int i = 0; i < getWidth(); ++i) {
+      if(std::abs(getPixelAt(i, j) - hKernel[i] * vKernel[j]) > tolerance) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 std::vector<Filter*> Filter::uniform(int numPixels = 3)
 {
   Filter* filter = new Filter(numPixels, numPixels);
@@ -181,7 +219,7 @@ std::vector<Filter*> Filter::gaussian(double alpha)
       if(i == 0) /* values are already in gaussCoef, so no compute needed */
       {
 //        (*f)[center][center + j] = gaussCoef[j];
-          f->setPixelAt(center, center + j, gaussCoef[i]);
+          f->setPixelAt(center, center + j, gaussCoef[j]);
 
         if(j != 0)
         {
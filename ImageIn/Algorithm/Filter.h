@@ -83,6 +83,19 @@ namespace imagein
 			static std::vector<Filter*> roberts();
 			static std::vector<Filter*> sobel();
 			static std::vector<Filter*> squareLaplacien();
+
+            /*!
+             * \brief Checks whether the filter is separable, i.e. of rank 1.
+             *
+             * A separable filter is the outer product of a horizontal and a vertical kernel,
+             * so that applying it is equivalent to a horizontal pass followed by a vertical pass.
+             *
+             * \param hKernel Receives the horizontal kernel (getWidth() coefficients) if the filter is separable.
+             * \param vKernel Receives the vertical kernel (getHeight() coefficients) if the filter is separable.
+             * \param epsilon Relative tolerance used to compare the filter to the product of the two kernels.
+             * \return true if the filter is separable.
+             */
+            bool isSeparable(std::vector<double>& hKernel, std::vector<double>& vKernel, double epsilon = 1e-9) const;
       
 //		private:
 //		  int _width;
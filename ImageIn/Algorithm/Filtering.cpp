@@ -22,12 +22,16 @@
 #include "Filtering.h"
 
 #include <algorithm>
-#ifdef __linux__
-#include <pthread.h>
-#include <sys/sysinfo.h>
+#include <cmath>
+#include <complex>
+#include "Fft.h"
+#include "../CpuFeatures.h"
+#include "../ThreadPool.h"
+#include "../IntegralImage.h"
+
+#ifdef IMAGEIN_X86_SIMD
+#include <immintrin.h>
 #endif
-#include "Average.h"
-#include "Distance.h"
 
 namespace imagein
 {
@@ -38,89 +42,244 @@ Filtering::Filtering(Filter* filter)
     _filters.push_back(filter);
 //    _policy = blackPolicy;
     _policy = POLICY_BLACK;
+    _mode = MODE_AUTO;
+    _combination = COMBINATION_MAX;
 }
 
 Filtering::Filtering(std::vector<Filter*> filters) : _filters(filters)
 {
 //    _policy = blackPolicy;
     _policy = POLICY_BLACK;
+    _mode = MODE_AUTO;
+    _combination = COMBINATION_MAX;
 }
 
+/*
+ * Maps a coordinate which may fall outside of [0, n[ to the coordinate of the pixel to use,
+ * according to the border policy. Returns -1 if the pixel must be ignored.
+ */
 template<Filtering::Policy>
-inline double filtering(const Image_t<double>* img, int x, int y, int c, Filter* filter, int hwf, int hhf);
+inline int borderIndex(int i, int n);
 
 template<>
-inline double filtering<Filtering::POLICY_BLACK>(const Image_t<double>* img, int x, int y, int c, Filter* filter, int hwf, int hhf) {
-    double newPixel = 0.;
-    for(unsigned int i = 0; i < filter->getWidth(); i++)
-    {
-        for(unsigned int j = 0; j < filter->getHeight(); j++)
-        {
-            const int imgX = x + i - hwf;
-            const int imgY = y + j - hhf;
-            if(imgX > 0 && imgX < img->getWidth() && imgY > 0 && imgY < img->getHeight()) {
-                newPixel += filter->getPixelAt(i,j) * img->getPixelAt(imgX, imgY, c);
-            }
+inline int borderIndex<Filtering::POLICY_BLACK>(int i, int n) {
+    return (i >= 0 && i < n) ? i : -1;
+}
+
+template<>
+inline int borderIndex<Filtering::POLICY_MIRROR>(int i, int n) {
+    if(i < 0) i = -i;
+    if(i >= n) i = 2*n - i - 1;
+    return std::min(std::max(i, 0), n - 1);
+}
+
+template<>
+inline int borderIndex<Filtering::POLICY_NEAREST>(int i, int n) {
+    return std::min(std::max(i, 0), n - 1);
+}
+
+template<>
+inline int borderIndex<Filtering::POLICY_TOR>(int i, int n) {
+    i %= n;
+    return (i < 0) ? i + n : i;
+}
+
+/*
+ * Non-zero taps of a convolution, in the order in which they are summed,
+ * and the extent of the neighbourhood they cover around the current pixel.
+ */
+struct Taps
+{
+    std::vector<double> weights;
+    std::vector<int> dx, dy;
+    int left, right, top, bottom;
+};
+
+static void makeTaps(Taps& taps, const Filter* filter) {
+    const int halfWidthFilter = (filter->getWidth() - 1) / 2;
+    const int halfHeightFilter = (filter->getHeight() - 1) / 2;
+    for(unsigned int i = 0; i < filter->getWidth(); ++i) {
+        for(unsigned int j = 0; j < filter->getHeight(); ++j) {
+            if(filter->getPixelAt(i, j) == 0.) continue;
+            taps.weights.push_back(filter->getPixelAt(i, j));
+            taps.dx.push_back(i - halfWidthFilter);
+            taps.dy.push_back(j - halfHeightFilter);
         }
     }
-    return newPixel;
+    taps.left = halfWidthFilter;
+    taps.right = filter->getWidth() - 1 - halfWidthFilter;
+    taps.top = halfHeightFilter;
+    taps.bottom = filter->getHeight() - 1 - halfHeightFilter;
 }
 
-template<>
-inline double filtering<Filtering::POLICY_MIRROR>(const Image_t<double>* img, int x, int y, int c, Filter* filter, int hwf, int hhf) {
+static void makeRowTaps(Taps& taps, const std::vector<double>& kernel) {
+    const int half = (kernel.size() - 1) / 2;
+    for(unsigned int i = 0; i < kernel.size(); ++i) {
+        if(kernel[i] == 0.) continue;
+        taps.weights.push_back(kernel[i]);
+        taps.dx.push_back(i - half);
+        taps.dy.push_back(0);
+    }
+    taps.left = half;
+    taps.right = kernel.size() - 1 - half;
+    taps.top = taps.bottom = 0;
+}
+
+static void makeColumnTaps(Taps& taps, const std::vector<double>& kernel) {
+    const int half = (kernel.size() - 1) / 2;
+    for(unsigned int j = 0; j < kernel.size(); ++j) {
+        if(kernel[j] == 0.) continue;
+        taps.weights.push_back(kernel[j]);
+        taps.dx.push_back(0);
+        taps.dy.push_back(j - half);
+    }
+    taps.left = taps.right = 0;
+    taps.top = half;
+    taps.bottom = kernel.size() - 1 - half;
+}
+
+/*
+ * Value of the convolution at a pixel near the border, where the policy decides which pixels are read.
+ */
+template<Filtering::Policy P>
+inline double borderSum(const Image_t<double>* img, int x, int y, int c, const Taps& taps) {
     double newPixel = 0.;
-    for(unsigned int i = 0; i < filter->getWidth(); i++)
-    {
-        for(unsigned int j = 0; j < filter->getHeight(); j++)
-        {
-            int imgX = x + i - hwf;
-            int imgY = y + j - hhf;
-            if(imgX < 0) imgX = -imgX;
-            if(imgY < 0) imgY = -imgY;
-            if(imgX >= img->getWidth()) imgX = 2*img->getWidth() - imgX - 1;
-            if(imgY >= img->getHeight()) imgY = 2*img->getHeight() - imgY - 1;
-            newPixel += filter->getPixelAt(i,j) * img->getPixelAt(imgX, imgY, c);
+    for(unsigned int t = 0; t < taps.weights.size(); ++t) {
+        const int imgX = borderIndex<P>(x + taps.dx[t], img->getWidth());
+        const int imgY = borderIndex<P>(y + taps.dy[t], img->getHeight());
+        if(imgX >= 0 && imgY >= 0) {
+            newPixel += taps.weights[t] * img->getPixelAt(imgX, imgY, c);
         }
     }
     return newPixel;
 }
 
-template<>
-inline double filtering<Filtering::POLICY_NEAREST>(const Image_t<double>* img, int x, int y, int c, Filter* filter, int hwf, int hhf) {
-    double newPixel = 0.;
-    for(unsigned int i = 0; i < filter->getWidth(); i++)
-    {
-        for(unsigned int j = 0; j < filter->getHeight(); j++)
-        {
-            int imgX = x + i - hwf;
-            int imgY = y + j - hhf;
-            if(imgX < 0) imgX = 0;
-            if(imgY < 0) imgY = 0;
-            if(imgX >= img->getWidth()) imgX = img->getWidth() - 1;
-            if(imgY >= img->getHeight()) imgY = img->getHeight() - 1;
-            newPixel += filter->getPixelAt(i,j) * img->getPixelAt(imgX, imgY, c);
+/*
+ * Accumulates the response to a filter of a bank, the first one initializing the accumulator.
+ */
+static void accumulate(double* acc, const double* response, unsigned int count, Filtering::Combination combination, bool first) {
+    switch(combination) {
+        case Filtering::COMBINATION_L2:
+            for(unsigned int x = 0; x < count; ++x) {
+                acc[x] = (first ? 0. : acc[x]) + response[x] * response[x];
+            }
+            break;
+        case Filtering::COMBINATION_L1:
+            for(unsigned int x = 0; x < count; ++x) {
+                acc[x] = (first ? 0. : acc[x]) + std::abs(response[x]);
+            }
+            break;
+        default:
+            for(unsigned int x = 0; x < count; ++x) {
+                acc[x] = first ? std::abs(response[x]) : std::max(acc[x], std::abs(response[x]));
+            }
+    }
+}
+
+//! Turns the accumulated responses to a bank into the magnitude.
+static void finishCombination(double* acc, unsigned int count, Filtering::Combination combination) {
+    if(combination == Filtering::COMBINATION_L2) {
+        for(unsigned int x = 0; x < count; ++x) {
+            acc[x] = std::sqrt(acc[x]);
         }
     }
-    return newPixel;
 }
 
-template<>
-inline double filtering<Filtering::POLICY_TOR>(const Image_t<double>* img, int x, int y, int c, Filter* filter, int hwf, int hhf) {
-    double newPixel = 0.;
-    for(unsigned int i = 0; i < filter->getWidth(); i++)
-    {
-        for(unsigned int j = 0; j < filter->getHeight(); j++)
-        {
-            int imgX = x + i - hwf;
-            int imgY = y + j - hhf;
-            if(imgX < 0) imgX = img->getWidth() - imgX;
-            if(imgY < 0) imgY = img->getHeight() - imgY;
-            if(imgX >= img->getWidth()) imgX = imgX - img->getWidth();
-            if(imgY >= img->getHeight()) imgY = imgY - img->getHeight();
-            newPixel += filter->getPixelAt(i,j) * img->getPixelAt(imgX, imgY, c);
+/*
+ * Kernels used on the interior of the image, where every tap of the filter falls inside the image.
+ * They compute out[x] = sum(weights[t] * srcs[t][x]) for x in [0, count[, the taps being summed
+ * in the same order as the border code so that both give the same values.
+ */
+typedef void (*WeightedSum)(double* out, const double* const* srcs, const double* weights, unsigned int nTaps, unsigned int count);
+
+static void weightedSumScalar(double* out, const double* const* srcs, const double* weights, unsigned int nTaps, unsigned int count) {
+    for(unsigned int x = 0; x < count; ++x) {
+        double newPixel = 0.;
+        for(unsigned int t = 0; t < nTaps; ++t) {
+            newPixel += weights[t] * srcs[t][x];
         }
+        out[x] = newPixel;
     }
-    return newPixel;
+}
+
+#ifdef IMAGEIN_X86_SIMD
+__attribute__((target("sse2")))
+static void weightedSumSse2(double* out, const double* const* srcs, const double* weights, unsigned int nTaps, unsigned int count) {
+    unsigned int x = 0;
+    for(; x + 4 <= count; x += 4) {
+        __m128d acc0 = _mm_setzero_pd();
+        __m128d acc1 = _mm_setzero_pd();
+        for(unsigned int t = 0; t < nTaps; ++t) {
+            const __m128d w = _mm_set1_pd(weights[t]);
+            acc0 = _mm_add_pd(acc0, _mm_mul_pd(w, _mm_loadu_pd(srcs[t] + x)));
+            acc1 = _mm_add_pd(acc1, _mm_mul_pd(w, _mm_loadu_pd(srcs[t] + x + 2)));
+        }
+        _mm_storeu_pd(out + x, acc0);
+        _mm_storeu_pd(out + x + 2, acc1);
+    }
+    for(; x + 2 <= count; x += 2) {
+        __m128d acc = _mm_setzero_pd();
+        for(unsigned int t = 0; t < nTaps; ++t) {
+            acc = _mm_add_pd(acc, _mm_mul_pd(_mm_set1_pd(weights[t]), _mm_loadu_pd(srcs[t] + x)));
+        }
+        _mm_storeu_pd(out + x, acc);
+    }
+    for(; x < count; ++x) {
+        double newPixel = 0.;
+        for(unsigned int t = 0; t < nTaps; ++t) {
+            newPixel += weights[t] * srcs[t][x];
+        }
+        out[x] = newPixel;
+    }
+}
+
+__attribute__((target("avx2")))
+static void weightedSumAvx2(double* out, const double* const* srcs, const double* weights, unsigned int nTaps, unsigned int count) {
+    unsigned int x = 0;
+    for(; x + 8 <= count; x += 8) {
+        __m256d acc0 = _mm256_setzero_pd();
+        __m256d acc1 = _mm256_setzero_pd();
+        for(unsigned int t = 0; t < nTaps; ++t) {
+            const __m256d w = _mm256_broadcast_sd(weights + t);
+            acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(w, _mm256_loadu_pd(srcs[t] + x)));
+            acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(w, _mm256_loadu_pd(srcs[t] + x + 4)));
+        }
+        _mm256_storeu_pd(out + x, acc0);
+        _mm256_storeu_pd(out + x + 4, acc1);
+    }
+    for(; x + 4 <= count; x += 4) {
+        __m256d acc = _mm256_setzero_pd();
+        for(unsigned int t = 0; t < nTaps; ++t) {
+            acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_broadcast_sd(weights + t), _mm256_loadu_pd(srcs[t] + x)));
+        }
+        _mm256_storeu_pd(out + x, acc);
+    }
+    for(; x < count; ++x) {
+        double newPixel = 0.;
+        for(unsigned int t = 0; t < nTaps; ++t) {
+            newPixel += weights[t] * srcs[t][x];
+        }
+        out[x] = newPixel;
+    }
+}
+#endif
+
+static WeightedSum selectWeightedSum() {
+#ifdef IMAGEIN_X86_SIMD
+    if(CpuFeatures::hasAvx2()) return weightedSumAvx2;
+    if(CpuFeatures::hasSse2()) return weightedSumSse2;
+#endif
+    return weightedSumScalar;
+}
+
+static const WeightedSum weightedSum = selectWeightedSum();
+
+inline const double* rowOf(const Image_t<double>* img, int y, int c) {
+    return img->begin() + c * img->getChannelStride() + y * img->getRowStride();
+}
+
+inline double* rowOf(Image_t<double>* img, int y, int c) {
+    return img->begin() + c * img->getChannelStride() + y * img->getRowStride();
 }
 
 Image_t<double>* Filtering::algorithm(const std::vector<const Image_t<double>*>& imgs)
@@ -131,19 +290,23 @@ Image_t<double>* Filtering::algorithm(const std::vector<const Image_t<double>*>&
         throw ImageTypeException(__LINE__, __FILE__);
     }
 
+    //The passes work on contiguous lines, so interleaved images are filtered in a planar copy.
+    if(img->getLayout() != LAYOUT_PLANAR) {
+        const Image_t<double> planar(*img, LAYOUT_PLANAR);
+        Image_t<double>* result = algorithm(std::vector<const Image_t<double>*>(1, &planar));
+        result->setLayout(img->getLayout());
+        return result;
+    }
 
     int width = img->getWidth();
     int height = img->getHeight();
     int nChannels = img->getNbChannels();
-    bool odd = width % 2 != 1 || height % 2 != 1;
 
     std::vector<Filter*>::iterator filter;
-    std::vector<Image_t<double>*> images;
-
-    double posFactor = 0.;
-    double negFactor = 0.;
     for(filter = _filters.begin(); filter != _filters.end(); ++filter)
     {
+        double posFactor = 0.;
+        double negFactor = 0.;
         Filter::iterator iter = (*filter)->begin();
         for(; iter != (*filter)->end(); ++iter)
         {
@@ -159,246 +322,492 @@ Image_t<double>* Filtering::algorithm(const std::vector<const Image_t<double>*>&
             *it /= factor;
             std::cout << *it << std::endl;
         }
+    }
 
-        Image_t<double>* result = new Image_t<double>(width, height, nChannels);
+    Image_t<double>* result = new Image_t<double>(width, height, nChannels);
 
-#ifdef __linux__
+    if(_filters.size() == 1) {
+        convolve(img, result, _filters[0]);
+        return result;
+    }
 
-        int numCPU;
-#ifdef _SC_NPROCESSORS_ONLN
-        numCPU = sysconf( _SC_NPROCESSORS_ONLN );
-#else
-        numCPU = 1;
-#endif
-        pthread_t threads[numCPU];
+    //The filters of a bank are all evaluated in a single sweep over the image,
+    //unless they are large enough for the FFT to be faster.
+    bool fft = (_mode == MODE_FFT);
+    if(_mode == MODE_AUTO) {
+        fft = true;
+        for(filter = _filters.begin(); filter != _filters.end(); ++filter) {
+            const unsigned int taps = (*filter)->getWidth() * (*filter)->getHeight() - std::count((*filter)->begin(), (*filter)->end(), 0.);
+            fft = fft && fftIsFaster(img, *filter, taps);
+        }
+    }
 
-        for(int i = 0; i < numCPU; i++)
-        {
-            pthread_t thread;
-            pthread_attr_t attr;
-            pthread_attr_init(&attr);
-
-            struct ParallelArgs* args = new struct ParallelArgs;
-            args->img = img;
-            args->result = result;
-            args->filter = *filter;
-            args->policy = _policy;
-            args->infl = (i * img->getHeight() * img->getNbChannels()) / numCPU;
-            args->supl = ( (i + 1) * img->getHeight() * img->getNbChannels()) / numCPU;
-            args->factor = factor;
-            args->odd = odd;
-
-            pthread_create(&thread, &attr, parallelAlgorithm, (void*)args);
-
-            threads[i] = thread;
+    if(fft) {
+        Image_t<double> response(width, height, nChannels);
+        for(unsigned int k = 0; k < _filters.size(); ++k) {
+            applyFft(img, &response, _filters[k], _policy);
+            accumulate(result->begin(), response.begin(), result->size(), _combination, k == 0);
         }
+        finishCombination(result->begin(), result->size(), _combination);
+    }
+    else {
+        ParallelArgs args;
+        args.img = img;
+        args.result = result;
+        args.filter = NULL;
+        args.filters = &_filters;
+        args.kernel = NULL;
+        args.pass = PASS_BANK;
+        args.policy = _policy;
+        args.combination = _combination;
+        runPass(args);
+    }
+    return result;
+}
 
-        for(int i = 0; i < numCPU; i++)
-            pthread_join(threads[i], NULL);
-
-#else
-        
-        int halfHeightFilter = (*filter)->getHeight() / 2;
-        int halfWidthFilter = (*filter)->getWidth() / 2;
-
-        switch(_policy) {
-            case POLICY_TOR:
-            {
-                for(int c = 0; c < nChannels; c++) {
-	            for(int y = 0; y < height; y++) {
-	                for(int x = 0; x < width; x++) {
-	        	    result->pixelAt(x, y, c) = filtering<POLICY_TOR>(img, x, y, c, *filter, halfWidthFilter, halfHeightFilter);
-	        	}
-                    }
-                }
-		break;
-	    }
-            case POLICY_NEAREST:
-            {
-                for(int c = 0; c < nChannels; c++) {
-	            for(int y = 0; y < height; y++) {
-	                for(int x = 0; x < width; x++) {
-	        	    result->pixelAt(x, y, c) = filtering<POLICY_NEAREST>(img, x, y, c, *filter, halfWidthFilter, halfHeightFilter);
-	        	}
-                    }
-                }
-		break;
-	    }
-            case POLICY_MIRROR:
-            {
-                for(int c = 0; c < nChannels; c++) {
-	            for(int y = 0; y < height; y++) {
-	                for(int x = 0; x < width; x++) {
-	        	    result->pixelAt(x, y, c) = filtering<POLICY_MIRROR>(img, x, y, c, *filter, halfWidthFilter, halfHeightFilter);
-	        	}
-                    }
-                }
-		break;
-	    }
-            default:
-            {
-                for(int c = 0; c < nChannels; c++) {
-	            for(int y = 0; y < height; y++) {
-	                for(int x = 0; x < width; x++) {
-	        	    result->pixelAt(x, y, c) = filtering<POLICY_BLACK>(img, x, y, c, *filter, halfWidthFilter, halfHeightFilter);
-	        	}
-                    }
-                }
-		break;
-	    }
-	}
-#endif
-        images.push_back(result);
+//! Minimum width + height of a box filter computed with integral images.
+static const unsigned int boxMinTaps = 26;
+
+void Filtering::convolve(const Image_t<double>* img, Image_t<double>* result, Filter* filter) const
+{
+    //A box filter is a sum over a rectangle, which integral images give in constant time. Building them costs
+    //about as much as separable passes of 2x13 taps (measured on 2000x2000 images), so small boxes are left to the passes.
+    if(_mode == MODE_AUTO && filter->getWidth() + filter->getHeight() >= boxMinTaps && isBox(filter)) {
+        applyBox(img, result, filter, _policy);
+        return;
     }
-    Image_t<double>* result = NULL;
 
-    if(images.size() == 1)
-        result = images[0];
-    else
-    {
-        unsigned int size = images.size();
-        
-        MaxDistance<Image_t<double>, 2> av;
+    //A separable filter is applied as a horizontal pass followed by a vertical one,
+    //which costs w+h multiply-adds per pixel instead of w*h.
+    std::vector<double> hKernel, vKernel;
+    const bool separable = filter->isSeparable(hKernel, vKernel)
+                        && hKernel.size() + vKernel.size() < filter->getWidth() * filter->getHeight();
 
-        for(unsigned int i = 0; i < size; ++i)
-        {
-            if(result == NULL)
-            {
-                result = av(images[0], images[1]);
-            }
-            else
-            {
-                result = av(result, images[i]);
-            }
-        }
+    unsigned int directTaps = hKernel.size() + vKernel.size();
+    if(!separable) {
+        directTaps = filter->getWidth() * filter->getHeight() - std::count(filter->begin(), filter->end(), 0.);
+    }
+
+    if(_mode == MODE_FFT || (_mode == MODE_AUTO && fftIsFaster(img, filter, directTaps))) {
+        applyFft(img, result, filter, _policy);
+    }
+    else if(separable) {
+        Image_t<double>* buffer = new Image_t<double>(img->getWidth(), img->getHeight(), img->getNbChannels());
+        applyPass(img, buffer, NULL, &hKernel, PASS_HORIZONTAL, _policy);
+        applyPass(buffer, result, NULL, &vKernel, PASS_VERTICAL, _policy);
+        delete buffer;
+    }
+    else {
+        applyPass(img, result, filter, NULL, PASS_2D, _policy);
     }
-    return result;
 }
 
+class Filtering::PassTask : public ParallelTask
+{
+    public:
+        PassTask(const ParallelArgs& args) : _args(args) {}
+
+        void run(unsigned int begin, unsigned int end) {
+            ParallelArgs args = _args;
+            args.infl = begin;
+            args.supl = end;
+            filterLines(args);
+        }
 
+    private:
+        const ParallelArgs& _args;
+};
 
+void Filtering::applyPass(const Image_t<double>* img, Image_t<double>* result, Filter* filter, const std::vector<double>* kernel, Pass pass, Policy policy)
+{
+    ParallelArgs args;
+    args.img = img;
+    args.result = result;
+    args.filter = filter;
+    args.kernel = kernel;
+    args.pass = pass;
+    args.policy = policy;
+    args.filters = NULL;
+    args.combination = COMBINATION_MAX;
+    runPass(args);
+}
 
-#ifdef __linux__
-void* Filtering::parallelAlgorithm(void* data)
+void Filtering::runPass(ParallelArgs& args)
 {
-    struct ParallelArgs args = *((ParallelArgs*) data);
+    args.infl = 0;
+    args.supl = args.img->getHeight() * args.img->getNbChannels();
 
-    const Image_t<double>* img = args.img;
-    Image_t<double>* result = args.result;
-    Filter* filter = args.filter;
-    Policy policy = args.policy;
-    int factor = args.factor;
-    bool odd = args.odd;
-
-    int halfHeightFilter = (filter->getHeight()-1) / 2;
-    int halfWidthFilter = (filter->getWidth()-1) / 2;
-    bool check = true;
-    switch(policy) {
+    PassTask task(args);
+    ThreadPool::instance().parallelFor(task, args.infl, args.supl);
+}
+
+void Filtering::filterLines(const ParallelArgs& args)
+{
+    switch(args.policy) {
         case POLICY_TOR:
-        {
-            for(unsigned int l = args.infl; l < args.supl; ++l) {
-                const unsigned int c = l / img->getHeight();
-                const unsigned int y = l % img->getHeight();
-                for(unsigned int x = 0; x < img->getWidth(); ++x) {
-                    result->pixelAt(x, y, c) = filtering<POLICY_TOR>(img, x, y, c, filter, halfWidthFilter, halfHeightFilter);
-                }
-            }
+            convolveLines<POLICY_TOR>(args);
             break;
-        }
         case POLICY_NEAREST:
-        {
-            for(unsigned int l = args.infl; l < args.supl; ++l) {
-                const unsigned int c = l / img->getHeight();
-                const unsigned int y = l % img->getHeight();
-                for(unsigned int x = 0; x < img->getWidth(); ++x) {
-                    result->pixelAt(x, y, c) = filtering<POLICY_NEAREST>(img, x, y, c, filter, halfWidthFilter, halfHeightFilter);
-                }
+            convolveLines<POLICY_NEAREST>(args);
+            break;
+        case POLICY_MIRROR:
+            convolveLines<POLICY_MIRROR>(args);
+            break;
+        default:
+            convolveLines<POLICY_BLACK>(args);
+    }
+}
+
+/*
+ * Computes the line y of the channel c of a convolution.
+ */
+template<Filtering::Policy P>
+static void convolveLine(const Image_t<double>* img, int y, int c, const Taps& taps, std::vector<const double*>& srcs, double* out) {
+    const int width = img->getWidth();
+    const int height = img->getHeight();
+
+    //Columns [x0, x1[ of the lines [top, height - bottom[ are computed by the vectorized kernel,
+    //the border policy is only applied on the remaining strips.
+    const int x0 = std::min(taps.left, width);
+    const int x1 = std::max(x0, width - taps.right);
+
+    int ranges[4] = {0, width, width, width};
+    if(y >= taps.top && y < height - taps.bottom && x1 > x0) {
+        for(unsigned int t = 0; t < taps.weights.size(); ++t) {
+            srcs[t] = rowOf(img, y + taps.dy[t], c) + x0 + taps.dx[t];
+        }
+        const bool empty = taps.weights.empty();
+        weightedSum(out + x0, empty ? NULL : &srcs[0], empty ? NULL : &taps.weights[0], taps.weights.size(), x1 - x0);
+        ranges[1] = x0;
+        ranges[2] = x1;
+    }
+
+    for(int r = 0; r < 4; r += 2) {
+        for(int x = ranges[r]; x < ranges[r+1]; ++x) {
+            out[x] = borderSum<P>(img, x, y, c, taps);
+        }
+    }
+}
+
+template<Filtering::Policy P>
+void Filtering::convolveLines(const ParallelArgs& args)
+{
+    const Image_t<double>* img = args.img;
+    const int width = img->getWidth();
+    const int height = img->getHeight();
+
+    std::vector<Taps> taps(args.pass == PASS_BANK ? args.filters->size() : 1);
+    switch(args.pass) {
+        case PASS_HORIZONTAL:
+            makeRowTaps(taps[0], *args.kernel);
+            break;
+        case PASS_VERTICAL:
+            makeColumnTaps(taps[0], *args.kernel);
+            break;
+        case PASS_BANK:
+            for(unsigned int k = 0; k < taps.size(); ++k) {
+                makeTaps(taps[k], (*args.filters)[k]);
             }
             break;
+        default:
+            makeTaps(taps[0], args.filter);
+    }
+    unsigned int maxTaps = 0;
+    for(unsigned int k = 0; k < taps.size(); ++k) {
+        maxTaps = std::max<unsigned int>(maxTaps, taps[k].weights.size());
+    }
+    std::vector<const double*> srcs(maxTaps);
+
+    //The responses to the filters of a bank are computed one line at a time and combined right away,
+    //so that only the combined image is written to memory.
+    std::vector<double> response(args.pass == PASS_BANK ? width : 0);
+
+    for(int l = args.infl; l < args.supl; ++l) {
+        const int c = l / height;
+        const int y = l % height;
+        double* out = rowOf(args.result, y, c);
+
+        if(args.pass != PASS_BANK) {
+            convolveLine<P>(img, y, c, taps[0], srcs, out);
+            continue;
         }
-        case POLICY_MIRROR:
-        {
-            for(unsigned int l = args.infl; l < args.supl; ++l) {
-                const unsigned int c = l / img->getHeight();
-                const unsigned int y = l % img->getHeight();
-                for(unsigned int x = 0; x < img->getWidth(); ++x) {
-                    result->pixelAt(x, y, c) = filtering<POLICY_MIRROR>(img, x, y, c, filter, halfWidthFilter, halfHeightFilter);
+        for(unsigned int k = 0; k < taps.size(); ++k) {
+            convolveLine<P>(img, y, c, taps[k], srcs, &response[0]);
+            accumulate(out, &response[0], width, args.combination, k == 0);
+        }
+        finishCombination(out, width, args.combination);
+    }
+}
+
+/*
+ * Index of the pixel used for the coordinate i of a line of n pixels, or -1 if it must be ignored.
+ * Only used to build the padding of the FFT convolution, where a runtime dispatch on the policy is cheap enough.
+ */
+static int borderIndex(Filtering::Policy policy, int i, int n) {
+    switch(policy) {
+        case Filtering::POLICY_TOR: return borderIndex<Filtering::POLICY_TOR>(i, n);
+        case Filtering::POLICY_NEAREST: return borderIndex<Filtering::POLICY_NEAREST>(i, n);
+        case Filtering::POLICY_MIRROR: return borderIndex<Filtering::POLICY_MIRROR>(i, n);
+        default: return borderIndex<Filtering::POLICY_BLACK>(i, n);
+    }
+}
+
+typedef std::complex<double> Complex;
+
+/*
+ * Transforms the lines (or the columns) of a 2D array of complex values.
+ */
+class FftLinesTask : public ParallelTask
+{
+    public:
+        FftLinesTask(Complex* data, const Fft& fft, unsigned int lineStep, unsigned int stride, bool inverse)
+            : _data(data), _fft(fft), _lineStep(lineStep), _stride(stride), _inverse(inverse) {}
+
+        void run(unsigned int begin, unsigned int end) {
+            std::vector<Complex> line(_fft.getSize()), column(_stride > 1 ? _fft.getSize() : 0);
+            for(unsigned int l = begin; l < end; ++l) {
+                Complex* first = _data + l * _lineStep;
+                if(_stride == 1) {
+                    _fft.transform(first, &line[0], 1, _inverse);
+                    std::copy(line.begin(), line.end(), first);
+                }
+                else {
+                    //The columns are copied in a contiguous buffer : reading them in place would miss the cache at each value.
+                    for(unsigned int k = 0; k < column.size(); ++k) {
+                        column[k] = first[k * _stride];
+                    }
+                    _fft.transform(&column[0], &line[0], 1, _inverse);
+                    for(unsigned int k = 0; k < line.size(); ++k) {
+                        first[k * _stride] = line[k];
+                    }
                 }
             }
-            break;
         }
-        default:
-        {
-            for(unsigned int l = args.infl; l < args.supl; ++l) {
-                const unsigned int c = l / img->getHeight();
-                const unsigned int y = l % img->getHeight();
-                for(unsigned int x = 0; x < img->getWidth(); ++x) {
-                    result->pixelAt(x, y, c) = filtering<POLICY_BLACK>(img, x, y, c, filter, halfWidthFilter, halfHeightFilter);
+
+    private:
+        Complex* _data;
+        const Fft& _fft;
+        unsigned int _lineStep, _stride;
+        bool _inverse;
+};
+
+/*
+ * Forward transform of a width x height array whose rows after nRows are zero (their transform is zero too).
+ */
+static void forwardFft2d(Complex* data, const Fft& rowFft, const Fft& colFft, unsigned int nRows) {
+    FftLinesTask rows(data, rowFft, rowFft.getSize(), 1, false);
+    ThreadPool::instance().parallelFor(rows, 0, nRows);
+    FftLinesTask cols(data, colFft, 1, rowFft.getSize(), false);
+    ThreadPool::instance().parallelFor(cols, 0, rowFft.getSize());
+}
+
+/*
+ * Inverse transform of a width x height array, of which only the rows [row0, row1[ are needed.
+ */
+static void inverseFft2d(Complex* data, const Fft& rowFft, const Fft& colFft, unsigned int row0, unsigned int row1) {
+    FftLinesTask cols(data, colFft, 1, rowFft.getSize(), true);
+    ThreadPool::instance().parallelFor(cols, 0, rowFft.getSize());
+    FftLinesTask rows(data, rowFft, rowFft.getSize(), 1, true);
+    ThreadPool::instance().parallelFor(rows, row0, row1);
+}
+
+/*
+ * Cost of a complex butterfly operation of the FFT, relatively to a multiply-add of the direct convolution
+ * (the latter being vectorized). Measured on 128x128 and 512x512 images, where the FFT becomes faster
+ * for non-separable filters of about 21x21.
+ */
+static const double fftOperationCost = 8.;
+
+bool Filtering::fftIsFaster(const Image_t<double>* img, const Filter* filter, unsigned int directTaps)
+{
+    const double nChannels = img->getNbChannels();
+    const double direct = static_cast<double>(img->getWidth()) * img->getHeight() * nChannels * directTaps;
+
+    const double size = static_cast<double>(Fft::niceSize(img->getWidth() + filter->getWidth() - 1))
+                      * Fft::niceSize(img->getHeight() + filter->getHeight() - 1);
+    //One forward and one inverse transform for each pair of channels, and the transform of the filter.
+    const double nTransforms = 2. * ((img->getNbChannels() + 1) / 2) + 1.;
+    const double fft = fftOperationCost * nTransforms * size * std::log(size) / std::log(2.);
+
+    return fft < direct;
+}
+
+void Filtering::applyFft(const Image_t<double>* img, Image_t<double>* result, const Filter* filter, Policy policy)
+{
+    const int width = img->getWidth();
+    const int height = img->getHeight();
+    const int nChannels = img->getNbChannels();
+    const int filterWidth = filter->getWidth();
+    const int filterHeight = filter->getHeight();
+    const int halfWidthFilter = (filterWidth - 1) / 2;
+    const int halfHeightFilter = (filterHeight - 1) / 2;
+
+    //The image is extended by the filter on each side, according to the policy. The rest of the padding is
+    //filled with zeros so that the circular convolution computed by the FFT doesn't wrap around.
+    const int paddedWidth = width + filterWidth - 1;
+    const int paddedHeight = height + filterHeight - 1;
+    const Fft rowFft(Fft::niceSize(paddedWidth));
+    const Fft colFft(Fft::niceSize(paddedHeight));
+    const unsigned int fftWidth = rowFft.getSize();
+    const unsigned int size = fftWidth * colFft.getSize();
+
+    //The direct convolution is a correlation : the filter is flipped to get the same result.
+    std::vector<Complex> kernel(size, 0.);
+    for(int j = 0; j < filterHeight; ++j) {
+        for(int i = 0; i < filterWidth; ++i) {
+            kernel[(filterHeight - 1 - j) * fftWidth + (filterWidth - 1 - i)] = filter->getPixelAt(i, j);
+        }
+    }
+    forwardFft2d(&kernel[0], rowFft, colFft, filterHeight);
+
+    std::vector<int> xs(paddedWidth), ys(paddedHeight);
+    for(int x = 0; x < paddedWidth; ++x) xs[x] = borderIndex(policy, x - halfWidthFilter, width);
+    for(int y = 0; y < paddedHeight; ++y) ys[y] = borderIndex(policy, y - halfHeightFilter, height);
+
+    //The filter being real, two channels are convolved at once as the real and imaginary parts of the data.
+    std::vector<Complex> data(size);
+    const double scale = 1. / size;
+    for(int c = 0; c < nChannels; c += 2) {
+        const bool pair = (c + 1 < nChannels);
+        std::fill(data.begin(), data.end(), Complex(0.));
+        for(int y = 0; y < paddedHeight; ++y) {
+            if(ys[y] < 0) continue;
+            const double* real = rowOf(img, ys[y], c);
+            const double* imag = pair ? rowOf(img, ys[y], c + 1) : NULL;
+            Complex* line = &data[y * fftWidth];
+            for(int x = 0; x < paddedWidth; ++x) {
+                if(xs[x] < 0) continue;
+                line[x] = Complex(real[xs[x]], pair ? imag[xs[x]] : 0.);
+            }
+        }
+
+        forwardFft2d(&data[0], rowFft, colFft, paddedHeight);
+        for(unsigned int k = 0; k < size; ++k) {
+            const Complex d = data[k];
+            data[k] = Complex(d.real() * kernel[k].real() - d.imag() * kernel[k].imag(),
+                              d.real() * kernel[k].imag() + d.imag() * kernel[k].real());
+        }
+        inverseFft2d(&data[0], rowFft, colFft, filterHeight - 1, paddedHeight);
+
+        for(int y = 0; y < height; ++y) {
+            const Complex* line = &data[(y + filterHeight - 1) * fftWidth + filterWidth - 1];
+            double* real = rowOf(result, y, c);
+            double* imag = pair ? rowOf(result, y, c + 1) : NULL;
+            for(int x = 0; x < width; ++x) {
+                real[x] = line[x].real() * scale;
+                if(pair) imag[x] = line[x].imag() * scale;
+            }
+        }
+    }
+}
+
+bool Filtering::isBox(const Filter* filter)
+{
+    const double weight = filter->getPixelAt(0, 0);
+    if(weight == 0.) return false;
+    for(unsigned int j = 0; j < filter->getHeight(); ++j) {
+        for(unsigned int i = 0; i < filter->getWidth(); ++i) {
+            if(filter->getPixelAt(i, j) != weight) return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Box sums of lines (all channels stacked) of an image. The boxes inside the image are read from the integral images,
+ * the others are clipped with POLICY_BLACK, and summed by borderSum with the other policies.
+ */
+template<Filtering::Policy P>
+static void boxLines(const Image_t<double>* img, Image_t<double>* result, const std::vector<IntegralImage_t<double>*>& integrals,
+                     const Taps& taps, double weight, int infl, int supl) {
+    const int width = img->getWidth();
+    const int height = img->getHeight();
+    for(int l = infl; l < supl; ++l) {
+        const int c = l / height;
+        const int y = l % height;
+        const IntegralImage_t<double>& integral = *integrals[c];
+        double* out = rowOf(result, y, c);
+        const bool inside = (y - taps.top >= 0 && y + taps.bottom < height);
+        const unsigned int y0 = std::max(y - taps.top, 0);
+        const unsigned int y1 = std::min(y + taps.bottom + 1, height);
+
+        //The boxes of the columns [x0, x1[ don't leave the image horizontally.
+        const int x0 = std::min(taps.left, width);
+        const int x1 = std::max(x0, width - taps.right);
+        if(P == Filtering::POLICY_BLACK || inside) {
+            const double* top = integral.getSumsLine(y0);
+            const double* bottom = integral.getSumsLine(y1);
+            const int left = taps.left;
+            const int right = taps.right + 1;
+            for(int x = x0; x < x1; ++x) {
+                out[x] = weight * ((bottom[x + right] - bottom[x - left]) - (top[x + right] - top[x - left]));
+            }
+        }
+        else {
+            for(int x = x0; x < x1; ++x) {
+                out[x] = borderSum<P>(img, x, y, c, taps);
+            }
+        }
+        int ranges[4] = {0, x0, x1, width};
+        for(int r = 0; r < 4; r += 2) {
+            for(int x = ranges[r]; x < ranges[r+1]; ++x) {
+                if(P == Filtering::POLICY_BLACK) {
+                    out[x] = weight * integral.sum(std::max(x - taps.left, 0), y0, std::min(x + taps.right + 1, width), y1);
+                }
+                else {
+                    out[x] = borderSum<P>(img, x, y, c, taps);
                 }
             }
         }
     }
+}
 
-//            double newPixel = 0;
-//            for(unsigned int i = 0; i < filter->getWidth(); i++)
-//            {
-//                for(unsigned int j = 0; j < filter->getHeight(); j++)
-//                {
-//                    const int imgX = x + i - halfWidthFilter;
-//                    const int imgY = y + j - halfHeightFilter;
-//                    if(imgX > 0 && imgX < img->getWidth() && imgY > 0 && imgY < img->getHeight()) {
-////                        newPixel += filter->getPixelAt(i,j) * ((*policy)(img, imgX, imgY, c));
-//                        newPixel += filter->getPixelAt(i,j) * img->getPixelAt(imgX, imgY, c);
-//                    }
-//                    else {
-////                        newPixel += filter->getPixelAt(i,j) * ((*policy)(img, imgX, imgY, c));
-//                    }
-////                    else {
-////                        newPixel += filter->getPixelAt(i,j) * img->getPixelAt(x, y, channel);
-////                    }
-//                }
-//            }
-////            if(factor > 1) newPixel /= factor;
-//            result->setPixel(x, y, c, newPixel);
-//        }
-
-//    }
-//    for(unsigned int x = infx; x < supx; x++)
-//    {
-//        bool check = x < halfWidthFilter || x > (img->getWidth() - halfWidthFilter);
-//        for(unsigned int y = 0; y < img->getHeight(); y++)
-//        {
-//            check = check || ( y < halfHeightFilter || y > (img->getHeight() - halfHeightFilter) );
-//            for(unsigned int channel = 0; channel < img->getNbChannels(); channel++)
-//            {
-//                double newPixel = 0;
-
-//                for(unsigned int i = 0; i < filter->getWidth(); i++)
-//                {
-//                    for(unsigned int j = 0; j < filter->getHeight(); j++)
-//                    {
-//                        const int imgX = x + i - halfWidthFilter;
-//                        const int imgY = y + j - halfHeightFilter;
-//                        if(imgX < 0 || imgX >= img->getWidth() || imgY <0 || imgY >= img->getHeight()) {
-//                            newPixel += filter->getPixelAt(i,j) * ((*policy)(img, imgX, imgY, channel));
-//                        }
-//                        else {
-//                            newPixel += filter->getPixelAt(i,j) * img->getPixelAt(x, y, channel);
-//                        }
-//                    }
-//                }
-//                if(factor > 1)
-//                    newPixel /= factor;
-//                result->setPixel(x, y, channel, newPixel);
-//            }
-//        }
-//    }
-    delete (ParallelArgs*) data;
-    if(args.supl != img->getHeight() * img->getNbChannels())
-        pthread_exit(NULL);
-    return NULL;
+class BoxTask : public ParallelTask
+{
+    public:
+        BoxTask(const Image_t<double>* img, Image_t<double>* result, const std::vector<IntegralImage_t<double>*>& integrals,
+                const Taps& taps, double weight, Filtering::Policy policy)
+         : _img(img), _result(result), _integrals(integrals), _taps(taps), _weight(weight), _policy(policy) {}
+
+        void run(unsigned int begin, unsigned int end) {
+            switch(_policy) {
+                case Filtering::POLICY_TOR:
+                    boxLines<Filtering::POLICY_TOR>(_img, _result, _integrals, _taps, _weight, begin, end);
+                    break;
+                case Filtering::POLICY_NEAREST:
+                    boxLines<Filtering::POLICY_NEAREST>(_img, _result, _integrals, _taps, _weight, begin, end);
+                    break;
+                case Filtering::POLICY_MIRROR:
+                    boxLines<Filtering::POLICY_MIRROR>(_img, _result, _integrals, _taps, _weight, begin, end);
+                    break;
+                default:
+                    boxLines<Filtering::POLICY_BLACK>(_img, _result, _integrals, _taps, _weight, begin, end);
+            }
+        }
+
+    private:
+        const Image_t<double>* _img;
+        Image_t<double>* _result;
+        const std::vector<IntegralImage_t<double>*>& _integrals;
+        const Taps& _taps;
+        double _weight;
+        Filtering::Policy _policy;
+};
+
+void Filtering::applyBox(const Image_t<double>* img, Image_t<double>* result, const Filter* filter, Policy policy)
+{
+    Taps taps;
+    makeTaps(taps, filter);
+    std::vector<IntegralImage_t<double>*> integrals(img->getNbChannels());
+    for(unsigned int c = 0; c < integrals.size(); ++c) {
+        integrals[c] = new IntegralImage_t<double>(*img, c, false);
+    }
+    BoxTask task(img, result, integrals, taps, filter->getPixelAt(0, 0), policy);
+    ThreadPool::instance().parallelFor(task, 0, img->getHeight() * img->getNbChannels());
+    for(unsigned int c = 0; c < integrals.size(); ++c) {
+        delete integrals[c];
+    }
 }
-#endif
 
 Filtering Filtering::uniformBlur(int numPixels = 3)
 {
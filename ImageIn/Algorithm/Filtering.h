@@ -21,7 +21,6 @@
 #define FILTRAGE_H
 
 #include <vector>
-#include <pthread.h>
 
 #include "../Image.h"
 #include "../Algorithm.h"
@@ -35,14 +34,31 @@ namespace imagein
         {
             public:
             enum Policy { POLICY_BLACK, POLICY_MIRROR, POLICY_NEAREST, POLICY_TOR};
+            /*!
+             * \brief How the convolution is computed.
+             *
+             * MODE_DIRECT sums the products of the taps of the filter with the pixels, MODE_FFT multiplies the
+             * Fourier transforms of the padded image and of the filter, which is faster for large filters.
+             * MODE_AUTO chooses the fastest one from the size of the filter and of the image.
+             */
+            enum Mode { MODE_AUTO, MODE_DIRECT, MODE_FFT };
+            /*!
+             * \brief How the responses to several filters are combined into a magnitude.
+             *
+             * COMBINATION_MAX keeps the largest absolute response, COMBINATION_L2 computes the euclidean norm
+             * of the responses and COMBINATION_L1 sums their absolute values.
+             */
+            enum Combination { COMBINATION_MAX, COMBINATION_L2, COMBINATION_L1 };
 //            typedef double (*Policy)(const Image_t<double>*, const int&, const int&, const int&);
 			
 		public:
 			Filtering(Filter* filter);
 			Filtering(std::vector<Filter*> filters);
-			Filtering(const Filtering& f) : _filters(f._filters), _policy(f._policy) {}
+			Filtering(const Filtering& f) : _filters(f._filters), _policy(f._policy), _mode(f._mode), _combination(f._combination) {}
   
 			inline void setPolicy(Policy policy) { _policy = policy; }
+			inline void setMode(Mode mode) { _mode = mode; }
+			inline void setCombination(Combination combination) { _combination = combination; }
 			
 			static Filtering uniformBlur(int numPixels);
 			static Filtering gaussianBlur(double alpha);
@@ -160,29 +176,65 @@ namespace imagein
 			}
 			
 		protected:
-			#ifdef __linux__
-			static void* parallelAlgorithm(void* data);
-			#endif
-			
             Image_t<double>* algorithm(const std::vector<const Image_t<double>*>& imgs);
 		
 		private:
 			std::vector<Filter*> _filters;
 			Policy _policy;
+			Mode _mode;
+			Combination _combination;
 			
-			#ifdef __linux__
+			//! Kind of convolution computed by a pass over the image.
+			//! PASS_BANK computes the combined magnitude of the responses to several filters.
+			enum Pass { PASS_2D, PASS_HORIZONTAL, PASS_VERTICAL, PASS_BANK };
+
 			struct ParallelArgs
 			{
                 const Image_t<double>* img;
                 Image_t<double>* result;
 				Filter* filter;
+				const std::vector<Filter*>* filters;
+				const std::vector<double>* kernel;
+				Pass pass;
 				Policy policy;
+				Combination combination;
                 int infl;
                 int supl;
-				int factor;
-        bool odd;
 			};
-			#endif
+
+			//! Convolves the image by a single filter, with the fastest method available.
+			void convolve(const Image_t<double>* img, Image_t<double>* result, Filter* filter) const;
+
+			//! Task running a pass on a range of lines in the ThreadPool.
+			class PassTask;
+
+			//! Runs a pass over the whole image, split between the threads of the ThreadPool.
+			static void applyPass(const Image_t<double>* img, Image_t<double>* result, Filter* filter, const std::vector<double>* kernel, Pass pass, Policy policy);
+
+			//! Runs the pass described by args over the whole image, whatever infl and supl are.
+			static void runPass(ParallelArgs& args);
+
+			//! Computes the lines [infl, supl[ (all channels stacked) of a pass.
+			static void filterLines(const ParallelArgs& args);
+
+			template<Policy P>
+			static void convolveLines(const ParallelArgs& args);
+
+			/*!
+			 * \brief Estimates if the FFT convolution of an image by a filter is faster than the direct one.
+			 *
+			 * \param directTaps The number of multiply-adds per pixel of the direct convolution.
+			 */
+			static bool fftIsFaster(const Image_t<double>* img, const Filter* filter, unsigned int directTaps);
+
+			//! Convolves the image by the filter through the FFT, the image being padded according to the policy.
+			static void applyFft(const Image_t<double>* img, Image_t<double>* result, const Filter* filter, Policy policy);
+
+			//! Returns true if all the coefficients of the filter are equal and not 0, as in uniformBlur().
+			static bool isBox(const Filter* filter);
+
+			//! Convolves the image by a box filter with the integral images of its channels, in constant time per pixel.
+			static void applyBox(const Image_t<double>* img, Image_t<double>* result, const Filter* filter, Policy policy);
 		};
 	}
 }
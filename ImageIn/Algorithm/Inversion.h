@@ -21,6 +21,7 @@
 #define ALGORITHM_INVERSION_H
 
 #include "../Algorithm.h"
+#include "../PixelAlgorithm.h"
 
 namespace imagein {
 	namespace algorithm {
@@ -21,9 +21,7 @@
 
 using namespace imagein::MorphoMat;
 StructElem::StructElem(Dir dir) {
-    _width = (dir == Top || dir == Bottom) ? 1 : 2;
-    _height = (dir == Left || dir == Right) ? 1 : 2;
-    _mat = new bool[_width * _height];
+    GrayscaleImage_t<bool>::operator=(GrayscaleImage_t<bool>((dir == Top || dir == Bottom) ? 1 : 2, (dir == Left || dir == Right) ? 1 : 2));
     _mat[0] = !(dir == TopRight || dir == BottomLeft);
     _mat[1] = !(dir == TopLeft || dir == BottomRight);
     if(_width > 1 && _height > 1) {
@@ -40,9 +38,7 @@ StructElem::StructElem(std::string filename) {
     GrayscaleImage* im_tmp = Converter<GrayscaleImage>::convert(image);
     GrayscaleImage* im_res = algo(im_tmp);
 
-    _width = im_res->getWidth();
-    _height = im_res->getHeight();
-    _mat = new bool[_width * _height * _nChannels];
+    GrayscaleImage_t<bool>::operator=(GrayscaleImage_t<bool>(im_res->getWidth(), im_res->getHeight()));
 
     for(unsigned int j = 0; j < getHeight(); ++j) {
         for(unsigned int i = 0; i < getWidth(); ++i) {
@@ -81,11 +77,55 @@ void StructElem::dilate(const StructElem& elem) {
     Dilatation<bool> op(elem);
     Image_t<bool>* resImg = op(bufImg);
     delete bufImg;
-    bool* data = _mat;
-    _width = resImg->getWidth();
-    _height = resImg->getHeight();
-    _mat = new bool[_width * _height];
-    delete data;
-    std::copy(resImg->begin(), resImg->end(), this->begin());
+    GrayscaleImage_t<bool>::operator=(GrayscaleImage_t<bool>(resImg->getWidth(), resImg->getHeight()));
+    std::copy(resImg->channelBegin(0), resImg->channelEnd(0), channelBegin(0));
     delete resImg;
 }
+
+bool StructElem::isRectangle(unsigned int& x, unsigned int& y, unsigned int& width, unsigned int& height) const {
+    unsigned int minX = getWidth(), minY = getHeight(), maxX = 0, maxY = 0;
+    unsigned int count = 0;
+    for(unsigned int j = 0; j < getHeight(); ++j) {
+        for(unsigned int i = 0; i < getWidth(); ++i) {
+            if(getPixel(i, j)) {
+                minX = std::min(minX, i);
+                minY = std::min(minY, j);
+                maxX = std::max(maxX, i);
+                maxY = std::max(maxY, j);
+                ++count;
+            }
+        }
+    }
+    if(count == 0 || count != (maxX - minX + 1) * (maxY - minY + 1)) {
+        return false;
+    }
+    x = minX;
+    y = minY;
+    width = maxX - minX + 1;
+    height = maxY - minY + 1;
+    return true;
+}
+
+CompiledElem::CompiledElem(const StructElem& elem) {
+    const int scale = elem.getScale();
+    for(unsigned int j = 0; j < elem.getHeight(); ++j) {
+        for(unsigned int i = 0; i < elem.getWidth(); ) {
+            if(!elem.getPixel(i, j)) {
+                ++i;
+                continue;
+            }
+            unsigned int end = i;
+            while(end < elem.getWidth() && elem.getPixel(end, j)) ++end;
+
+            //Each line of the element covers scale lines of the image.
+            Run run;
+            run.dx = (static_cast<int>(i) - static_cast<int>(elem.getCenterX())) * scale;
+            run.length = (end - i) * scale;
+            for(int k = 0; k < scale; ++k) {
+                run.dy = (static_cast<int>(j) - static_cast<int>(elem.getCenterY())) * scale + k;
+                _runs.push_back(run);
+            }
+            i = end;
+        }
+    }
+}
@@ -22,12 +22,14 @@
 
 #include <vector>
 #include <algorithm>
+#include <limits>
 
 #include "../GenericAlgorithm.h"
 #include "../GrayscaleImage.h"
 #include "Difference.h"
 #include "Otsu.h"
 #include "../Converter.h"
+#include "../ThreadPool.h"
 
 namespace imagein {
 
@@ -41,8 +43,8 @@ namespace imagein {
         StructElem(GrayscaleImage_t<bool> elem, unsigned int centerX, unsigned int centerY);
         inline unsigned char getScale() const { return _scale; }
         inline void setScale(unsigned char scale) { if(scale>0) { _scale = scale; } }
-        inline unsigned int getCenterX() { return _centerX; }
-        inline unsigned int getCenterY() { return _centerY; }
+        inline unsigned int getCenterX() const { return _centerX; }
+        inline unsigned int getCenterY() const { return _centerY; }
         inline void setCenterX(unsigned int centerX) { _centerX = centerX; }
         inline void setCenterY(unsigned int centerY) { _centerY = centerY; }
         inline void setCenter(unsigned int centerX, unsigned int centerY) { _centerX = centerX; _centerY = centerY; }
@@ -53,6 +55,16 @@ namespace imagein {
 
         void dilate(const StructElem& elem);
 
+        /*!
+         * \brief Tells if the pixels of the element form a filled rectangle.
+         *
+         * \param x The column of the left side of the rectangle.
+         * \param y The line of the top side of the rectangle.
+         * \param width The width of the rectangle, without the scale.
+         * \param height The height of the rectangle, without the scale.
+         */
+        bool isRectangle(unsigned int& x, unsigned int& y, unsigned int& width, unsigned int& height) const;
+
       private:
         unsigned char _scale;
         unsigned int _centerX, _centerY;
@@ -96,64 +108,266 @@ namespace imagein {
     template <typename D>
     Operator<D>::Operator(const StructElem& elem) : _elem(elem) {}
 
+    //! Minimum of two values, the identity being the value given to a pixel without neighbours by the Erosion.
     template <typename D>
-    class Erosion : public Operator<D> {
+    struct MinOp {
+        static inline D identity() { return std::numeric_limits<D>::max(); }
+        static inline D apply(D a, D b) { return (b < a) ? b : a; }
+    };
+
+    //! Lowest value of a type : numeric_limits<D>::min() for the integer types, -numeric_limits<D>::max() for the floating point ones
+    //! (whose numeric_limits<D>::min() is the smallest positive value).
+    template <typename D, bool isInteger = std::numeric_limits<D>::is_integer>
+    struct Lowest {
+        static inline D value() { return std::numeric_limits<D>::min(); }
+    };
+
+    template <typename D>
+    struct Lowest<D, false> {
+        static inline D value() { return -std::numeric_limits<D>::max(); }
+    };
+
+    //! Maximum of two values, the identity being the value given to a pixel without neighbours by the Dilatation.
+    template <typename D>
+    struct MaxOp {
+        static inline D identity() { return Lowest<D>::value(); }
+        static inline D apply(D a, D b) { return (b > a) ? b : a; }
+    };
+
+    /*!
+     * \brief Running minimum or maximum over a window sliding on a line, with the van Herk/Gil-Werman algorithm.
+     *
+     * Computes out[x] = Op(in[x + offset], ..., in[x + offset + size - 1]) for the n values of the line, the values
+     * outside of the line being ignored. The line is cut in blocks of size values, in which the extremums cumulated
+     * from the left and from the right are computed. Each window covers the end of a block and the beginning of the next one,
+     * so out[x] is obtained with a single comparison, whatever the size of the window.
+     */
+    template <typename D, class Op>
+    class RunningExtremum {
       public:
-        Erosion(const StructElem& elem) : Operator<D>(elem) {}
-      protected:
-        Image_t<D>* algorithm(const std::vector<const Image_t<D>*>& imgs) {
-            const Image_t<D>& img = *imgs[0];
-            Image_t<D> *result = new Image_t<D>(img.getWidth(), img.getHeight(), img.getNbChannels());
-
-            if(this->_elem.getScale()>1) {
-                for(unsigned int channel = 0; channel < img.getNbChannels(); ++channel) {
-                    for(unsigned int offsetY = 0; offsetY < img.getHeight(); ++offsetY) {
-                        for(unsigned int offsetX = 0; offsetX < img.getWidth(); ++offsetX) {
-                           
-                            D value = std::numeric_limits<D>::max();
-                            
-                            for(unsigned int j = 0; j < this->_elem.getHeight()*this->_elem.getScale(); ++j) {
-                                for(unsigned int i = 0; i < this->_elem.getWidth()*this->_elem.getScale(); ++i) {
-                                    if(this->_elem.getPixel(i/this->_elem.getScale(),j/this->_elem.getScale())) {
-                                        const int px = i - this->_elem.getCenterX()*this->_elem.getScale() + offsetX;        
-                                        const int py = j - this->_elem.getCenterY()*this->_elem.getScale() + offsetY;
-                                        if(px>=0 && py>=0 && static_cast<unsigned int>(px)<img.getWidth() && static_cast<unsigned int>(py)<img.getHeight()) {
-                                            if(img.getPixel(static_cast<unsigned int>(px),static_cast<unsigned int>(py),channel) < value) {
-                                                value = img.getPixel(static_cast<unsigned int>(px),static_cast<unsigned int>(py),channel);
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                            result->setPixel(offsetX, offsetY, channel, value);
-                        }
-                    }
+        RunningExtremum(unsigned int n, int offset, unsigned int size) : _n(n), _offset(offset), _size(size) {
+            const unsigned int length = n + size - 1;
+            _forward.resize(((length + size - 1) / size) * size);
+            _backward.resize(_forward.size());
+        }
+
+        void operator()(const D* in, unsigned int inStride, D* out, unsigned int outStride) {
+            const unsigned int length = _forward.size();
+            for(unsigned int t = 0; t < length; ++t) {
+                const int x = static_cast<int>(t) + _offset;
+                _forward[t] = (x >= 0 && x < static_cast<int>(_n)) ? in[x * inStride] : Op::identity();
+            }
+            for(unsigned int t = length; t-- > 0; ) {
+                _backward[t] = (t % _size == _size - 1) ? _forward[t] : Op::apply(_forward[t], _backward[t + 1]);
+            }
+            for(unsigned int t = 1; t < length; ++t) {
+                if(t % _size != 0) _forward[t] = Op::apply(_forward[t - 1], _forward[t]);
+            }
+            for(unsigned int x = 0; x < _n; ++x) {
+                out[x * outStride] = Op::apply(_backward[x], _forward[x + _size - 1]);
+            }
+        }
+
+      private:
+        unsigned int _n;
+        int _offset;
+        unsigned int _size;
+        std::vector<D> _forward, _backward;
+    };
+
+    /*!
+     * \brief Applies a RunningExtremum on the lines or on the columns of an image, in the ThreadPool.
+     *
+     * Both images must have the same layout, but their lines may be padded differently.
+     */
+    template <typename D, class Op>
+    class RunningExtremumTask : public ParallelTask {
+      public:
+        RunningExtremumTask(const Image_t<D>& in, Image_t<D>& out, bool horizontal, int offset, unsigned int size)
+            : _in(in), _out(out), _horizontal(horizontal), _offset(offset), _size(size) {}
+
+        //! Number of lines (or columns) of all the channels.
+        inline unsigned int nbLines() const {
+            return (_horizontal ? _in.getHeight() : _in.getWidth()) * _in.getNbChannels();
+        }
+
+        void run(unsigned int begin, unsigned int end) {
+            const unsigned int width = _in.getWidth();
+            const unsigned int height = _in.getHeight();
+            const unsigned int pixelStride = _in.getPixelStride();
+            RunningExtremum<D, Op> extremum(_horizontal ? width : height, _offset, _size);
+            for(unsigned int l = begin; l < end; ++l) {
+                if(_horizontal) {
+                    const unsigned int c = l / height, y = l % height;
+                    extremum(_in.begin() + c * _in.getChannelStride() + y * _in.getRowStride(), pixelStride,
+                             _out.begin() + c * _out.getChannelStride() + y * _out.getRowStride(), pixelStride);
+                }
+                else {
+                    const unsigned int c = l / width, x = l % width;
+                    extremum(_in.begin() + c * _in.getChannelStride() + x * pixelStride, _in.getRowStride(),
+                             _out.begin() + c * _out.getChannelStride() + x * pixelStride, _out.getRowStride());
+                }
+            }
+        }
+
+      private:
+        const Image_t<D>& _in;
+        Image_t<D>& _out;
+        bool _horizontal;
+        int _offset;
+        unsigned int _size;
+    };
+
+    /*!
+     * \brief Erosion or dilatation by a filled rectangle, as a horizontal and a vertical RunningExtremum.
+     *
+     * The cost per pixel doesn't depend on the size of the rectangle.
+     * The rectangle covers the pixels [x + offsetX, x + offsetX + width[ x [y + offsetY, y + offsetY + height[ around (x, y).
+     */
+    template <typename D, class Op>
+    void rectangleOperator(const Image_t<D>& img, Image_t<D>& result, int offsetX, unsigned int width, int offsetY, unsigned int height) {
+        Image_t<D> buffer(img.getWidth(), img.getHeight(), img.getNbChannels(), NULL, img.getLayout(), img.hasAlignedRows());
+        RunningExtremumTask<D, Op> rows(img, buffer, true, offsetX, width);
+        ThreadPool::instance().parallelFor(rows, 0, rows.nbLines());
+        RunningExtremumTask<D, Op> columns(buffer, result, false, offsetY, height);
+        ThreadPool::instance().parallelFor(columns, 0, columns.nbLines());
+    }
+
+    /*!
+     * \brief Applies the operator by the element with rectangleOperator() if the element is a filled rectangle.
+     *
+     * \return false if the element isn't a rectangle, and nothing was done.
+     */
+    template <typename D, class Op>
+    bool rectangleOperator(const Image_t<D>& img, Image_t<D>& result, const StructElem& elem) {
+        unsigned int x, y, width, height;
+        if(!elem.isRectangle(x, y, width, height)) {
+            return false;
+        }
+        const int scale = elem.getScale();
+        rectangleOperator<D, Op>(img, result, (static_cast<int>(x) - static_cast<int>(elem.getCenterX())) * scale, width * scale,
+                                              (static_cast<int>(y) - static_cast<int>(elem.getCenterY())) * scale, height * scale);
+        return true;
+    }
+
+    /*!
+     * \brief A StructElem compiled into the horizontal runs of its pixels, the scale being applied.
+     *
+     * An operator by the element is the extremum of the operators by its runs, so it only pays for the pixels
+     * of the element instead of testing all the pixels of its bounding box.
+     */
+    class CompiledElem {
+      public:
+        struct Run {
+            int dx; //!< Column of the first pixel of the run, relatively to the center of the element.
+            int dy; //!< Line of the run, relatively to the center of the element.
+            unsigned int length;
+        };
+
+        explicit CompiledElem(const StructElem& elem);
+
+        inline const std::vector<Run>& getRuns() const { return _runs; }
+
+      private:
+        std::vector<Run> _runs;
+    };
+
+    /*!
+     * \brief Applies an operator by a CompiledElem on a range of lines (all channels stacked), in the ThreadPool.
+     *
+     * Short runs are read pixel by pixel, longer ones go through a RunningExtremum on the line of the image they cover.
+     * Both images must have the same layout.
+     */
+    template <typename D, class Op>
+    class CompiledOperatorTask : public ParallelTask {
+      public:
+        CompiledOperatorTask(const Image_t<D>& in, Image_t<D>& out, const CompiledElem& elem) : _in(in), _out(out), _elem(elem) {}
+
+        void run(unsigned int begin, unsigned int end) {
+            const int width = _in.getWidth();
+            const int height = _in.getHeight();
+            const int pixelStride = _in.getPixelStride();
+            const std::vector<CompiledElem::Run>& runs = _elem.getRuns();
+
+            std::vector<RunningExtremum<D, Op> > extremums;
+            std::vector<int> extremumOf(runs.size(), -1);
+            for(unsigned int r = 0; r < runs.size(); ++r) {
+                if(runs[r].length > shortRun) {
+                    extremumOf[r] = extremums.size();
+                    extremums.push_back(RunningExtremum<D, Op>(width, runs[r].dx, runs[r].length));
                 }
             }
-            else {
-                for(unsigned int channel = 0; channel < img.getNbChannels(); ++channel) {
-                    for(unsigned int offsetY = 0; offsetY < img.getHeight(); ++offsetY) {
-                        for(unsigned int offsetX = 0; offsetX < img.getWidth(); ++offsetX) {
-                           
-                            D value = std::numeric_limits<D>::max();
-                            
-                            for(unsigned int j = 0; j < this->_elem.getHeight(); ++j) {
-                                for(unsigned int i = 0; i < this->_elem.getWidth(); ++i) {
-                                    if(this->_elem.getPixel(i,j)) {
-                                        const int px = i - this->_elem.getCenterX() + offsetX;        
-                                        const int py = j - this->_elem.getCenterY() + offsetY;
-                                        if(px>=0 && py>=0 && static_cast<unsigned int>(px)<img.getWidth() && static_cast<unsigned int>(py)<img.getHeight()) {
-                                            if(img.getPixel(static_cast<unsigned int>(px),static_cast<unsigned int>(py),channel) < value) {
-                                                value = img.getPixel(static_cast<unsigned int>(px),static_cast<unsigned int>(py),channel);
-                                            }
-                                        }
-                                    }
-                                }
+
+            //Images of one line rather than vectors, which aren't contiguous for bool.
+            Image_t<D> accLine(width, 1, 1), extremumLine(width, 1, 1);
+            D* acc = accLine.begin();
+            D* line = extremumLine.begin();
+            for(unsigned int l = begin; l < end; ++l) {
+                const int c = l / height;
+                const int y = l % height;
+                std::fill(acc, acc + width, Op::identity());
+
+                for(unsigned int r = 0; r < runs.size(); ++r) {
+                    const int sy = y + runs[r].dy;
+                    if(sy < 0 || sy >= height) continue;
+                    const D* row = _in.begin() + c * _in.getChannelStride() + sy * _in.getRowStride();
+
+                    if(extremumOf[r] >= 0) {
+                        extremums[extremumOf[r]](row, pixelStride, line, 1);
+                        for(int x = 0; x < width; ++x) {
+                            acc[x] = Op::apply(acc[x], line[x]);
+                        }
+                        continue;
+                    }
+                    for(unsigned int k = 0; k < runs[r].length; ++k) {
+                        const int dx = runs[r].dx + k;
+                        const int x0 = std::max(0, -dx);
+                        const int x1 = std::min(width, width - dx);
+                        const D* src = row + dx * pixelStride;
+                        if(pixelStride == 1) {
+                            for(int x = x0; x < x1; ++x) {
+                                acc[x] = Op::apply(acc[x], src[x]);
+                            }
+                        }
+                        else {
+                            for(int x = x0; x < x1; ++x) {
+                                acc[x] = Op::apply(acc[x], src[x * pixelStride]);
                             }
-                            result->setPixel(offsetX, offsetY, channel, value);
                         }
                     }
                 }
+                std::copy(acc, acc + width, typename Image_t<D>::line_iterator(_out.begin() + c * _out.getChannelStride() + y * _out.getRowStride(), pixelStride));
+            }
+        }
+
+      private:
+        //! Length up to which reading the pixels of a run is faster than a RunningExtremum.
+        static const unsigned int shortRun = 3;
+
+        const Image_t<D>& _in;
+        Image_t<D>& _out;
+        const CompiledElem& _elem;
+    };
+
+    //! Applies the operator by any element, through its CompiledElem.
+    template <typename D, class Op>
+    void compiledOperator(const Image_t<D>& img, Image_t<D>& result, const StructElem& elem) {
+        CompiledElem compiled(elem);
+        CompiledOperatorTask<D, Op> task(img, result, compiled);
+        ThreadPool::instance().parallelFor(task, 0, img.getHeight() * img.getNbChannels());
+    }
+
+    template <typename D>
+    class Erosion : public Operator<D> {
+      public:
+        Erosion(const StructElem& elem) : Operator<D>(elem) {}
+      protected:
+        Image_t<D>* algorithm(const std::vector<const Image_t<D>*>& imgs) {
+            const Image_t<D>& img = *imgs[0];
+            Image_t<D> *result = new Image_t<D>(img.getWidth(), img.getHeight(), img.getNbChannels(), NULL, img.getLayout(), img.hasAlignedRows());
+
+            if(!rectangleOperator<D, MinOp<D> >(img, *result, this->_elem)) {
+                compiledOperator<D, MinOp<D> >(img, *result, this->_elem);
             }
 
             return result;
@@ -166,68 +380,11 @@ namespace imagein {
     template <typename D>
     Image_t<D>* Dilatation<D>::algorithm(const std::vector<const Image_t<D>*>& imgs) {
         const Image_t<D>& img = *imgs[0];
-        Image_t<D> *result = new Image_t<D>(img.getWidth(), img.getHeight(), img.getNbChannels());
-
-        if(this->_elem.getScale()>1) {
-            for(unsigned int channel = 0; channel < img.getNbChannels(); ++channel) {
-                for(unsigned int offsetY = 0; offsetY < img.getHeight(); ++offsetY) {
-                    for(unsigned int offsetX = 0; offsetX < img.getWidth(); ++offsetX) {
-
-                        D value = std::numeric_limits<D>::min();
-
-                        for(unsigned int j = 0; j < this->_elem.getHeight()*this->_elem.getScale(); ++j) {
-                            for(unsigned int i = 0; i < this->_elem.getWidth()*this->_elem.getScale(); ++i) {
-                                if(this->_elem.getPixel(i/this->_elem.getScale(),j/this->_elem.getScale())) {
-                                    const int px = i - this->_elem.getCenterX()*this->_elem.getScale() + offsetX;
-                                    const int py = j - this->_elem.getCenterY()*this->_elem.getScale() + offsetY;
-                                    if(px>=0 && py>=0 && static_cast<unsigned int>(px)<img.getWidth() && static_cast<unsigned int>(py)<img.getHeight()) {
-                                        if(img.getPixel(static_cast<unsigned int>(px),static_cast<unsigned int>(py),channel) > value) {
-                                            value = img.getPixel(static_cast<unsigned int>(px),static_cast<unsigned int>(py),channel);
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                        result->setPixel(offsetX, offsetY, channel, value);
-                    }
-                }
-            }
-        }
-        else {
-            for(unsigned int channel = 0; channel < img.getNbChannels(); ++channel) {
-                for(unsigned int offsetY = 0; offsetY < img.getHeight(); ++offsetY) {
-                    for(unsigned int offsetX = 0; offsetX < img.getWidth(); ++offsetX) {
-
-                        D value = std::numeric_limits<D>::min();
-
-                        for(unsigned int j = 0; j < this->_elem.getHeight(); ++j) {
-                            for(unsigned int i = 0; i < this->_elem.getWidth(); ++i) {
-                                if(this->_elem.getPixel(i,j)) {
-                                    const int px = i - this->_elem.getCenterX() + offsetX;
-                                    const int py = j - this->_elem.getCenterY() + offsetY;
-                                    if(px>=0 && py>=0 && static_cast<unsigned int>(px)<img.getWidth() && static_cast<unsigned int>(py)<img.getHeight()) {
-                                        if(img.getPixel(static_cast<unsigned int>(px),static_cast<unsigned int>(py),channel) > value) {
-                                            value = img.getPixel(static_cast<unsigned int>(px),static_cast<unsigned int>(py),channel);
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                        result->setPixel(offsetX, offsetY, channel, value);
-                    }
-                }
-            }
-        }
+        Image_t<D> *result = new Image_t<D>(img.getWidth(), img.getHeight(), img.getNbChannels(), NULL, img.getLayout(), img.hasAlignedRows());
 
-        //for(unsigned int k = 0; k < img.getNbChannels(); ++k) {
-            //for(unsigned int j = 0; j < img.getHeight(); ++j) {
-                //for(unsigned int i = 0; i < img.getWidth(); ++i) {
-                    //std::vector<D> inter = this->_elem.intersect(img, i, j, k);
-                    //D value = *max_element(inter.begin(), inter.end());
-                    //result->setPixel(i, j, k, value);
-                //}
-            //}
-        //}
+        if(!rectangleOperator<D, MaxOp<D> >(img, *result, this->_elem)) {
+            compiledOperator<D, MaxOp<D> >(img, *result, this->_elem);
+        }
 
         return result;
     }
@@ -328,21 +485,23 @@ namespace imagein {
             algorithm::Difference<Image_t<D> > difference;
 
             //Image_t<D>* result = difference(buffer, imgs[0]);
-            Image_t<D>* result = new Image_t<D>(img.getWidth(), img.getHeight(), img.getNbChannels());
-            typename Image_t<D>::const_iterator it1 = img.begin();
-            typename Image_t<D>::const_iterator it2 = buffer->begin();
-            typename Image_t<D>::iterator it3 = result->begin();
+            Image_t<D>* result = new Image_t<D>(img.getWidth(), img.getHeight(), img.getNbChannels(), NULL, img.getLayout(), img.hasAlignedRows());
             unsigned int i =0;
-            while(it3 < result->end()) {
-
-                *it3 = *it2 - *it1;
-                if(*it1 > *it2) {
-                    std::cout << (int)*it2 << ">"  << (int)*it1 << std::endl;
-                    ++i;
+            for(unsigned int c = 0; c < img.getNbChannels(); ++c) {
+                typename Image_t<D>::const_channel_iterator it1 = img.channelBegin(c);
+                typename Image_t<D>::const_channel_iterator it2 = buffer->channelBegin(c);
+                typename Image_t<D>::channel_iterator it3 = result->channelBegin(c);
+                while(it3 < result->channelEnd(c)) {
+
+                    *it3 = *it2 - *it1;
+                    if(*it1 > *it2) {
+                        std::cout << (int)*it2 << ">"  << (int)*it1 << std::endl;
+                        ++i;
+                    }
+                    ++it1;
+                    ++it2;
+                    ++it3;
                 }
-                ++it1;
-                ++it2;
-                ++it3;
             }
             delete buffer;
             return result;
@@ -47,29 +47,35 @@ namespace imagein {
 			/*}*/
 
 			/*return new GrayscaleImage_t<D>(img->getWidth(), img->getHeight(), data);*/
-            return binarization(img);
+            GrayscaleImage_t<D>* result = binarization(img);
+            delete img;
+            return result;
 		}
 
 		template<typename D>
 		D Otsu_t<D>::computeThreshold(const GrayscaleImage_t<D>* img)
 		{
 			//Compute histogram of the image probability of each value.
+			//Images that are not 8-bit are binned, the threshold is then the last value of a bin.
 			Histogram hist = img->getHistogram();
 			
-			unsigned int nPixel = img->getWidth() * img->getHeight(); 
+			unsigned int nPixel = 0;
+			for(unsigned int i = 0 ; i < hist.getWidth() ; ++i) {
+				nPixel += hist[i];
+			}
 
 			//Compute intra-class variance for each possible threshold, and chose the minimum
 			int weightb = 0;
 			int weightw = 0;
 			double sumb = 0;
 			double sum = 0;
-			for(unsigned int i = 0 ; i < 1<<sizeof(D)*8 ; ++i) {
+			for(unsigned int i = 0 ; i < hist.getWidth() ; ++i) {
 				sum += i*hist[i];
 			}
 
 			double maxVariance = 0;
 			unsigned int chosenThreshold = 0;
-			for(unsigned int thresh = 0 ; thresh < 1<<sizeof(D)*8; ++thresh) {
+			for(unsigned int thresh = 0 ; thresh < hist.getWidth(); ++thresh) {
 
 				weightb += hist[thresh];
 				if(weightb == 0) continue;
@@ -92,7 +98,8 @@ namespace imagein {
 				}
 			}
 
-			return chosenThreshold;
+			const double end = hist.getBinStart(chosenThreshold + 1);
+			return static_cast<D>(std::numeric_limits<D>::is_integer ? end - 1 : end);
 		}
 	}
 }
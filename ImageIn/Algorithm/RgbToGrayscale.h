@@ -40,6 +40,8 @@ namespace imagein
          *
 		 * gray = (0.299*R + 0.587*G + 0.114*B);
          *
+         * On 8 bits depths, the sum is computed with integer weights by ColorSpace::rgbToGrayscale().
+         *
          * Arity : 1 \n
          * Input type :  RgbImage_t<D> \n
          * Output type : GrayscaleImage_t<D> \n
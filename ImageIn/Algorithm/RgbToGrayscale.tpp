@@ -18,24 +18,42 @@
 */
 
 #include <algorithm>
+#include "../ColorSpace.h"
+#include "../Converter.h"
 
 namespace imagein {
 	namespace algorithm {
+        //! The 8 bits images use the fixed point conversion of ColorSpace, the other depths fastRgbToGrayscale() returns NULL.
+        template<typename D>
+        inline GrayscaleImage_t<D>* fastRgbToGrayscale(const Image_t<D>&, double, double, double) {
+            return NULL;
+        }
+
+        inline GrayscaleImage_t<depth8_t>* fastRgbToGrayscale(const Image_t<depth8_t>& img, double r, double g, double b) {
+            return ColorSpace::rgbToGrayscale(img, r, g, b);
+        }
+
 		template<typename D>
         GrayscaleImage_t<D>* RgbToGrayscale_t<D>::algorithm(const std::vector<const Image_t<D>*>& imgs)
 		{
             const Image_t<D>* img = imgs.at(0);
             if (img->getNbChannels() >= 3)
 			{
+                GrayscaleImage_t<D>* img_res = fastRgbToGrayscale(*img, _r, _g, _b);
+                if(img_res != NULL) return img_res;
 
-                GrayscaleImage_t<D>* img_res = new GrayscaleImage_t<D>(img->getWidth(), img->getHeight());
+                img_res = new GrayscaleImage_t<D>(img->getWidth(), img->getHeight());
+                const unsigned int pixelStride = img->getPixelStride();
+                const unsigned int channelStride = img->getChannelStride();
+                const D* in = img->begin();
+                D* out = img_res->begin();
                 for (unsigned int j = 0 ; j < img->getHeight() ; ++j)
                 {
-                    for (unsigned int i = 0 ; i < img->getWidth() ; ++i)
+                    const D* src = in + j * img->getRowStride();
+                    D* dst = out + j * img_res->getRowStride();
+                    for (unsigned int i = 0 ; i < img->getWidth() ; ++i, src += pixelStride)
                     {
-                        img_res->setPixel(i, j, img->getPixel(i, j, 0) * _r
-                                                + img->getPixel(i, j, 1) * _g
-                                                + img->getPixel(i, j, 2) * _b );
+                        dst[i] = static_cast<D>(src[0] * _r + src[channelStride] * _g + src[2 * channelStride] * _b);
                     }
                 }
                 return img_res;
@@ -20,6 +20,8 @@
 #ifndef ARRAY_H
 #define ARRAY_H
 
+#include <algorithm>
+
 namespace imagein
 {
     /*!
@@ -40,8 +42,25 @@ namespace imagein
              * Values are not initialized.
              */
             inline Array(int width=0) : _width(width) { _array = new T[width]; };
+            //! Creates a copy of another array.
+            inline Array(const Array<T>& other) : _width(other._width) {
+                _array = new T[_width];
+                std::copy(other._array, other._array + _width, _array);
+            }
             inline virtual ~Array() { delete[] _array; };
 
+            //! Replaces the values of the array by a copy of the values of another array.
+            inline Array<T>& operator=(const Array<T>& other) {
+                if(this != &other) {
+                    T* array = new T[other._width];
+                    std::copy(other._array, other._array + other._width, array);
+                    delete[] _array;
+                    _array = array;
+                    _width = other._width;
+                }
+                return *this;
+            }
+
             //! Returns the size of the array.
             inline unsigned int getWidth() const { return _width; };
             inline unsigned int size() const { return _width; };
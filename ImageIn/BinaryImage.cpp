@@ -19,10 +19,267 @@
 
 #include "BinaryImage.h"
 
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include "AlgorithmException.h"
+#include "Algorithm/MorphoMat.h"
+
 using namespace imagein;
-/**
-BinaryImage::~BinaryImage()
+using namespace imagein::MorphoMat;
+
+typedef BinaryImage::word_t word_t;
+
+BinaryImage::BinaryImage(unsigned int width, unsigned int height, bool value)
+    : _width(width), _height(height), _wordsPerLine((width + wordBits - 1) / wordBits),
+      _words(_wordsPerLine * height, value ? ~word_t(0) : 0)
 {
-    //dtor
+    clearPadding();
+}
+
+bool BinaryImage::getPixel(unsigned int x, unsigned int y) const
+{
+    if(x >= _width || y >= _height) {
+        throw std::out_of_range("Invalid coordinates for getPixel");
+    }
+    return (getLine(y)[x / wordBits] >> (x % wordBits)) & 1;
+}
+
+void BinaryImage::setPixel(unsigned int x, unsigned int y, bool value)
+{
+    if(x >= _width || y >= _height) {
+        throw std::out_of_range("Invalid coordinates for setPixel");
+    }
+    const word_t bit = word_t(1) << (x % wordBits);
+    if(value) {
+        getLine(y)[x / wordBits] |= bit;
+    }
+    else {
+        getLine(y)[x / wordBits] &= ~bit;
+    }
+}
+
+unsigned int BinaryImage::count() const
+{
+    unsigned int n = 0;
+    for(std::vector<word_t>::const_iterator it = _words.begin(); it != _words.end(); ++it) {
+#ifdef __GNUC__
+        n += __builtin_popcountll(*it);
+#else
+        for(word_t w = *it; w != 0; w &= w - 1) ++n;
+#endif
+    }
+    return n;
+}
+
+BinaryImage& BinaryImage::operator&=(const BinaryImage& other)
+{
+    if(_width != other._width || _height != other._height) {
+        throw ImageSizeException(__LINE__, __FILE__);
+    }
+    for(unsigned int i = 0; i < _words.size(); ++i) {
+        _words[i] &= other._words[i];
+    }
+    return *this;
+}
+
+BinaryImage& BinaryImage::operator|=(const BinaryImage& other)
+{
+    if(_width != other._width || _height != other._height) {
+        throw ImageSizeException(__LINE__, __FILE__);
+    }
+    for(unsigned int i = 0; i < _words.size(); ++i) {
+        _words[i] |= other._words[i];
+    }
+    return *this;
+}
+
+BinaryImage& BinaryImage::operator^=(const BinaryImage& other)
+{
+    if(_width != other._width || _height != other._height) {
+        throw ImageSizeException(__LINE__, __FILE__);
+    }
+    for(unsigned int i = 0; i < _words.size(); ++i) {
+        _words[i] ^= other._words[i];
+    }
+    return *this;
+}
+
+BinaryImage BinaryImage::operator~() const
+{
+    BinaryImage result(*this);
+    for(unsigned int i = 0; i < result._words.size(); ++i) {
+        result._words[i] = ~result._words[i];
+    }
+    result.clearPadding();
+    return result;
+}
+
+void BinaryImage::clearPadding()
+{
+    if(_wordsPerLine == 0) return;
+    const word_t mask = lastWordMask();
+    for(unsigned int y = 0; y < _height; ++y) {
+        getLine(y)[_wordsPerLine - 1] &= mask;
+    }
+}
+
+BinaryImage BinaryImage::erode(const StructElem& elem) const
+{
+    return morpho(elem, true);
+}
+
+BinaryImage BinaryImage::dilate(const StructElem& elem) const
+{
+    return morpho(elem, false);
+}
+
+BinaryImage BinaryImage::open(const StructElem& elem) const
+{
+    return erode(elem).dilate(elem);
+}
+
+BinaryImage BinaryImage::close(const StructElem& elem) const
+{
+    return dilate(elem).erode(elem);
+}
+
+/*
+ * Returns the 64 bits of a line starting at the pixel start (which may be negative),
+ * the pixels out of the line being replaced by fill.
+ */
+static inline word_t bitsAt(const word_t* line, int nWords, word_t lastMask, int start, word_t fill)
+{
+    const int bits = BinaryImage::wordBits;
+    const int q = (start >= 0) ? start / bits : -((bits - 1 - start) / bits);
+    const int r = start - q * bits;
+
+    word_t words[2];
+    for(int k = 0; k < 2; ++k) {
+        const int index = q + k;
+        if(index < 0 || index >= nWords) words[k] = fill;
+        else if(index == nWords - 1) words[k] = (line[index] & lastMask) | (fill & ~lastMask);
+        else words[k] = line[index];
+    }
+    return (r == 0) ? words[0] : (words[0] >> r) | (words[1] << (bits - r));
+}
+
+/*
+ * Combines each bit of the buffer with the bit s positions after it (and for the erosion, or for the dilatation),
+ * the bits after the end of the buffer being equal to fill.
+ */
+static void combineShifted(std::vector<word_t>& buffer, unsigned int s, bool erosion, word_t fill)
+{
+    const unsigned int bits = BinaryImage::wordBits;
+    const unsigned int q = s / bits;
+    const unsigned int r = s % bits;
+    const unsigned int n = buffer.size();
+    //In increasing order, the words read are never modified before.
+    for(unsigned int w = 0; w < n; ++w) {
+        const word_t low = (w + q < n) ? buffer[w + q] : fill;
+        const word_t high = (w + q + 1 < n) ? buffer[w + q + 1] : fill;
+        const word_t shifted = (r == 0) ? low : (low >> r) | (high << (bits - r));
+        buffer[w] = erosion ? (buffer[w] & shifted) : (buffer[w] | shifted);
+    }
+}
+
+/*
+ * Computes in out the and (or) of the pixels [x + dx, x + dx + length[ of the line, for each pixel x of the line.
+ * buffer is a scratch vector, kept between the calls to avoid the allocations.
+ */
+static void horizontalRun(const word_t* line, unsigned int width, unsigned int nWords, word_t lastMask, int dx, unsigned int length,
+                          bool erosion, word_t fill, std::vector<word_t>& buffer, word_t* out)
+{
+    const unsigned int bits = BinaryImage::wordBits;
+    buffer.resize((width + length - 1 + bits - 1) / bits);
+    for(unsigned int w = 0; w < buffer.size(); ++w) {
+        buffer[w] = bitsAt(line, nWords, lastMask, dx + w * bits, fill);
+    }
+    //Doubling : after the combination with the bits s positions after, each bit covers twice as many pixels.
+    unsigned int covered = 1;
+    while(2 * covered <= length) {
+        combineShifted(buffer, covered, erosion, fill);
+        covered *= 2;
+    }
+    if(covered < length) {
+        combineShifted(buffer, length - covered, erosion, fill);
+    }
+    std::copy(buffer.begin(), buffer.begin() + nWords, out);
+}
+
+/*
+ * A distinct horizontal run of an element, with the lines of the element it appears on
+ * and the ring of its last computed lines.
+ */
+struct Distinct {
+    int dx;
+    unsigned int length;
+    int minDy, maxDy;
+    std::vector<word_t> ring;
+};
+
+BinaryImage BinaryImage::morpho(const StructElem& elem, bool erosion) const
+{
+    const word_t fill = erosion ? ~word_t(0) : 0;
+    const CompiledElem compiled(elem);
+    const std::vector<CompiledElem::Run>& runs = compiled.getRuns();
+
+    //Each distinct horizontal run (dx, length) of the element is applied to a line of the image once, whatever the
+    //number of lines of the element it appears on. Only the lines [y + minDy, y + maxDy] of a run are needed for the
+    //line y of the result, so they are kept in a ring of maxDy - minDy + 1 lines, filled while y increases.
+    std::map<std::pair<int, unsigned int>, unsigned int> indexOf;
+    std::vector<unsigned int> runIndex(runs.size());
+    std::vector<Distinct> distinct;
+    for(unsigned int r = 0; r < runs.size(); ++r) {
+        const std::pair<int, unsigned int> key(runs[r].dx, runs[r].length);
+        std::map<std::pair<int, unsigned int>, unsigned int>::iterator found = indexOf.find(key);
+        if(found != indexOf.end()) {
+            Distinct& d = distinct[found->second];
+            d.minDy = std::min(d.minDy, runs[r].dy);
+            d.maxDy = std::max(d.maxDy, runs[r].dy);
+            runIndex[r] = found->second;
+            continue;
+        }
+        Distinct d;
+        d.dx = runs[r].dx;
+        d.length = runs[r].length;
+        d.minDy = d.maxDy = runs[r].dy;
+        runIndex[r] = distinct.size();
+        indexOf[key] = distinct.size();
+        distinct.push_back(d);
+    }
+    for(unsigned int k = 0; k < distinct.size(); ++k) {
+        distinct[k].ring.resize((distinct[k].maxDy - distinct[k].minDy + 1) * _wordsPerLine);
+    }
+
+    const int height = _height;
+    std::vector<word_t> buffer;
+    BinaryImage result(_width, _height, erosion);
+    for(int y = 0; y < height; ++y) {
+        //Computes the lines which enter the window of each run : all of them for the first line, then only the last one.
+        for(unsigned int k = 0; k < distinct.size(); ++k) {
+            Distinct& d = distinct[k];
+            const int span = d.maxDy - d.minDy + 1;
+            for(int sy = (y == 0) ? d.minDy : y + d.maxDy; sy <= y + d.maxDy; ++sy) {
+                if(sy < 0 || sy >= height) continue;
+                horizontalRun(getLine(sy), _width, _wordsPerLine, lastWordMask(), d.dx, d.length, erosion, fill, buffer,
+                              &d.ring[((sy - d.minDy) % span) * _wordsPerLine]);
+            }
+        }
+
+        word_t* out = result.getLine(y);
+        for(unsigned int r = 0; r < runs.size(); ++r) {
+            const int sy = y + runs[r].dy;
+            if(sy < 0 || sy >= height) continue;
+            const Distinct& d = distinct[runIndex[r]];
+            const int span = d.maxDy - d.minDy + 1;
+            const word_t* in = &d.ring[((sy - d.minDy) % span) * _wordsPerLine];
+            for(unsigned int w = 0; w < _wordsPerLine; ++w) {
+                out[w] = erosion ? (out[w] & in[w]) : (out[w] | in[w]);
+            }
+        }
+    }
+    result.clearPadding();
+    return result;
 }
-*/
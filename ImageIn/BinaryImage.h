@@ -20,17 +20,156 @@
 #ifndef BINARYIMAGE_H
 #define BINARYIMAGE_H
 
+#include <vector>
+#include <limits>
+#include <stdexcept>
+
+#include "mystdint.h"
+#include "Image.h"
 #include "GrayscaleImage.h"
 
-/*namespace imagein
+namespace imagein
 {
-    class BinaryImage : public GrayscaleImage_t<bool>
+    namespace MorphoMat
+    {
+        class StructElem;
+    }
+
+    /*!
+     * \brief Bit-packed binary image.
+     *
+     * Each pixel is stored in one bit, 64 pixels per word, and each line starts on a new word.
+     * The boolean operations and the morphological operators work on whole words, which makes them much faster
+     * than on a GrayscaleImage_t<bool> or on a 0/255 image, for a memory footprint divided by 8 or more.
+     *
+     * The pixel x of a line is the bit (x % 64) of the word (x / 64) of the line.
+     * The bits after the last pixel of a line are always 0.
+     */
+    class BinaryImage
     {
         public:
-            BinaryImage(unsigned int width, unsigned int height, bool* data) : GrayscaleImage_t<bool>(width, height, data) {};
-            BinaryImage(std::string filename);
-            virtual ~BinaryImage();
+            typedef uint64_t word_t;
+            static const unsigned int wordBits = 64;
+
+            /*!
+             * \brief Constructs an image whose pixels all have the given value.
+             */
+            BinaryImage(unsigned int width = 0, unsigned int height = 0, bool value = false);
+
+            /*!
+             * \brief Constructs a binary image from a channel of an image.
+             *
+             * The pixels which are not 0 are set, which suits the output of Binarization_t and Otsu_t
+             * (0 for black, the maximum value of D for white).
+             */
+            template <typename D>
+            explicit BinaryImage(const Image_t<D>& img, unsigned int channel = 0);
+
+            /*!
+             * \brief Converts the image to a grayscale image, the set pixels having the maximum value of D and the other ones 0.
+             *
+             * \return A new image, which the caller must delete.
+             */
+            template <typename D>
+            GrayscaleImage_t<D>* toGrayscale() const;
+
+            inline unsigned int getWidth() const { return _width; }
+            inline unsigned int getHeight() const { return _height; }
+            //! Returns the number of words of a line.
+            inline unsigned int getWordsPerLine() const { return _wordsPerLine; }
+
+            //! Returns the first word of the line y.
+            inline word_t* getLine(unsigned int y) { return &_words[y * _wordsPerLine]; }
+            inline const word_t* getLine(unsigned int y) const { return &_words[y * _wordsPerLine]; }
+
+            /*!
+             * \brief Returns the value of a pixel.
+             * \throw std::out_of_range if the coordinates are out of the image.
+             */
+            bool getPixel(unsigned int x, unsigned int y) const;
+
+            /*!
+             * \brief Changes the value of a pixel.
+             * \throw std::out_of_range if the coordinates are out of the image.
+             */
+            void setPixel(unsigned int x, unsigned int y, bool value);
+
+            //! Returns the number of set pixels.
+            unsigned int count() const;
+
+            /*!
+             * \brief Boolean operations with an image of the same size, pixel by pixel.
+             * \throw ImageSizeException if the images don't have the same size.
+             */
+            BinaryImage& operator&=(const BinaryImage& other);
+            BinaryImage& operator|=(const BinaryImage& other);
+            BinaryImage& operator^=(const BinaryImage& other);
+            BinaryImage operator&(const BinaryImage& other) const { return BinaryImage(*this) &= other; }
+            BinaryImage operator|(const BinaryImage& other) const { return BinaryImage(*this) |= other; }
+            BinaryImage operator^(const BinaryImage& other) const { return BinaryImage(*this) ^= other; }
+            //! Returns the complement of the image.
+            BinaryImage operator~() const;
+
+            /*!
+             * \brief Morphological operators by a structuring element.
+             *
+             * They give the same result as the operators of MorphoMat on a 0/1 image : the pixels out of the image
+             * are ignored, so they behave as set pixels for the erosion and as unset pixels for the dilatation.
+             */
+            BinaryImage erode(const MorphoMat::StructElem& elem) const;
+            BinaryImage dilate(const MorphoMat::StructElem& elem) const;
+            BinaryImage open(const MorphoMat::StructElem& elem) const;
+            BinaryImage close(const MorphoMat::StructElem& elem) const;
+
+        private:
+            //! Applies the erosion (and) or the dilatation (or) by the element.
+            BinaryImage morpho(const MorphoMat::StructElem& elem, bool erosion) const;
+
+            //! Sets the bits after the last pixel of each line to 0.
+            void clearPadding();
+
+            //! Mask of the bits of the last word of a line which are pixels.
+            inline word_t lastWordMask() const {
+                const unsigned int used = _width % wordBits;
+                return (used == 0) ? ~word_t(0) : (word_t(1) << used) - 1;
+            }
+
+            unsigned int _width, _height, _wordsPerLine;
+            std::vector<word_t> _words;
     };
-}*/
+
+    template <typename D>
+    BinaryImage::BinaryImage(const Image_t<D>& img, unsigned int channel)
+        : _width(img.getWidth()), _height(img.getHeight()), _wordsPerLine((img.getWidth() + wordBits - 1) / wordBits),
+          _words(_wordsPerLine * img.getHeight(), 0)
+    {
+        if(channel >= img.getNbChannels()) {
+            throw std::out_of_range("Invalid channel for BinaryImage");
+        }
+        typename Image_t<D>::const_channel_iterator pixel = img.channelBegin(channel);
+        for(unsigned int y = 0; y < _height; ++y) {
+            word_t* line = getLine(y);
+            for(unsigned int x = 0; x < _width; ++x, ++pixel) {
+                if(*pixel != 0) {
+                    line[x / wordBits] |= word_t(1) << (x % wordBits);
+                }
+            }
+        }
+    }
+
+    template <typename D>
+    GrayscaleImage_t<D>* BinaryImage::toGrayscale() const
+    {
+        GrayscaleImage_t<D>* result = new GrayscaleImage_t<D>(_width, _height);
+        typename GrayscaleImage_t<D>::iterator pixel = result->begin();
+        for(unsigned int y = 0; y < _height; ++y) {
+            const word_t* line = getLine(y);
+            for(unsigned int x = 0; x < _width; ++x, ++pixel) {
+                *pixel = ((line[x / wordBits] >> (x % wordBits)) & 1) ? std::numeric_limits<D>::max() : 0;
+            }
+        }
+        return result;
+    }
+}
 
 #endif // BINARYIMAGE_H
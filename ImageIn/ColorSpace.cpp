@@ -0,0 +1,383 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ColorSpace.h"
+
+#include <cmath>
+#include <algorithm>
+#include "AlgorithmException.h"
+#include "CpuFeatures.h"
+
+#ifdef IMAGEIN_X86_SIMD
+#include <immintrin.h>
+#endif
+
+using namespace imagein;
+
+/*
+ * A linear conversion computes each channel of the result as (w0 * c0 + w1 * c1 + w2 * c2 + offset) >> 14, saturated to [0, 255],
+ * where c0, c1 and c2 are the channels of the source. The weights are 16 bits, so that the vector kernels can use _mm_madd_epi16.
+ */
+struct LinearChannel
+{
+    int16_t weights[3];
+    int32_t offset;
+};
+
+static const int FIXED_POINT_BITS = ColorSpace::fixedPointBits;
+
+bool ColorSpace::toFixedPoint(double weight, int16_t& fixed) {
+    const double w = std::floor(weight * (1 << FIXED_POINT_BITS) + 0.5);
+    if(w < -32768. || w > 32767.) return false;
+    fixed = static_cast<int16_t>(w);
+    return true;
+}
+
+//! Returns false if a weight doesn't fit in 16 bits once converted.
+static bool toLinearChannel(double w0, double w1, double w2, double offset, LinearChannel& channel) {
+    if(!ColorSpace::toFixedPoint(w0, channel.weights[0]) || !ColorSpace::toFixedPoint(w1, channel.weights[1])
+    || !ColorSpace::toFixedPoint(w2, channel.weights[2])) {
+        return false;
+    }
+    channel.offset = static_cast<int32_t>(std::floor(offset * (1 << FIXED_POINT_BITS) + 0.5));
+    return true;
+}
+
+static inline uint8_t saturate(int value) {
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+static inline uint8_t saturate(double value) {
+    return static_cast<uint8_t>(value < 0. ? 0. : (value > 255. ? 255. : value));
+}
+
+//! The shift of a negative sum rounds it down, as the vector shifts do.
+static inline uint8_t linearValue(uint8_t c0, uint8_t c1, uint8_t c2, const LinearChannel& channel) {
+    const int32_t sum = channel.weights[0] * c0 + channel.weights[1] * c1 + channel.weights[2] * c2 + channel.offset;
+    return saturate(static_cast<int>(sum >> FIXED_POINT_BITS));
+}
+
+//! Converts count pixels whose channels are stride values apart, as in an interleaved line.
+static void linearStrided(const uint8_t* c0, const uint8_t* c1, const uint8_t* c2, unsigned int stride, uint8_t* out, unsigned int outStride, unsigned int count, const LinearChannel& channel) {
+    for(unsigned int i = 0; i < count; ++i) {
+        out[i * outStride] = linearValue(c0[i * stride], c1[i * stride], c2[i * stride], channel);
+    }
+}
+
+typedef void (*LinearKernel)(const uint8_t* c0, const uint8_t* c1, const uint8_t* c2, uint8_t* out, unsigned int count, const LinearChannel& channel);
+
+static void linearScalar(const uint8_t* c0, const uint8_t* c1, const uint8_t* c2, uint8_t* out, unsigned int count, const LinearChannel& channel) {
+    linearStrided(c0, c1, c2, 1, out, 1, count, channel);
+}
+
+#ifdef IMAGEIN_X86_SIMD
+/*
+ * The values are widened to 16 bits, and c0 and c1 interleaved so that _mm_madd_epi16 computes w0 * c0 + w1 * c1 in 32 bits.
+ * The unpacks and the packs both work inside the 128 bits lanes, so the values end up in their original order with AVX2 too.
+ */
+__attribute__((target("sse2")))
+static void linearSse2(const uint8_t* c0, const uint8_t* c1, const uint8_t* c2, uint8_t* out, unsigned int count, const LinearChannel& channel) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i w01 = _mm_setr_epi16(channel.weights[0], channel.weights[1], channel.weights[0], channel.weights[1],
+                                       channel.weights[0], channel.weights[1], channel.weights[0], channel.weights[1]);
+    const __m128i w2 = _mm_setr_epi16(channel.weights[2], 0, channel.weights[2], 0, channel.weights[2], 0, channel.weights[2], 0);
+    const __m128i offset = _mm_set1_epi32(channel.offset);
+    unsigned int i = 0;
+    for(; i + 16 <= count; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c0 + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c1 + i));
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c2 + i));
+        const __m128i aLow = _mm_unpacklo_epi8(a, zero), aHigh = _mm_unpackhi_epi8(a, zero);
+        const __m128i bLow = _mm_unpacklo_epi8(b, zero), bHigh = _mm_unpackhi_epi8(b, zero);
+        const __m128i cLow = _mm_unpacklo_epi8(c, zero), cHigh = _mm_unpackhi_epi8(c, zero);
+        __m128i sums[4];
+        sums[0] = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(aLow, bLow), w01), _mm_madd_epi16(_mm_unpacklo_epi16(cLow, zero), w2));
+        sums[1] = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(aLow, bLow), w01), _mm_madd_epi16(_mm_unpackhi_epi16(cLow, zero), w2));
+        sums[2] = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(aHigh, bHigh), w01), _mm_madd_epi16(_mm_unpacklo_epi16(cHigh, zero), w2));
+        sums[3] = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(aHigh, bHigh), w01), _mm_madd_epi16(_mm_unpackhi_epi16(cHigh, zero), w2));
+        for(unsigned int k = 0; k < 4; ++k) {
+            sums[k] = _mm_srai_epi32(_mm_add_epi32(sums[k], offset), FIXED_POINT_BITS);
+        }
+        const __m128i result = _mm_packus_epi16(_mm_packs_epi32(sums[0], sums[1]), _mm_packs_epi32(sums[2], sums[3]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), result);
+    }
+    linearScalar(c0 + i, c1 + i, c2 + i, out + i, count - i, channel);
+}
+
+__attribute__((target("avx2")))
+static void linearAvx2(const uint8_t* c0, const uint8_t* c1, const uint8_t* c2, uint8_t* out, unsigned int count, const LinearChannel& channel) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i w01 = _mm256_set1_epi32(static_cast<int>((static_cast<uint32_t>(static_cast<uint16_t>(channel.weights[1])) << 16) | static_cast<uint16_t>(channel.weights[0])));
+    const __m256i w2 = _mm256_set1_epi32(static_cast<uint16_t>(channel.weights[2]));
+    const __m256i offset = _mm256_set1_epi32(channel.offset);
+    unsigned int i = 0;
+    for(; i + 32 <= count; i += 32) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c0 + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c1 + i));
+        const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c2 + i));
+        const __m256i aLow = _mm256_unpacklo_epi8(a, zero), aHigh = _mm256_unpackhi_epi8(a, zero);
+        const __m256i bLow = _mm256_unpacklo_epi8(b, zero), bHigh = _mm256_unpackhi_epi8(b, zero);
+        const __m256i cLow = _mm256_unpacklo_epi8(c, zero), cHigh = _mm256_unpackhi_epi8(c, zero);
+        __m256i sums[4];
+        sums[0] = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(aLow, bLow), w01), _mm256_madd_epi16(_mm256_unpacklo_epi16(cLow, zero), w2));
+        sums[1] = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(aLow, bLow), w01), _mm256_madd_epi16(_mm256_unpackhi_epi16(cLow, zero), w2));
+        sums[2] = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(aHigh, bHigh), w01), _mm256_madd_epi16(_mm256_unpacklo_epi16(cHigh, zero), w2));
+        sums[3] = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(aHigh, bHigh), w01), _mm256_madd_epi16(_mm256_unpackhi_epi16(cHigh, zero), w2));
+        for(unsigned int k = 0; k < 4; ++k) {
+            sums[k] = _mm256_srai_epi32(_mm256_add_epi32(sums[k], offset), FIXED_POINT_BITS);
+        }
+        const __m256i result = _mm256_packus_epi16(_mm256_packs_epi32(sums[0], sums[1]), _mm256_packs_epi32(sums[2], sums[3]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), result);
+    }
+    linearSse2(c0 + i, c1 + i, c2 + i, out + i, count - i, channel);
+}
+#endif
+
+static LinearKernel selectLinear() {
+#ifdef IMAGEIN_X86_SIMD
+    if(CpuFeatures::hasAvx2()) return linearAvx2;
+    if(CpuFeatures::hasSse2()) return linearSse2;
+#endif
+    return linearScalar;
+}
+
+static const LinearKernel linearLine = selectLinear();
+
+static void checkChannels(const Image_t<depth8_t>& from) {
+    if(from.getNbChannels() < 3) {
+        throw ImageTypeException(__LINE__, __FILE__);
+    }
+}
+
+//! Computes the channels of to from the first three channels of from, line by line.
+static void convertLinear(const Image_t<depth8_t>& from, Image_t<depth8_t>& to, const LinearChannel* channels) {
+    const unsigned int stride = from.getPixelStride();
+    const unsigned int outStride = to.getPixelStride();
+    const depth8_t* in = from.begin();
+    depth8_t* out = to.begin();
+    for(unsigned int j = 0; j < from.getHeight(); ++j) {
+        const depth8_t* c0 = in + j * from.getRowStride();
+        const depth8_t* c1 = c0 + from.getChannelStride();
+        const depth8_t* c2 = c1 + from.getChannelStride();
+        for(unsigned int k = 0; k < to.getNbChannels(); ++k) {
+            depth8_t* line = out + j * to.getRowStride() + k * to.getChannelStride();
+            if(stride == 1 && outStride == 1) {
+                linearLine(c0, c1, c2, line, from.getWidth(), channels[k]);
+            }
+            else {
+                linearStrided(c0, c1, c2, stride, line, outStride, from.getWidth(), channels[k]);
+            }
+        }
+    }
+}
+
+//! Computes the three channels of to from the first three channels of from, pixel by pixel.
+template <class Conversion>
+static void convertPixels(const Image_t<depth8_t>& from, Image_t<depth8_t>& to, const Conversion& conversion) {
+    const unsigned int stride = from.getPixelStride();
+    const unsigned int channelStride = from.getChannelStride();
+    const unsigned int outStride = to.getPixelStride();
+    const unsigned int outChannelStride = to.getChannelStride();
+    const depth8_t* in = from.begin();
+    depth8_t* out = to.begin();
+    for(unsigned int j = 0; j < from.getHeight(); ++j) {
+        const depth8_t* src = in + j * from.getRowStride();
+        depth8_t* dst = out + j * to.getRowStride();
+        for(unsigned int i = 0; i < from.getWidth(); ++i, src += stride, dst += outStride) {
+            conversion(src[0], src[channelStride], src[2 * channelStride], dst[0], dst[outChannelStride], dst[2 * outChannelStride]);
+        }
+    }
+}
+
+GrayscaleImage_t<depth8_t>* ColorSpace::rgbToGrayscale(const Image_t<depth8_t>& from, double r, double g, double b)
+{
+    checkChannels(from);
+    GrayscaleImage_t<depth8_t>* result = new GrayscaleImage_t<depth8_t>(from.getWidth(), from.getHeight(), NULL, from.hasAlignedRows());
+    LinearChannel channel;
+    if(toLinearChannel(r, g, b, 0., channel)) {
+        convertLinear(from, *result, &channel);
+        return result;
+    }
+    for(unsigned int j = 0; j < from.getHeight(); ++j) {
+        for(unsigned int i = 0; i < from.getWidth(); ++i) {
+            const double value = from.getPixelAt(i, j, 0) * r + from.getPixelAt(i, j, 1) * g + from.getPixelAt(i, j, 2) * b;
+            result->setPixelAt(i, j, saturate(std::floor(value)));
+        }
+    }
+    return result;
+}
+
+//The values are rounded : 0.5 is added to the offsets.
+Image_t<depth8_t>* ColorSpace::rgbToYCbCr(const Image_t<depth8_t>& from)
+{
+    checkChannels(from);
+    Image_t<depth8_t>* result = new Image_t<depth8_t>(from.getWidth(), from.getHeight(), 3, NULL, from.getLayout(), from.hasAlignedRows());
+    LinearChannel channels[3];
+    toLinearChannel(0.299, 0.587, 0.114, 0.5, channels[0]);
+    toLinearChannel(-0.168736, -0.331264, 0.5, 128.5, channels[1]);
+    toLinearChannel(0.5, -0.418688, -0.081312, 128.5, channels[2]);
+    convertLinear(from, *result, channels);
+    return result;
+}
+
+RgbImage_t<depth8_t>* ColorSpace::yCbCrToRgb(const Image_t<depth8_t>& from)
+{
+    checkChannels(from);
+    RgbImage_t<depth8_t>* result = new RgbImage_t<depth8_t>(from.getWidth(), from.getHeight(), NULL, from.getLayout(), from.hasAlignedRows());
+    LinearChannel channels[3];
+    toLinearChannel(1., 0., 1.402, -1.402 * 128. + 0.5, channels[0]);
+    toLinearChannel(1., -0.344136, -0.714136, (0.344136 + 0.714136) * 128. + 0.5, channels[1]);
+    toLinearChannel(1., 1.772, 0., -1.772 * 128. + 0.5, channels[2]);
+    convertLinear(from, *result, channels);
+    return result;
+}
+
+struct RgbToHsv
+{
+    inline void operator()(uint8_t r, uint8_t g, uint8_t b, uint8_t& h, uint8_t& s, uint8_t& v) const {
+        const int max = std::max(r, std::max(g, b));
+        const int min = std::min(r, std::min(g, b));
+        const int delta = max - min;
+        v = static_cast<uint8_t>(max);
+        s = (max == 0) ? 0 : static_cast<uint8_t>((255 * delta + max / 2) / max);
+        if(delta == 0) {
+            h = 0;
+            return;
+        }
+        double hue;
+        if(max == r) hue = static_cast<double>(g - b) / delta;
+        else if(max == g) hue = 2. + static_cast<double>(b - r) / delta;
+        else hue = 4. + static_cast<double>(r - g) / delta;
+        //The hue is in sixths of a turn, and a turn is 256.
+        const int value = static_cast<int>(std::floor(hue * 256. / 6. + 0.5));
+        h = static_cast<uint8_t>(value & 0xFF);
+    }
+};
+
+struct HsvToRgb
+{
+    inline void operator()(uint8_t h, uint8_t s, uint8_t v, uint8_t& r, uint8_t& g, uint8_t& b) const {
+        const double hue = h * 6. / 256.;
+        const int sector = static_cast<int>(hue);
+        const double f = hue - sector;
+        const double sat = s / 255.;
+        const uint8_t p = saturate(std::floor(v * (1. - sat) + 0.5));
+        const uint8_t q = saturate(std::floor(v * (1. - sat * f) + 0.5));
+        const uint8_t t = saturate(std::floor(v * (1. - sat * (1. - f)) + 0.5));
+        switch(sector) {
+            case 0: r = v; g = t; b = p; break;
+            case 1: r = q; g = v; b = p; break;
+            case 2: r = p; g = v; b = t; break;
+            case 3: r = p; g = q; b = v; break;
+            case 4: r = t; g = p; b = v; break;
+            default: r = v; g = p; b = q; break;
+        }
+    }
+};
+
+Image_t<depth8_t>* ColorSpace::rgbToHsv(const Image_t<depth8_t>& from)
+{
+    checkChannels(from);
+    Image_t<depth8_t>* result = new Image_t<depth8_t>(from.getWidth(), from.getHeight(), 3, NULL, from.getLayout(), from.hasAlignedRows());
+    convertPixels(from, *result, RgbToHsv());
+    return result;
+}
+
+RgbImage_t<depth8_t>* ColorSpace::hsvToRgb(const Image_t<depth8_t>& from)
+{
+    checkChannels(from);
+    RgbImage_t<depth8_t>* result = new RgbImage_t<depth8_t>(from.getWidth(), from.getHeight(), NULL, from.getLayout(), from.hasAlignedRows());
+    convertPixels(from, *result, HsvToRgb());
+    return result;
+}
+
+/*
+ * Lab goes through the linear RGB values and XYZ, with the D65 white point. The linear values of the 256 sRGB values
+ * are computed once.
+ */
+static const double LAB_EPSILON = 0.008856;
+static const double LAB_KAPPA = 7.787;
+
+static inline double labF(double t) {
+    return (t > LAB_EPSILON) ? std::pow(t, 1. / 3.) : LAB_KAPPA * t + 16. / 116.;
+}
+
+static inline double labInverseF(double t) {
+    const double cube = t * t * t;
+    return (cube > LAB_EPSILON) ? cube : (t - 16. / 116.) / LAB_KAPPA;
+}
+
+struct RgbToLab
+{
+    double linear[256];
+
+    RgbToLab() {
+        for(unsigned int v = 0; v < 256; ++v) {
+            const double c = v / 255.;
+            linear[v] = (c <= 0.04045) ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+        }
+    }
+
+    inline void operator()(uint8_t r, uint8_t g, uint8_t b, uint8_t& l, uint8_t& a, uint8_t& bb) const {
+        const double R = linear[r], G = linear[g], B = linear[b];
+        const double fx = labF((0.412453 * R + 0.357580 * G + 0.180423 * B) / 0.950456);
+        const double fy = labF(0.212671 * R + 0.715160 * G + 0.072169 * B);
+        const double fz = labF((0.019334 * R + 0.119193 * G + 0.950227 * B) / 1.088754);
+        l = saturate(std::floor((116. * fy - 16.) * 255. / 100. + 0.5));
+        a = saturate(std::floor(500. * (fx - fy) + 128.5));
+        bb = saturate(std::floor(200. * (fy - fz) + 128.5));
+    }
+};
+
+struct LabToRgb
+{
+    static inline uint8_t encode(double c) {
+        c = (c <= 0.0031308) ? 12.92 * c : 1.055 * std::pow(c, 1. / 2.4) - 0.055;
+        return saturate(std::floor(c * 255. + 0.5));
+    }
+
+    inline void operator()(uint8_t l, uint8_t a, uint8_t b, uint8_t& r, uint8_t& g, uint8_t& bb) const {
+        const double fy = (l * 100. / 255. + 16.) / 116.;
+        const double fx = fy + (a - 128.) / 500.;
+        const double fz = fy - (b - 128.) / 200.;
+        const double X = labInverseF(fx) * 0.950456;
+        const double Y = labInverseF(fy);
+        const double Z = labInverseF(fz) * 1.088754;
+        r = encode(3.240479 * X - 1.537150 * Y - 0.498535 * Z);
+        g = encode(-0.969256 * X + 1.875991 * Y + 0.041556 * Z);
+        bb = encode(0.055648 * X - 0.204043 * Y + 1.057311 * Z);
+    }
+};
+
+Image_t<depth8_t>* ColorSpace::rgbToLab(const Image_t<depth8_t>& from)
+{
+    checkChannels(from);
+    static const RgbToLab conversion;
+    Image_t<depth8_t>* result = new Image_t<depth8_t>(from.getWidth(), from.getHeight(), 3, NULL, from.getLayout(), from.hasAlignedRows());
+    convertPixels(from, *result, conversion);
+    return result;
+}
+
+RgbImage_t<depth8_t>* ColorSpace::labToRgb(const Image_t<depth8_t>& from)
+{
+    checkChannels(from);
+    RgbImage_t<depth8_t>* result = new RgbImage_t<depth8_t>(from.getWidth(), from.getHeight(), NULL, from.getLayout(), from.hasAlignedRows());
+    convertPixels(from, *result, LabToRgb());
+    return result;
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COLORSPACE_H
+#define COLORSPACE_H
+
+#include "Image.h"
+#include "GrayscaleImage.h"
+#include "RgbImage.h"
+
+namespace imagein
+{
+    /*!
+     * \brief Conversions of 8 bits RGB images to grayscale and to other colour spaces, and back.
+     *
+     * The conversions which are linear (grayscale, YCbCr) use integer weights with 14 fractional bits. When the layout is planar,
+     * they are computed on whole lines of the channels with SSE2 or AVX2. HSV and Lab are computed pixel by pixel.
+     *
+     * The converted images have 3 channels, in the order of the name of the colour space, and the layout and padding of the source.
+     * All the values are scaled to [0, 255] :
+     * - YCbCr is the full range version of the JPEG files.
+     * - HSV has its hue in [0, 255] for [0, 360[ degrees.
+     * - Lab has L * 255 / 100, and a and b shifted by 128. The RGB values are sRGB with the D65 white point.
+     *
+     * Every method throws an ImageTypeException if the source has less than 3 channels.
+     */
+    class ColorSpace
+    {
+        public:
+            /*!
+             * \brief Converts an RGB image to grayscale with a weighted sum of the channels : gray = r * R + g * G + b * B.
+             *
+             * The sum is rounded down and saturated. When a weight doesn't fit in [-2, 2[, the sum is computed in floating point.
+             */
+            static GrayscaleImage_t<depth8_t>* rgbToGrayscale(const Image_t<depth8_t>& from, double r = 0.299, double g = 0.587, double b = 0.114);
+
+            //! Number of fractional bits of the weights of the linear conversions.
+            static const int fixedPointBits = 14;
+
+            /*!
+             * \brief Converts a weight of a linear conversion to fixed point, rounded to the nearest.
+             *
+             * \return false if the weight doesn't fit in 16 bits once converted : the conversion is then computed in floating point.
+             */
+            static bool toFixedPoint(double weight, int16_t& fixed);
+
+            //! Converts an RGB image to YCbCr.
+            static Image_t<depth8_t>* rgbToYCbCr(const Image_t<depth8_t>& from);
+            //! Converts an YCbCr image to RGB.
+            static RgbImage_t<depth8_t>* yCbCrToRgb(const Image_t<depth8_t>& from);
+
+            //! Converts an RGB image to HSV.
+            static Image_t<depth8_t>* rgbToHsv(const Image_t<depth8_t>& from);
+            //! Converts an HSV image to RGB.
+            static RgbImage_t<depth8_t>* hsvToRgb(const Image_t<depth8_t>& from);
+
+            //! Converts an RGB image to Lab.
+            static Image_t<depth8_t>* rgbToLab(const Image_t<depth8_t>& from);
+            //! Converts a Lab image to RGB.
+            static RgbImage_t<depth8_t>* labToRgb(const Image_t<depth8_t>& from);
+    };
+}
+
+#endif // COLORSPACE_H
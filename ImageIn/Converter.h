@@ -23,6 +23,7 @@
 #include "Image.h"
 #include "GrayscaleImage.h"
 #include "RgbImage.h"
+#include "LookupTable.h"
 
 #include <cmath>
 #include <iostream>
@@ -35,6 +36,9 @@ namespace imagein {
      *
      * This class contains static methods used to convert an image from one imagein
      * type to another. All the content of this class is present in the specialization.
+     *
+     * When the values don't need to change, as for a conversion to the same type, the returned image
+     * shares the buffer of the source image (see Image_t::share()) instead of copying it.
      */
     template <typename T>
     class Converter
@@ -49,7 +49,16 @@ namespace imagein {
   template <typename D>
   RgbImage_t<D>* Converter<RgbImage_t<D> >::convert(const RgbImage_t<D>& from)
   {
-      return new RgbImage_t<D>(from.getWidth(), from.getHeight(), from.begin());
+      if(from.isContiguous()) {
+          RgbImage_t<D>* resImg = new RgbImage_t<D>();
+          resImg->share(from);
+          return resImg;
+      }
+      RgbImage_t<D>* resImg = new RgbImage_t<D>(from.getWidth(), from.getHeight(), NULL, from.getLayout());
+      for(unsigned int c = 0; c < 3; ++c) {
+          std::copy(from.channelBegin(c), from.channelEnd(c), resImg->channelBegin(c));
+      }
+      return resImg;
   }
 
   template <typename D>
@@ -78,6 +87,11 @@ namespace imagein {
 //      }
 
 //      return new RgbImage_t<D>(from.getWidth(), from.getHeight(), data);
+      if(from.getNbChannels() == 3 && from.isContiguous()) {
+          RgbImage_t<D>* resImg = new RgbImage_t<D>();
+          resImg->share(from);
+          return resImg;
+      }
       RgbImage_t<D>* resImg = new RgbImage_t<D>(from.getWidth(), from.getHeight());
       if(from.getNbChannels() < 3) {
           for(unsigned int j = 0; j < resImg->getHeight(); ++j) {
@@ -104,7 +118,14 @@ namespace imagein {
   template <typename D>
   GrayscaleImage_t<D>* Converter<GrayscaleImage_t<D> >::convert(const GrayscaleImage_t<D>& from)
   {
-      return new GrayscaleImage_t<D>(from.getWidth(), from.getHeight(), from.begin());
+      if(from.isContiguous()) {
+          GrayscaleImage_t<D>* resImg = new GrayscaleImage_t<D>();
+          resImg->share(from);
+          return resImg;
+      }
+      GrayscaleImage_t<D>* resImg = new GrayscaleImage_t<D>(from.getWidth(), from.getHeight());
+      std::copy(from.channelBegin(0), from.channelEnd(0), resImg->channelBegin(0));
+      return resImg;
   }
 
   template <typename D>
@@ -163,6 +184,11 @@ namespace imagein {
 //      }
 
 //      return new GrayscaleImage_t<D>(from.getWidth(), from.getHeight(), data);
+      if(from.getNbChannels() == 1 && from.isContiguous()) {
+          GrayscaleImage_t<D>* resImg = new GrayscaleImage_t<D>();
+          resImg->share(from);
+          return resImg;
+      }
       GrayscaleImage_t<D>* resImg = new GrayscaleImage_t<D>(from.getWidth(), from.getHeight());
       if(from.getNbChannels() < 3) {
           for(unsigned int j = 0; j < resImg->getHeight(); ++j) {
@@ -188,19 +214,34 @@ namespace imagein {
   template <typename D>
   Image_t<D>* Converter<Image_t<D> >::convert(const GrayscaleImage_t<D>& from)
   {
-      return new Image_t<D>(from.getWidth(), from.getHeight(), 1, from.begin());
+      if(from.isContiguous()) {
+          Image_t<D>* resImg = new Image_t<D>();
+          resImg->share(from);
+          return resImg;
+      }
+      return new Image_t<D>(from, LAYOUT_PLANAR);
   }
 
   template <typename D>
   Image_t<D>* Converter<Image_t<D> >::convert(const RgbImage_t<D>& from)
   {
-      return new Image_t<D>(from.getWidth(), from.getHeight(), 3, from.begin());
+      if(from.isContiguous()) {
+          Image_t<D>* resImg = new Image_t<D>();
+          resImg->share(from);
+          return resImg;
+      }
+      return new Image_t<D>(from, from.getLayout());
   }
 
   template <typename D>
   Image_t<D>* Converter<Image_t<D> >::convert(const Image_t<D>& from)
   {
-      return new Image_t<D>(from.getWidth(), from.getHeight(), from.getNbChannels(), from.begin());
+      if(from.isContiguous()) {
+          Image_t<D>* resImg = new Image_t<D>();
+          resImg->share(from);
+          return resImg;
+      }
+      return new Image_t<D>(from, from.getLayout());
   }
 
   template <typename D>
@@ -272,6 +313,14 @@ namespace imagein {
   template <typename D>
   Image_t<D>* Converter<Image_t<D> >::makeDisplayable(const Image_t<bool>& from)
   {
+    if(std::numeric_limits<D>::is_integer && sizeof(D) == 1) {
+      Image_t<D>* image = new Image_t<D>(from.getWidth(), from.getHeight(), from.getNbChannels(), NULL, from.getLayout());
+      LookupTable table;
+      table[false] = static_cast<uint8_t>(std::numeric_limits<D>::min());
+      table[true] = static_cast<uint8_t>(std::numeric_limits<D>::max());
+      table.apply(from, *image);
+      return image;
+    }
     Image_t<D>* image = new Image_t<D>(from.getWidth(), from.getHeight(), from.getNbChannels());
     
     for(unsigned int i = 0; i < from.getWidth(); i++)
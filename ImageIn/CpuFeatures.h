@@ -0,0 +1,48 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CPUFEATURES_H
+#define CPUFEATURES_H
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+//! Defined when the vectorized x86 kernels can be compiled (they are selected at runtime).
+#define IMAGEIN_X86_SIMD
+#endif
+
+namespace imagein
+{
+    /*!
+     * \brief Runtime detection of the instruction set extensions of the processor.
+     *
+     * The vectorized kernels of the library are compiled for several instruction sets and
+     * this class is used to select the best one the processor supports.
+     * When IMAGEIN_X86_SIMD is not defined (other compilers or architectures), every method returns false
+     * and the portable implementations are used.
+     */
+    class CpuFeatures
+    {
+        public:
+            //! Returns true if the SSE2 instructions are available.
+            static bool hasSse2();
+            //! Returns true if the AVX2 instructions are available.
+            static bool hasAvx2();
+    };
+}
+
+#endif // CPUFEATURES_H
@@ -48,9 +48,11 @@ namespace imagein
              * \param width The image width
              * \param height The image height
              * \param data The actual data matrix containing the pixels of the image.  No verification of the size of the array is performed.
+             * \param alignRows If true, each line is padded to start on an ALIGNMENT bytes boundary.
 			 *
              */
-            GrayscaleImage_t(unsigned int width=0, unsigned int height=0, const D* data=NULL) : Image_t<D>(width, height, 1, data) {};
+            GrayscaleImage_t(unsigned int width=0, unsigned int height=0, const D* data=NULL, bool alignRows=false)
+                : Image_t<D>(width, height, 1, data, LAYOUT_PLANAR, alignRows) {};
             explicit GrayscaleImage_t(const Image_t<D>* img, unsigned int c);
 		
 			/*!
@@ -70,6 +72,12 @@ namespace imagein
 			 * \param other The Image to be copied.
 			 */
             GrayscaleImage_t(const GrayscaleImage_t<D>& other) : Image_t<D>(other) {}
+
+#ifdef IMAGEIN_HAS_RVALUE_REFERENCES
+            GrayscaleImage_t(GrayscaleImage_t<D>&& other) : Image_t<D>(std::move(other)) {}
+            GrayscaleImage_t<D>& operator=(const GrayscaleImage_t<D>& other) { Image_t<D>::operator=(other); return *this; }
+            GrayscaleImage_t<D>& operator=(GrayscaleImage_t<D>&& other) { Image_t<D>::operator=(std::move(other)); return *this; }
+#endif
 			
 			/*!
              * \brief Crops the image to the boundaries defined by a Rectangle.
@@ -32,14 +32,14 @@ imagein::GrayscaleImage_t<D>::GrayscaleImage_t(std::string filename)
 template <typename D>
 imagein::GrayscaleImage_t<D>* imagein::GrayscaleImage_t<D>::crop(const imagein::Rectangle& rect) const
 {
-    imagein::GrayscaleImage_t<D>* ret = new imagein::GrayscaleImage_t<D>(rect.w, rect.h);
+    imagein::GrayscaleImage_t<D>* ret = new imagein::GrayscaleImage_t<D>(rect.w, rect.h, NULL, this->_alignedRows);
 
-    Image_t<D>::crop(rect, ret->_mat);
+    Image_t<D>::crop(rect, *ret);
 
     return ret;
 }
 
 template <typename D>
-imagein::GrayscaleImage_t<D>::GrayscaleImage_t(const Image_t<D>* img, unsigned int c) : imagein::Image_t<D>(img->getWidth(), img->getHeight(), 1, &img->begin()[c*img->getWidth()*img->getHeight()]) {
-
+imagein::GrayscaleImage_t<D>::GrayscaleImage_t(const Image_t<D>* img, unsigned int c) : imagein::Image_t<D>(img->getWidth(), img->getHeight(), 1) {
+    std::copy(img->channelBegin(c), img->channelEnd(c), this->begin());
 }
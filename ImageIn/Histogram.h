@@ -20,6 +20,8 @@
 #ifndef HISTOGRAM_H
 #define HISTOGRAM_H
 
+#include <vector>
+
 #include "Array.h"
 #include "Rectangle.h"
 
@@ -33,11 +35,23 @@ namespace imagein
      * \brief This class is used to represent Image Histograms.
      *
      * This class inherits Array, therefore it's a fixed-size array of integers, the element with rank K of the array is the number of pixels of the given value on the Kth row/column of the Image (cropped from the Rectangle).
+     *
+     * Each element (bin) counts the values of a range [getBinStart(K), getBinStart(K+1)[. For 8-bit images, there is by default one bin
+     * for each of the 256 values. For the other depths, the range of the histogram is by default the minimum and maximum values of the image,
+     * split in DEFAULT_NB_BINS bins (bins of integer images cover a power of two number of values). The range and the number of bins
+     * can also be given explicitly, the values outside of the range are then not counted.
+     *
+     * The lines of the image are split in strips counted by the threads of the ThreadPool. Each strip has its own bins, merged at the end,
+     * so that the threads never write to the same counters. Within a strip, the values are counted in 4 interleaved sets of bins,
+     * so that consecutive equal values don't wait for each other's increment.
      */
     class Histogram : public Array<unsigned int>
     {
             
          public:
+          //! Number of bins of the histograms of images that are not 8-bit, if not given.
+          static const unsigned int DEFAULT_NB_BINS = 256;
+
         /*!
          * \brief Constructs an Histogram from an image.
          *
@@ -57,10 +71,79 @@ namespace imagein
           template <typename D>
           Histogram(const Image_t<D>& img, const Rectangle& rect = Rectangle());
 
+        /*!
+         * \brief Constructs an Histogram covering the values of an image with a given number of bins.
+         *
+         * The range of the histogram is the minimum and maximum values of the channel in the rectangle.
+         *
+         * \param img The image from which to compute the histogram.
+         * \param channel The channel to consider for the values.
+         * \param nbBins The maximum number of bins. Integer images may need less bins to cover their values.
+         * \param rect A rectangle used to crop the image before computing the Histogram.
+         */
+          template <typename D>
+          Histogram(const Image_t<D>& img, unsigned int channel, unsigned int nbBins, const Rectangle& rect = Rectangle());
+
+        /*!
+         * \brief Constructs an Histogram of the values of an image in a given range.
+         *
+         * \param img The image from which to compute the histogram.
+         * \param channel The channel to consider for the values.
+         * \param min The start of the range.
+         * \param max The end of the range, counted in the last bin.
+         * \param nbBins The number of bins.
+         * \param rect A rectangle used to crop the image before computing the Histogram.
+         */
+          template <typename D>
+          Histogram(const Image_t<D>& img, unsigned int channel, double min, double max, unsigned int nbBins, const Rectangle& rect = Rectangle());
+
+        /*!
+         * \brief Computes the histograms of all the channels of an image in one pass.
+         *
+         * \param img The image from which to compute the histograms.
+         * \param rect A rectangle used to crop the image before computing the Histograms.
+         * \return The histogram of each channel, in the order of the channels.
+         */
+          template <typename D>
+          static std::vector<Histogram> computeAll(const Image_t<D>& img, const Rectangle& rect = Rectangle());
+
+          //! Returns the first value counted in the histogram.
+          inline double getMin() const { return _min; }
+          //! Returns the end of the range of the values counted in the histogram.
+          inline double getMax() const { return _max; }
+          //! Returns the size of the range of values counted in each bin.
+          inline double getBinWidth() const { return _binWidth; }
+          //! Returns the first value counted in a bin.
+          inline double getBinStart(unsigned int bin) const { return _min + bin * _binWidth; }
+
           private:
 
+          Histogram() : _min(0.), _max(0.), _binWidth(1.) {}
+
+          struct Binning;
+          struct ByteIndex;
+          struct IntegerIndex;
+          struct RealIndex;
+
+          template <typename D, class Index>
+          class BuildTask;
+
+          /*!
+           * \brief Counts the values of the channels [firstChannel, firstChannel+nChannels[ in the histograms [histograms, histograms+nChannels[.
+           *
+           * \throw out_of_range if the rectangle or the channels are not in the image.
+           */
           template<typename D>
-          void computeHistogram(const Image_t<D>& img, unsigned int channel, const Rectangle& rect);
+          static void compute(const Image_t<D>& img, unsigned int firstChannel, unsigned int nChannels, const Rectangle& rect, const Binning& binning, Histogram* histograms);
+
+          //! Counts the values with an Index per channel, giving the bin of each value.
+          template<typename D, class Index>
+          static void count(const Image_t<D>& img, unsigned int firstChannel, unsigned int x, unsigned int y, unsigned int width, unsigned int height,
+                            const std::vector<Index>& indices, Histogram* histograms);
+
+          double _min;
+          double _max;
+          double _binWidth;
     };
 
     class CumulatedHistogram : public Array<double>
@@ -85,10 +168,18 @@ namespace imagein
           template <typename D>
           CumulatedHistogram(const Image_t<D>& img, const Rectangle& rect = Rectangle());
 
+        /*!
+         * \brief Constructs a Cumulated histogram from an already computed Histogram.
+         *
+         * The values are divided by the number of pixels counted in the histogram.
+         *
+         * \param histogram The histogram to cumulate.
+         */
+          explicit CumulatedHistogram(const Histogram& histogram);
+
           private:
 
-          template<typename D>
-          void computeHistogram(const Image_t<D>& img, unsigned int channel, const Rectangle& rect);
+          void cumulate(const Histogram& histogram);
     };
 }
 
@@ -19,61 +19,334 @@
 
 #include "Histogram.h"
 #include "Image.h"
+#include "ThreadPool.h"
 
 #include <cmath>
 #include <iostream>
 #include <cstdlib>
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
 
 template <typename D>
-imagein::Histogram::Histogram(const imagein::Image_t<D>& img, unsigned int channel, const imagein::Rectangle& rect) : imagein::Array<unsigned int>(1 << (sizeof(D)*8))
+imagein::Histogram::Histogram(const imagein::Image_t<D>& img, unsigned int channel, const imagein::Rectangle& rect)
 {
-    this->computeHistogram(img, channel, rect);
+    compute(img, channel, 1, rect, Binning(0), this);
 }
 
 template <typename D>
-imagein::Histogram::Histogram(const imagein::Image_t<D>& img, const imagein::Rectangle& rect) : imagein::Array<unsigned int>(1 << (sizeof(D)*8))
+imagein::Histogram::Histogram(const imagein::Image_t<D>& img, const imagein::Rectangle& rect)
 {
-    this->computeHistogram(img, 0, rect);
+    compute(img, 0, 1, rect, Binning(0), this);
 }
 
-template<typename D>
-void imagein::Histogram::computeHistogram(const Image_t<D>& img, unsigned int channel, const Rectangle& rect)
+template <typename D>
+imagein::Histogram::Histogram(const imagein::Image_t<D>& img, unsigned int channel, unsigned int nbBins, const imagein::Rectangle& rect)
 {
-    for(unsigned int i=0; i<this->_width; i++) {
-        this->_array[i] = 0;
+    compute(img, channel, 1, rect, Binning(nbBins), this);
+}
+
+template <typename D>
+imagein::Histogram::Histogram(const imagein::Image_t<D>& img, unsigned int channel, double min, double max, unsigned int nbBins, const imagein::Rectangle& rect)
+{
+    compute(img, channel, 1, rect, Binning(min, max, nbBins), this);
+}
+
+template <typename D>
+std::vector<imagein::Histogram> imagein::Histogram::computeAll(const imagein::Image_t<D>& img, const imagein::Rectangle& rect)
+{
+    std::vector<Histogram> histograms(img.getNbChannels(), Histogram());
+    if(!histograms.empty()) {
+        compute(img, 0, img.getNbChannels(), rect, Binning(0), &histograms[0]);
+    }
+    return histograms;
+}
+
+//! Range and number of bins asked for an histogram.
+struct imagein::Histogram::Binning
+{
+    //! Range of the values of the image, with nbBins bins (0 for the default).
+    explicit Binning(unsigned int n) : nbBins(n), autoRange(true), min(0.), max(0.) {}
+    //! Given range.
+    Binning(double mi, double ma, unsigned int n) : nbBins(n), autoRange(false), min(mi), max(ma) {}
+
+    unsigned int nbBins;
+    bool autoRange;
+    double min;
+    double max;
+};
+
+/*
+ * The indices give the bin of a value, or nbBins() if the value must not be counted.
+ * 8-bit values are read as unsigned.
+ */
+
+//! One bin for each 8-bit value.
+struct imagein::Histogram::ByteIndex
+{
+    inline unsigned int nbBins() const { return 256; }
+    inline double start() const { return 0.; }
+    inline double end() const { return 256.; }
+    inline double binWidth() const { return 1.; }
+
+    template <typename D>
+    inline unsigned int operator()(D value) const { return static_cast<unsigned char>(value); }
+};
+
+//! Bins of 2^shift integer values from min, computed with a subtraction and a shift.
+struct imagein::Histogram::IntegerIndex
+{
+    IntegerIndex(long long min, long long max, unsigned int maxBins) : _min(min), _shift(0) {
+        const unsigned long long last = static_cast<unsigned long long>(max - min);
+        while((last >> _shift) + 1 > maxBins) ++_shift;
+        _nbBins = static_cast<unsigned int>((last >> _shift) + 1);
+    }
+
+    inline unsigned int nbBins() const { return _nbBins; }
+    inline double start() const { return static_cast<double>(_min); }
+    inline double end() const { return static_cast<double>(_min) + binWidth() * _nbBins; }
+    inline double binWidth() const { return static_cast<double>(1ull << _shift); }
+
+    template <typename D>
+    inline unsigned int operator()(D value) const {
+        const long long v = (sizeof(D) == 1) ? static_cast<long long>(static_cast<unsigned char>(value)) : static_cast<long long>(value);
+        const unsigned long long bin = static_cast<unsigned long long>(v - _min) >> _shift;
+        return bin < _nbBins ? static_cast<unsigned int>(bin) : _nbBins;
     }
+
+    long long _min;
+    unsigned int _shift;
+    unsigned int _nbBins;
+};
+
+//! Bins of equal width in [min, max], max being counted in the last bin.
+struct imagein::Histogram::RealIndex
+{
+    RealIndex(double min, double max, unsigned int nbBins) : _min(min), _max(max), _nbBins(std::max(nbBins, 1u)) {
+        _scale = (max > min) ? _nbBins / (max - min) : 0.;
+    }
+
+    inline unsigned int nbBins() const { return _nbBins; }
+    inline double start() const { return _min; }
+    inline double end() const { return _max; }
+    inline double binWidth() const { return (_max > _min) ? (_max - _min) / _nbBins : 0.; }
+
+    template <typename D>
+    static inline double value(D value) {
+        return (sizeof(D) == 1) ? static_cast<double>(static_cast<unsigned char>(value)) : static_cast<double>(value);
+    }
+
+    template <typename D>
+    inline unsigned int operator()(D value) const {
+        const double v = RealIndex::value(value);
+        if(!(v >= _min && v <= _max)) return _nbBins;
+        const unsigned int bin = static_cast<unsigned int>((v - _min) * _scale);
+        return bin < _nbBins ? bin : _nbBins - 1;
+    }
+
+    double _min;
+    double _max;
+    double _scale;
+    unsigned int _nbBins;
+};
+
+/*!
+ * \brief Counts the values of the lines of a strip in the bins of the strip.
+ *
+ * The bins of a strip are laid out by channel, then by lane, then by bin. Each lane has an extra bin
+ * for the values that are not counted.
+ */
+template <typename D, class Index>
+class imagein::Histogram::BuildTask : public imagein::ParallelTask
+{
+    public:
+        BuildTask(const Image_t<D>& img, unsigned int firstChannel, unsigned int x, unsigned int width, const std::vector<unsigned int>& rows,
+                  const std::vector<Index>& indices, const std::vector<unsigned int>& offsets, unsigned int nbLanes,
+                  std::vector<std::vector<unsigned int> >& bins)
+         : _img(img), _firstChannel(firstChannel), _x(x), _width(width), _rows(rows), _indices(indices), _offsets(offsets), _nbLanes(nbLanes), _bins(bins) {}
+
+        void run(unsigned int begin, unsigned int end) {
+            for(unsigned int s = begin; s < end; ++s) {
+                _bins[s].assign(_offsets.back(), 0);
+                for(unsigned int c = 0; c < _indices.size(); ++c) {
+                    unsigned int* bins = &_bins[s][_offsets[c]];
+                    const D* line = _img.begin() + (_firstChannel + c) * _img.getChannelStride() + _x * _img.getPixelStride();
+                    for(unsigned int j = _rows[s]; j < _rows[s+1]; ++j) {
+                        countLine(line + j * _img.getRowStride(), _indices[c], bins, _indices[c].nbBins() + 1);
+                    }
+                }
+            }
+        }
+
+    private:
+        void countLine(const D* it, const Index& index, unsigned int* bins, unsigned int size) const {
+            const unsigned int stride = _img.getPixelStride();
+            unsigned int* bins0 = bins;
+            unsigned int* bins1 = bins + (1 % _nbLanes) * size;
+            unsigned int* bins2 = bins + (2 % _nbLanes) * size;
+            unsigned int* bins3 = bins + (3 % _nbLanes) * size;
+            unsigned int i = 0;
+            for(; i + 4 <= _width; i += 4, it += 4 * stride) {
+                ++bins0[index(it[0])];
+                ++bins1[index(it[stride])];
+                ++bins2[index(it[2 * stride])];
+                ++bins3[index(it[3 * stride])];
+            }
+            for(; i < _width; ++i, it += stride) {
+                ++bins0[index(*it)];
+            }
+        }
+
+        const Image_t<D>& _img;
+        unsigned int _firstChannel;
+        unsigned int _x;
+        unsigned int _width;
+        const std::vector<unsigned int>& _rows;
+        const std::vector<Index>& _indices;
+        const std::vector<unsigned int>& _offsets;
+        unsigned int _nbLanes;
+        std::vector<std::vector<unsigned int> >& _bins;
+};
+
+template<typename D>
+void imagein::Histogram::compute(const Image_t<D>& img, unsigned int firstChannel, unsigned int nChannels, const Rectangle& rect, const Binning& binning, Histogram* histograms)
+{
     unsigned int maxw = rect.w > 0 ? rect.x+rect.w : img.getWidth();
     unsigned int maxh = rect.h > 0 ? rect.y+rect.h : img.getHeight();
-	
-    for(unsigned int j=rect.y; j<maxh; j++) {
-        for(unsigned int i=rect.x; i<maxw; i++) {
-            D pixel = img.getPixel(i, j, channel);
-            //unsigned int value = pixel >= 0 ? pixel : this->_width + pixel;
-            this->_array[static_cast<unsigned int>(pixel)]++;
+    if(maxw > img.getWidth() || maxh > img.getHeight() || firstChannel + nChannels > img.getNbChannels()) {
+        throw std::out_of_range("Invalid rectangle or channel for the histogram");
+    }
+    const unsigned int width = maxw > rect.x ? maxw - rect.x : 0;
+    const unsigned int height = maxh > rect.y ? maxh - rect.y : 0;
+
+    if(!binning.autoRange) {
+        count(img, firstChannel, rect.x, rect.y, width, height, std::vector<RealIndex>(nChannels, RealIndex(binning.min, binning.max, binning.nbBins)), histograms);
+        return;
+    }
+    if(sizeof(D) == 1 && binning.nbBins == 0) {
+        count(img, firstChannel, rect.x, rect.y, width, height, std::vector<ByteIndex>(nChannels), histograms);
+        return;
+    }
+
+    //The range of each channel.
+    std::vector<double> mins(nChannels, 0.), maxs(nChannels, 0.);
+    const unsigned int pixelStride = img.getPixelStride();
+    for(unsigned int c = 0; c < nChannels && width > 0 && height > 0; ++c) {
+        const D* line = img.begin() + (firstChannel + c) * img.getChannelStride() + rect.y * img.getRowStride() + rect.x * pixelStride;
+        double min = std::numeric_limits<double>::max(), max = -min;
+        for(unsigned int j = 0; j < height; ++j, line += img.getRowStride()) {
+            const D* it = line;
+            for(unsigned int i = 0; i < width; ++i, it += pixelStride) {
+                const double v = RealIndex::value(*it);
+                if(v < min) min = v;
+                if(v > max) max = v;
+            }
+        }
+        //Only NaNs.
+        if(min > max) min = max = 0.;
+        mins[c] = min;
+        maxs[c] = max;
+    }
+
+    const unsigned int nbBins = binning.nbBins > 0 ? binning.nbBins : DEFAULT_NB_BINS;
+    if(std::numeric_limits<D>::is_integer) {
+        std::vector<IntegerIndex> indices;
+        for(unsigned int c = 0; c < nChannels; ++c) {
+            indices.push_back(IntegerIndex(static_cast<long long>(mins[c]), static_cast<long long>(maxs[c]), nbBins));
+        }
+        count(img, firstChannel, rect.x, rect.y, width, height, indices, histograms);
+    }
+    else {
+        std::vector<RealIndex> indices;
+        for(unsigned int c = 0; c < nChannels; ++c) {
+            indices.push_back(RealIndex(mins[c], maxs[c], nbBins));
+        }
+        count(img, firstChannel, rect.x, rect.y, width, height, indices, histograms);
+    }
+}
+
+template<typename D, class Index>
+void imagein::Histogram::count(const Image_t<D>& img, unsigned int firstChannel, unsigned int x, unsigned int y, unsigned int width, unsigned int height,
+                               const std::vector<Index>& indices, Histogram* histograms)
+{
+    const unsigned int nChannels = indices.size();
+    unsigned int maxBins = 0;
+    for(unsigned int c = 0; c < nChannels; ++c) {
+        maxBins = std::max(maxBins, indices[c].nbBins() + 1);
+    }
+    //Interleaved sets of bins only while they stay small enough to be cached.
+    const unsigned int nbLanes = maxBins <= 4096 ? 4 : 1;
+    std::vector<unsigned int> offsets(nChannels + 1, 0);
+    for(unsigned int c = 0; c < nChannels; ++c) {
+        offsets[c+1] = offsets[c] + nbLanes * (indices[c].nbBins() + 1);
+    }
+
+    //Each strip must count enough values to be worth clearing and merging its bins.
+    const unsigned long minStripValues = std::max(1ul << 16, 16ul * offsets.back());
+    unsigned long nStrips = (static_cast<unsigned long>(width) * height * nChannels) / minStripValues;
+    nStrips = std::max(1ul, std::min(nStrips, static_cast<unsigned long>(ThreadPool::instance().getNbThreads())));
+    std::vector<unsigned int> rows(nStrips + 1);
+    for(unsigned int s = 0; s <= nStrips; ++s) {
+        rows[s] = y + (s * height) / nStrips;
+    }
+
+    std::vector<std::vector<unsigned int> > bins(nStrips);
+    BuildTask<D, Index> task(img, firstChannel, x, width, rows, indices, offsets, nbLanes, bins);
+    if(nStrips > 1) {
+        ThreadPool::instance().parallelFor(task, 0, nStrips, 1);
+    }
+    else {
+        task.run(0, 1);
+    }
+
+    for(unsigned int c = 0; c < nChannels; ++c) {
+        const unsigned int size = indices[c].nbBins();
+        Histogram& histogram = histograms[c];
+        static_cast<Array<unsigned int>&>(histogram) = Array<unsigned int>(size);
+        histogram._min = indices[c].start();
+        histogram._max = indices[c].end();
+        histogram._binWidth = indices[c].binWidth();
+        std::fill(histogram._array, histogram._array + size, 0u);
+        for(unsigned int s = 0; s < nStrips; ++s) {
+            const unsigned int* stripBins = &bins[s][offsets[c]];
+            for(unsigned int l = 0; l < nbLanes; ++l, stripBins += size + 1) {
+                for(unsigned int i = 0; i < size; ++i) {
+                    histogram._array[i] += stripBins[i];
+                }
+            }
         }
     }
 }
 
 template <typename D>
-imagein::CumulatedHistogram::CumulatedHistogram(const imagein::Image_t<D>& img, unsigned int channel, const imagein::Rectangle& rect) : imagein::Array<double>(1 << (sizeof(D)*8))
+imagein::CumulatedHistogram::CumulatedHistogram(const imagein::Image_t<D>& img, unsigned int channel, const imagein::Rectangle& rect)
 {
-    this->computeHistogram(img, channel, rect);
+    this->cumulate(img.getHistogram(channel, rect));
 }
 
 template <typename D>
-imagein::CumulatedHistogram::CumulatedHistogram(const imagein::Image_t<D>& img, const imagein::Rectangle& rect) : imagein::Array<unsigned int>(1 << (sizeof(D)*8))
+imagein::CumulatedHistogram::CumulatedHistogram(const imagein::Image_t<D>& img, const imagein::Rectangle& rect)
 {
-    this->computeHistogram(img, 0, rect);
+    this->cumulate(img.getHistogram(0, rect));
 }
 
-template<typename D>
-void imagein::CumulatedHistogram::computeHistogram(const Image_t<D>& img, unsigned int channel, const Rectangle& rect)
+inline imagein::CumulatedHistogram::CumulatedHistogram(const imagein::Histogram& histogram) : imagein::Array<double>(histogram.getWidth())
 {
-    Histogram histo = img.getHistogram(channel, rect);
+    this->cumulate(histogram);
+}
+
+inline void imagein::CumulatedHistogram::cumulate(const Histogram& histogram)
+{
+    if(this->_width != histogram.getWidth()) {
+        Array<double>::operator=(Array<double>(histogram.getWidth()));
+    }
+    double total = 0.;
+    for(unsigned int i=0; i<this->_width; i++) {
+        total += histogram[i];
+    }
     double cumul = 0.;
-    double imgSize = img.getWidth() * img.getHeight();
     for(unsigned int i=0; i<this->_width; i++) {
-        cumul += histo[i] / imgSize;
-        this->_array[i] = cumul;
+        cumul += histogram[i];
+        this->_array[i] = total > 0. ? cumul / total : 0.;
     }
 }
@@ -23,11 +23,22 @@
 #include <vector>
 #include <string>
 #include <limits>
+#include <iterator>
+#include <cstddef>
+#include <algorithm>
+#include <utility>
 
 #include "mystdint.h"
 
 #include "Rectangle.h"
+#include "Layout.h"
 #include "Histogram.h"
+#include "ImageStatistics.h"
+#include "ImageBufferPool.h"
+
+#if __cplusplus > 199711L || defined(__GXX_EXPERIMENTAL_CXX0X__)
+#define IMAGEIN_HAS_RVALUE_REFERENCES
+#endif
 
 namespace imagein
 {
@@ -44,6 +55,26 @@ namespace imagein
      * and you can use whatever numeric type you wish as long as they are basic c++ types (with operator sizeof working).
      * Note that if you use  non-standard types, some algorithms may not work with this type of image.
      *
+     * The values are stored in the Layout given at the construction, planar by default. getPixelAt(), getRow(), getColumn()
+     * and the channel iterators work in both layouts. begin() and end() walk through the values in memory order : code using them
+     * to reach a given pixel should take the layout into account with getChannelStride(), getRowStride() and getPixelStride().
+     *
+     * An image can also be a view of a rectangle of another image (see SubImage_t) : it shares the values of the other image,
+     * and its lines and channels are as far apart as in the other image.
+     *
+     * The buffer of an image which owns its values always starts on a 64 bytes boundary. When asked at the construction, each line is also padded so that it
+     * starts on a 64 bytes boundary, which allows aligned vector loads on every line and keeps the lines of two threads out of
+     * the same cache line. The padding values are part of [begin(), end()) but not of the image : isContiguous() tells whether
+     * there is any. The buffers are taken from ImageBufferPool::instance(), so that creating and destroying temporary images
+     * of the same size repeatedly doesn't allocate memory each time.
+     *
+     * The copy constructor and the affect operator always copy the values. share() makes an image use the buffer of another one instead :
+     * the buffer is reference-counted, and the first access which may modify the values of one of the images (non-const begin(), pixelAt(),
+     * setPixel(), ...) gives it its own copy first. The converters use it to return an image of the same type without copying anything.
+     * Making a view (SubImage_t) of an image gives it its own copy first if its buffer is shared, and a buffer seen by a view is never
+     * shared afterwards, so that writing through a view only changes the image it was made on.
+     * When the compiler supports rvalue references, the images are also movable.
+     *
      * \tparam D the type of pixel values.
      */
     template <typename D>
@@ -83,7 +114,7 @@ namespace imagein
 
             class Row : public Line {
               public:
-                Row(D* ptr, int size) : Line(ptr, 1, size) {}
+                Row(D* ptr, int size, int jmp = 1) : Line(ptr, jmp, size) {}
             };
             class Column : public Line {
               public:
@@ -91,8 +122,152 @@ namespace imagein
             };
             class ConstRow : public ConstLine {
               public:
-                ConstRow(const D* ptr, int size) : ConstLine(ptr, 1, size) {}
+                ConstRow(const D* ptr, int size, int jmp = 1) : ConstLine(ptr, jmp, size) {}
+            };
+
+            /*!
+             * \brief Random access iterator moving by a fixed step in memory.
+             *
+             * It is used to walk through the values of a line of a channel whatever the layout of the image.
+             *
+             * \tparam T D or const D.
+             */
+            template <typename T>
+            class StridedIterator {
+              public:
+                typedef std::random_access_iterator_tag iterator_category;
+                typedef D value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef T* pointer;
+                typedef T& reference;
+
+                StridedIterator() : _ptr(NULL), _stride(1) {}
+                StridedIterator(T* ptr, difference_type stride) : _ptr(ptr), _stride(stride) {}
+                //! Conversion from a line_iterator to a const_line_iterator.
+                template <typename U>
+                StridedIterator(const StridedIterator<U>& other) : _ptr(other.base()), _stride(other.stride()) {}
+
+                inline T* base() const { return _ptr; }
+                inline difference_type stride() const { return _stride; }
+
+                inline reference operator*() const { return *_ptr; }
+                inline pointer operator->() const { return _ptr; }
+                inline reference operator[](difference_type n) const { return _ptr[n * _stride]; }
+
+                inline StridedIterator& operator++() { _ptr += _stride; return *this; }
+                inline StridedIterator& operator--() { _ptr -= _stride; return *this; }
+                inline StridedIterator operator++(int) { StridedIterator it(*this); _ptr += _stride; return it; }
+                inline StridedIterator operator--(int) { StridedIterator it(*this); _ptr -= _stride; return it; }
+                inline StridedIterator& operator+=(difference_type n) { _ptr += n * _stride; return *this; }
+                inline StridedIterator& operator-=(difference_type n) { _ptr -= n * _stride; return *this; }
+                inline StridedIterator operator+(difference_type n) const { return StridedIterator(_ptr + n * _stride, _stride); }
+                inline StridedIterator operator-(difference_type n) const { return StridedIterator(_ptr - n * _stride, _stride); }
+                inline difference_type operator-(const StridedIterator& other) const { return (_ptr - other._ptr) / _stride; }
+
+                inline bool operator==(const StridedIterator& other) const { return _ptr == other._ptr; }
+                inline bool operator!=(const StridedIterator& other) const { return _ptr != other._ptr; }
+                inline bool operator<(const StridedIterator& other) const { return _ptr < other._ptr; }
+                inline bool operator>(const StridedIterator& other) const { return _ptr > other._ptr; }
+                inline bool operator<=(const StridedIterator& other) const { return _ptr <= other._ptr; }
+                inline bool operator>=(const StridedIterator& other) const { return _ptr >= other._ptr; }
+
+              private:
+                T* _ptr;
+                difference_type _stride;
             };
+            typedef StridedIterator<D> line_iterator; //!< Random access iterator on the values of a line of a channel
+            typedef StridedIterator<const D> const_line_iterator; //!< Random access const-iterator on the values of a line of a channel
+
+            /*!
+             * \brief Random access iterator on the values of a channel, in the order of the lines.
+             *
+             * It skips the padding at the end of the lines.
+             *
+             * \tparam T D or const D.
+             */
+            template <typename T>
+            class ChannelIterator {
+              public:
+                typedef std::random_access_iterator_tag iterator_category;
+                typedef D value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef T* pointer;
+                typedef T& reference;
+
+                ChannelIterator() : _row(NULL), _x(0), _width(0), _pixelStride(1), _rowStride(0) {}
+                ChannelIterator(T* row, difference_type x, difference_type width, difference_type pixelStride, difference_type rowStride)
+                    : _row(row), _x(x), _width(width), _pixelStride(pixelStride), _rowStride(rowStride) {}
+                //! Conversion from a channel_iterator to a const_channel_iterator.
+                template <typename U>
+                ChannelIterator(const ChannelIterator<U>& other)
+                    : _row(other.row()), _x(other.x()), _width(other.width()), _pixelStride(other.pixelStride()), _rowStride(other.rowStride()) {}
+
+                inline T* row() const { return _row; }
+                inline difference_type x() const { return _x; }
+                inline difference_type width() const { return _width; }
+                inline difference_type pixelStride() const { return _pixelStride; }
+                inline difference_type rowStride() const { return _rowStride; }
+
+                inline reference operator*() const { return _row[_x * _pixelStride]; }
+                inline pointer operator->() const { return &_row[_x * _pixelStride]; }
+                inline reference operator[](difference_type n) const { return *(*this + n); }
+
+                inline ChannelIterator& operator++() {
+                    if(++_x == _width) {
+                        _x = 0;
+                        _row += _rowStride;
+                    }
+                    return *this;
+                }
+                inline ChannelIterator& operator--() {
+                    if(_x-- == 0) {
+                        _x = _width - 1;
+                        _row -= _rowStride;
+                    }
+                    return *this;
+                }
+                inline ChannelIterator operator++(int) { ChannelIterator it(*this); ++(*this); return it; }
+                inline ChannelIterator operator--(int) { ChannelIterator it(*this); --(*this); return it; }
+                inline ChannelIterator& operator+=(difference_type n) {
+                    if(_width == 0) return *this;
+                    difference_type x = _x + n;
+                    difference_type rows = x / _width;
+                    x %= _width;
+                    if(x < 0) {
+                        x += _width;
+                        --rows;
+                    }
+                    _row += rows * _rowStride;
+                    _x = x;
+                    return *this;
+                }
+                inline ChannelIterator& operator-=(difference_type n) { return *this += -n; }
+                inline ChannelIterator operator+(difference_type n) const { ChannelIterator it(*this); return it += n; }
+                inline ChannelIterator operator-(difference_type n) const { ChannelIterator it(*this); return it += -n; }
+                inline difference_type operator-(const ChannelIterator& other) const {
+                    if(_rowStride == 0) return _x - other._x;
+                    return (_row - other._row) / _rowStride * _width + _x - other._x;
+                }
+
+                inline bool operator==(const ChannelIterator& other) const { return _row == other._row && _x == other._x; }
+                inline bool operator!=(const ChannelIterator& other) const { return !(*this == other); }
+                inline bool operator<(const ChannelIterator& other) const { return _row < other._row || (_row == other._row && _x < other._x); }
+                inline bool operator>(const ChannelIterator& other) const { return other < *this; }
+                inline bool operator<=(const ChannelIterator& other) const { return !(other < *this); }
+                inline bool operator>=(const ChannelIterator& other) const { return !(*this < other); }
+
+              private:
+                T* _row;
+                difference_type _x;
+                difference_type _width;
+                difference_type _pixelStride;
+                difference_type _rowStride;
+            };
+            typedef ChannelIterator<D> channel_iterator; //!< Random access iterator on the values of a channel
+            typedef ChannelIterator<const D> const_channel_iterator; //!< Random access const-iterator on the values of a channel
+
+            enum { ALIGNMENT = 64 }; //!< Alignment in bytes of the buffer, and of the lines when they are padded.
+
             class ConstColumn : public ConstLine {
               public:
                 ConstColumn(const D* ptr, int size, int jmp) : ConstLine(ptr, jmp, size) {}
@@ -107,8 +282,11 @@ namespace imagein
              * \param height The image height
              * \param nChannels The number of channels of the image.
              * \param data The actual data matrix containing the pixels of the image.  No verification of the size of the array is performed.
+             * The lines of data are not padded, even when alignRows is true.
+             * \param layout The layout of the image, and of data.
+             * \param alignRows If true, each line is padded to start on an ALIGNMENT bytes boundary.
              */
-            Image_t(unsigned int width, unsigned int height, unsigned int nChannels, const D* data);
+            Image_t(unsigned int width, unsigned int height, unsigned int nChannels, const D* data, Layout layout, bool alignRows);
             Image_t(unsigned int width, unsigned int height, unsigned int nChannels, D value);
             Image_t(std::vector<const Image_t<D>* >);
 
@@ -120,9 +298,10 @@ namespace imagein
              * If you want to use other file formats, see the class ImageFile and ImageFileFactory for instructions.
              *
              * \param filename The relative or absolute filename to the image file.
+             * \param layout The layout of the image. The files being interleaved, LAYOUT_INTERLEAVED avoids reordering the data.
              * \throw ImageFileException if the file format isn't supported or if there is an error while reading the file.
              */
-            Image_t(std::string filename);
+            Image_t(std::string filename, Layout layout = LAYOUT_PLANAR);
 
             /*!
              * \brief Image destructor.
@@ -139,6 +318,15 @@ namespace imagein
              */
             Image_t(const Image_t<D>& other);
 
+            /*!
+             * \brief Copies an image into another layout.
+             *
+             * \param other The image to be copied.
+             * \param layout The layout of the new image.
+             * \param alignRows If true, each line of the new image is padded to start on an ALIGNMENT bytes boundary.
+             */
+            Image_t(const Image_t<D>& other, Layout layout, bool alignRows = false);
+
             /*!
              * \brief Affect operator.
              *
@@ -147,12 +335,58 @@ namespace imagein
              */
             Image_t<D>& operator=(const Image_t<D>& other);
 
+#ifdef IMAGEIN_HAS_RVALUE_REFERENCES
+            //! Move constructor : takes the buffer of other, which becomes an empty image. The values of a view are copied.
+            Image_t(Image_t<D>&& other);
+            //! Move affect operator : takes the buffer of other, which becomes an empty image. The values of a view are copied.
+            Image_t<D>& operator=(Image_t<D>&& other);
+#endif
+
+            /*!
+             * \brief Makes this image share the buffer of other, without copying the values.
+             *
+             * Each image gets its own copy of the values on the first access which may modify them.
+             * If other is a view, or if a view has been made on it, the values are copied right away.
+             *
+             * \param other The image to be shared.
+             */
+            void share(const Image_t<D>& other);
+            //! Exchanges the dimensions and the values of two images in constant time.
+            void swap(Image_t<D>& other);
+            //! Returns true if the buffer of the image is shared with another image (see share())
+            inline bool isShared() const { return _ownsData && header(_mat)->refs != 1; }
+
             //! Returns the width of the image
             inline unsigned int getWidth() const { return _width; }
             //! Returns the height of the image
             inline unsigned int getHeight() const { return _height; }
             //! Returns the number of channels of the image
             inline unsigned int getNbChannels() const { return _nChannels; }
+            //! Returns the layout of the values of the image in memory
+            inline Layout getLayout() const { return _layout; }
+            //! Returns the distance in memory between two consecutive pixels of a channel
+            inline unsigned int getPixelStride() const { return (_layout == LAYOUT_INTERLEAVED) ? _nChannels : 1; }
+            //! Returns the distance in memory between two consecutive lines of a channel, padding included
+            inline unsigned int getRowStride() const { return _rowStride; }
+            //! Returns the distance in memory between two consecutive channels of a pixel
+            inline unsigned int getChannelStride() const { return _channelStride; }
+            //! Returns true if the lines of the image are padded to start on an ALIGNMENT bytes boundary
+            inline bool hasAlignedRows() const { return _alignedRows; }
+            //! Returns true if there is no gap between the lines and the channels, so that [begin(), end()) holds only the values of the image
+            inline bool isContiguous() const {
+                return _rowStride == _width * getPixelStride() && (_layout == LAYOUT_INTERLEAVED || _nChannels <= 1 || _channelStride == _rowStride * _height);
+            }
+            //! Returns false if the values belong to another image, as for a SubImage_t
+            inline bool ownsData() const { return _ownsData; }
+
+            /*!
+             * \brief Reorders the values of the image in another layout.
+             *
+             * The iterators and pointers to the values of the image are invalidated.
+             *
+             * \param layout The new layout of the image.
+             */
+            void setLayout(Layout layout);
 
             /*!
              * \brief Returns the value of a pixel.
@@ -180,32 +414,37 @@ namespace imagein
 
             inline D getPixelAt(unsigned int x, unsigned int y, unsigned int channel = 0) const
             {
-                return _mat[channel*_width*_height + y*_width + x];
+                return _mat[offset(x, y, channel)];
             }
             inline D& pixelAt(unsigned int x, unsigned int y, unsigned int channel = 0)
             {
-                return _mat[channel*_width*_height + y*_width + x];
+                detach();
+                return _mat[offset(x, y, channel)];
             }
 
             inline void setPixelAt(unsigned int x, unsigned int y, unsigned int channel, D cPixel)
             {
-                _mat[channel*_width*_height + y*_width + x] = cPixel;
+                detach();
+                _mat[offset(x, y, channel)] = cPixel;
             }
             inline void setPixelAt(unsigned int x, unsigned int y, D cPixel)
             {
-                _mat[y*_width + x] = cPixel;
+                detach();
+                _mat[offset(x, y, 0)] = cPixel;
             }
             inline Row getRow(unsigned int j, unsigned int c = 0) {
-                return Row(_mat + c*_width*_height + j*_width, _width);
+                detach();
+                return Row(_mat + offset(0, j, c), _width, getPixelStride());
             }
             inline Line getColumn(unsigned int i, unsigned int c = 0) {
-                return Line(_mat + c*_width*_height + i, _width, _height);
+                detach();
+                return Line(_mat + offset(i, 0, c), getRowStride(), _height);
             }
             inline ConstRow getConstRow(unsigned int j, unsigned int c = 0) const {
-                return ConstRow(_mat + c*_width*_height + j*_width, _width);
+                return ConstRow(_mat + offset(0, j, c), _width, getPixelStride());
             }
             inline ConstLine getConstColumn(unsigned int i, unsigned int c = 0) const {
-                return ConstLine(_mat + c*_width*_height + i, _width, _height);
+                return ConstLine(_mat + offset(i, 0, c), getRowStride(), _height);
             }
 
 //             /*!
@@ -219,14 +458,39 @@ namespace imagein
 //            void setPixel(unsigned int x, unsigned int y, const D* pixel);
 
             //! Returns an iterator to the first channel on the top-left corner of the image
-            inline iterator begin() { return _mat; }
+            inline iterator begin() { detach(); return _mat; }
             //! Returns a const iterator to the first channel on the top-left corner of the image
             inline const_iterator begin() const { return _mat; }
-            //! Returns an iterator past then end of the image
-            inline iterator end() { return _mat + size(); }
-            //! returns a const iterator past the end of the image
-            inline const_iterator end() const { return _mat + size(); }
+            //! Returns an iterator past then end of the image, padding included
+            inline iterator end() { detach(); return _mat + bufferSize(); }
+            //! returns a const iterator past the end of the image, padding included
+            inline const_iterator end() const { return _mat + bufferSize(); }
+            //! Returns the number of values of the image, padding excluded
             inline unsigned int size() const { return _width*_height*_nChannels; }
+            //! Returns the number of values between begin() and end(), padding included
+            inline unsigned int bufferSize() const {
+                if(_ownsData) return _rowStride * _height * ((_layout == LAYOUT_INTERLEAVED) ? 1 : _nChannels);
+                return (size() == 0) ? 0 : offset(_width - 1, _height - 1, _nChannels - 1) + 1;
+            }
+
+            //! Returns an iterator to the values of a channel, in the order of the lines.
+            inline channel_iterator channelBegin(unsigned int c) {
+                detach();
+                return channel_iterator(_mat + c * getChannelStride(), 0, _width, getPixelStride(), _rowStride);
+            }
+            //! Returns a const iterator to the values of a channel, in the order of the lines.
+            inline const_channel_iterator channelBegin(unsigned int c) const {
+                return const_channel_iterator(_mat + c * getChannelStride(), 0, _width, getPixelStride(), _rowStride);
+            }
+            //! Returns an iterator past the end of a channel
+            inline channel_iterator channelEnd(unsigned int c) {
+                detach();
+                return channel_iterator(_mat + c * getChannelStride() + _height * _rowStride, 0, _width, getPixelStride(), _rowStride);
+            }
+            //! Returns a const iterator past the end of a channel
+            inline const_channel_iterator channelEnd(unsigned int c) const {
+                return const_channel_iterator(_mat + c * getChannelStride() + _height * _rowStride, 0, _width, getPixelStride(), _rowStride);
+            }
             bool operator==(const imagein::Image_t<D>& img) const;
 
             inline Image_t<D>* operator-(const Image_t<D>& img) const {
@@ -261,6 +525,35 @@ namespace imagein
              */
             inline Histogram getHistogram(unsigned int channel=0, const Rectangle& rect = Rectangle()) const { return Histogram(*this, channel, rect); }
 
+            /*!
+             * \brief Returns the histogram of the image, covering the values of the image with a given number of bins.
+             *
+             * \param channel The channel to take into account for the histogram.
+             * \param nbBins The maximum number of bins.
+             * \param rect The image area on which to calculate the Histogram.
+             */
+            inline Histogram getHistogram(unsigned int channel, unsigned int nbBins, const Rectangle& rect = Rectangle()) const { return Histogram(*this, channel, nbBins, rect); }
+
+            /*!
+             * \brief Returns the histogram of the values of the image in a given range.
+             *
+             * \param channel The channel to take into account for the histogram.
+             * \param min The start of the range.
+             * \param max The end of the range, counted in the last bin.
+             * \param nbBins The number of bins.
+             * \param rect The image area on which to calculate the Histogram.
+             */
+            inline Histogram getHistogram(unsigned int channel, double min, double max, unsigned int nbBins, const Rectangle& rect = Rectangle()) const {
+                return Histogram(*this, channel, min, max, nbBins, rect);
+            }
+
+            /*!
+             * \brief Returns the extrema, sums and number of values of each channel, computed in a single pass.
+             *
+             * \param rect The image area on which to calculate the statistics.
+             */
+            inline ImageStatistics getStatistics(const Rectangle& rect = Rectangle()) const { return ImageStatistics(*this, rect); }
+
 
             /*!
              * \brief Crops the image to the boundaries defined by a Rectangle.
@@ -270,25 +563,68 @@ namespace imagein
              */
             virtual Image_t<D>* crop(const Rectangle& rect) const;
 
+            //Each of these methods computes the statistics of the whole image, use getStatistics() to get several of them.
             depth_t min(unsigned int channel) const;
             depth_t max(unsigned int channel) const;
             double mean(unsigned int channel) const;
             double deviation(unsigned int channel, double mean) const;
-            inline double deviation(unsigned int channel) const { return deviation(channel, mean()); }
+            inline double deviation(unsigned int channel) const { return getStatistics()[channel].deviation(); }
             depth_t min() const;
             depth_t max() const;
             double mean() const;
             double deviation(double mean) const;
-            double deviation() const { return deviation(mean()); }
+            double deviation() const { return getStatistics().total().deviation(); }
             void normalize(double min = static_cast<double>(std::numeric_limits<D>::min()),
                            double max = static_cast<double>(std::numeric_limits<D>::max()));
 
         protected:
-            void crop(const Rectangle& rect, D* mat) const;
+            //! Copies a rectangle of the image into dst, which has the dimensions of the rectangle.
+            void crop(const Rectangle& rect, Image_t<D>& dst) const;
+            //! Copies the values of the image into dst, which has the same dimensions, whatever its layout and padding.
+            void copyTo(Image_t<D>& dst) const;
+
+            //! Returns the position in _mat of a value of a pixel.
+            inline unsigned int offset(unsigned int x, unsigned int y, unsigned int channel) const {
+                return channel * getChannelStride() + y * _rowStride + x * getPixelStride();
+            }
+
+            //! Stored just before a buffer allocated by allocate().
+            struct BufferHeader {
+                char* block; //!< The block returned by the ImageBufferPool, which contains the header and the buffer.
+                std::size_t capacity; //!< The size class of the block, to give it back to the pool.
+                volatile int refs; //!< The number of images using the buffer.
+                bool viewed; //!< True once a view has been made on the buffer, which is never shared afterwards.
+            };
+            static inline BufferHeader* header(const D* mat) {
+                return reinterpret_cast<BufferHeader*>(const_cast<D*>(mat)) - 1;
+            }
+
+            //! Computes the strides from the dimensions, the layout and _alignedRows, and allocates _mat accordingly.
+            void allocate();
+            //! Stops using the buffer of the image, and frees it if no other image uses it.
+            void release();
+            //! Gives the image its own copy of its buffer if it is shared, before a modification.
+            inline void detach() {
+                if(_ownsData && header(_mat)->refs != 1) unshare();
+            }
+            void unshare();
+            /*!
+             * \brief Turns the image into a view of a rectangle of img, sharing its values.
+             *
+             * img gets its own copy of its buffer first if it is shared : the values seen by the view are only those of img.
+             *
+             * \throw out_of_range if the rectangle doesn't fit in img.
+             */
+            void makeView(const Image_t<D>& img, const Rectangle& rect);
 
             unsigned int _width;
             unsigned int _height;
             unsigned int _nChannels;
+            Layout _layout;
+            bool _alignedRows;
+            bool _ownsData;
+            unsigned int _rowStride;
+            unsigned int _channelStride;
             D* _mat;
     };
     
@@ -27,20 +27,28 @@
 #include <cmath>
 
 template <typename D>
-imagein::Image_t<D>::Image_t(unsigned int width = 0, unsigned int height = 0, unsigned int nChannels=0, const D* data=NULL)
- : _width(width), _height(height), _nChannels(nChannels)
+imagein::Image_t<D>::Image_t(unsigned int width = 0, unsigned int height = 0, unsigned int nChannels=0, const D* data=NULL, Layout layout=LAYOUT_PLANAR, bool alignRows=false)
+ : _width(width), _height(height), _nChannels(nChannels), _layout(layout), _alignedRows(alignRows)
 {
-    _mat = new D[width * height * nChannels];
+    allocate();
     if(data) {
-        std::copy(data, data+(width * height * nChannels), _mat);
+        //data holds the lines of each plane one after the other, without padding.
+        const unsigned int nRows = (layout == LAYOUT_PLANAR) ? height * nChannels : height;
+        const unsigned int lineSize = width * getPixelStride();
+        for(unsigned int r = 0; r < nRows; ++r) {
+            std::copy(data + r * lineSize, data + (r + 1) * lineSize, _mat + r * _rowStride);
+        }
+    }
+    else if(!isContiguous()) {
+        std::fill(begin(), end(), D());
     }
 }
 
 template <typename D>
 imagein::Image_t<D>::Image_t(unsigned int width, unsigned int height, unsigned int nChannels, D value)
- : _width(width), _height(height), _nChannels(nChannels)
+ : _width(width), _height(height), _nChannels(nChannels), _layout(LAYOUT_PLANAR), _alignedRows(false)
 {
-    _mat = new D[width * height * nChannels];
+    allocate();
     for(iterator it = begin(); it < end(); ++it) {
         *it = value;
     }
@@ -48,7 +56,7 @@ imagein::Image_t<D>::Image_t(unsigned int width, unsigned int height, unsigned i
 
 
 template <typename D>
-imagein::Image_t<D>::Image_t(std::string filename)
+imagein::Image_t<D>::Image_t(std::string filename, Layout layout)
 {
     imagein::ImageFile* im = imagein::ImageFileAbsFactory::getFactory()->getImageFile(filename);
 
@@ -64,17 +72,33 @@ imagein::Image_t<D>::Image_t(std::string filename)
     _width = im->readWidth();
     _height = im->readHeight();
     _nChannels = im->readNbChannels();
-    _mat = reinterpret_cast<D*>(im->readData());
+    _layout = layout;
+    _alignedRows = false;
+    allocate();
+    const D* data = reinterpret_cast<const D*>(im->readData(layout));
+    std::copy(data, data + size(), _mat);
+    delete[] reinterpret_cast<const char*>(data);
 
     delete im;
 }
 
 template <typename D>
 imagein::Image_t<D>::Image_t(const imagein::Image_t<D>& other)
- : _width(other._width), _height(other._height), _nChannels(other._nChannels)
+ : _width(other._width), _height(other._height), _nChannels(other._nChannels), _layout(other._layout), _alignedRows(other._alignedRows)
+{
+    allocate();
+    other.copyTo(*this);
+}
+
+template <typename D>
+imagein::Image_t<D>::Image_t(const imagein::Image_t<D>& other, Layout layout, bool alignRows)
+ : _width(other._width), _height(other._height), _nChannels(other._nChannels), _layout(layout), _alignedRows(alignRows)
 {
-    _mat = new D[_width*_height*_nChannels];
-    std::copy(other.begin(), other.end(), _mat);
+    allocate();
+    if(!isContiguous()) {
+        std::fill(begin(), end(), D());
+    }
+    other.copyTo(*this);
 }
 
 template<typename D>
@@ -82,26 +106,170 @@ imagein::Image_t<D>::Image_t(std::vector<const Image_t<D>*> images) {
     _width = images.size() > 0 ? images[0]->_width : 0;
     _height = images.size() > 0 ? images[0]->_height : 0;
     this->_nChannels = 0;
+    this->_layout = LAYOUT_PLANAR;
+    this->_alignedRows = false;
     for(typename std::vector<const Image_t<D>*>::iterator it = images.begin(); it < images.end(); ++it) {
         this->_nChannels += (*it)->_nChannels;
         if((*it)->_width != _width || (*it)->_height != _height) {
             throw ImageSizeException(__LINE__, __FILE__);
         }
     }
-    std::cout << "_mat = new D[" << _width << "*" << _height << "*" << _nChannels << "];" << std::endl;
-    _mat = new D[_width*_height*_nChannels];
-    int i = 0;
+    allocate();
+    unsigned int channel = 0;
     for(typename std::vector<const Image_t<D>*>::iterator it = images.begin(); it < images.end(); ++it) {
-        std::copy((*it)->begin(), (*it)->end(), &_mat[_width*_height*i]);
-        i += (*it)->_nChannels;
-
+        for(unsigned int c = 0; c < (*it)->_nChannels; ++c) {
+            std::copy((*it)->channelBegin(c), (*it)->channelEnd(c), channelBegin(channel++));
+        }
     }
 }
 
 template <typename D>
 imagein::Image_t<D>::~Image_t()
 {
-    delete[] _mat;
+    release();
+}
+
+template <typename D>
+void imagein::Image_t<D>::allocate()
+{
+    _rowStride = _width * getPixelStride();
+    if(_alignedRows) {
+        //Rounds the lines up to a multiple of ALIGNMENT bytes.
+        const unsigned int alignment = static_cast<unsigned int>(ALIGNMENT);
+        const unsigned int step = (alignment % sizeof(D) == 0) ? alignment / sizeof(D) : alignment;
+        _rowStride = (_rowStride + step - 1) / step * step;
+    }
+    _channelStride = (_layout == LAYOUT_INTERLEAVED) ? 1 : _rowStride * _height;
+    _ownsData = true;
+    //The header, with the address of the block given by the pool, is stored just before the aligned buffer.
+    const std::size_t bytes = bufferSize() * sizeof(D) + ALIGNMENT + sizeof(BufferHeader);
+    std::size_t capacity;
+    char* block = ImageBufferPool::instance().acquire(bytes, capacity);
+    uintptr_t address = reinterpret_cast<uintptr_t>(block + sizeof(BufferHeader));
+    address = (address + ALIGNMENT - 1) & ~static_cast<uintptr_t>(ALIGNMENT - 1);
+    _mat = reinterpret_cast<D*>(address);
+    header(_mat)->block = block;
+    header(_mat)->capacity = capacity;
+    header(_mat)->refs = 1;
+    header(_mat)->viewed = false;
+}
+
+template <typename D>
+void imagein::Image_t<D>::release()
+{
+    if(!_ownsData || _mat == NULL) return;
+    BufferHeader* head = header(_mat);
+#ifdef __GNUC__
+    const int refs = __sync_sub_and_fetch(&head->refs, 1);
+#else
+    const int refs = --head->refs;
+#endif
+    if(refs == 0) ImageBufferPool::instance().release(head->block, head->capacity);
+    _mat = NULL;
+    _ownsData = false;
+}
+
+template <typename D>
+void imagein::Image_t<D>::unshare()
+{
+    Image_t<D> copy(*this);
+    swap(copy);
+}
+
+template <typename D>
+void imagein::Image_t<D>::share(const Image_t<D>& other)
+{
+    if(this == &other) return;
+    if(!other._ownsData || header(other._mat)->viewed) {
+        //A view doesn't own its buffer, and the writes through the views of a buffer must not reach another image.
+        *this = other;
+        return;
+    }
+#ifdef __GNUC__
+    __sync_add_and_fetch(&header(other._mat)->refs, 1);
+#else
+    ++header(other._mat)->refs;
+#endif
+    release();
+    _width = other._width;
+    _height = other._height;
+    _nChannels = other._nChannels;
+    _layout = other._layout;
+    _alignedRows = other._alignedRows;
+    _ownsData = true;
+    _rowStride = other._rowStride;
+    _channelStride = other._channelStride;
+    _mat = other._mat;
+}
+
+template <typename D>
+void imagein::Image_t<D>::swap(Image_t<D>& other)
+{
+    std::swap(_width, other._width);
+    std::swap(_height, other._height);
+    std::swap(_nChannels, other._nChannels);
+    std::swap(_layout, other._layout);
+    std::swap(_alignedRows, other._alignedRows);
+    std::swap(_ownsData, other._ownsData);
+    std::swap(_rowStride, other._rowStride);
+    std::swap(_channelStride, other._channelStride);
+    std::swap(_mat, other._mat);
+}
+
+#ifdef IMAGEIN_HAS_RVALUE_REFERENCES
+template <typename D>
+imagein::Image_t<D>::Image_t(Image_t<D>&& other)
+    : _width(0), _height(0), _nChannels(0), _layout(other._layout), _alignedRows(false), _ownsData(false), _rowStride(0), _channelStride(0), _mat(NULL)
+{
+    if(!other._ownsData) {
+        //A view doesn't own its values, they are copied.
+        Image_t<D> copy(other);
+        swap(copy);
+        return;
+    }
+    swap(other);
+}
+
+template <typename D>
+imagein::Image_t<D>& imagein::Image_t<D>::operator=(Image_t<D>&& other)
+{
+    if(this == &other) return *this;
+    if(!other._ownsData) {
+        //A view doesn't own its values, and may be a view of this image.
+        return *this = static_cast<const Image_t<D>&>(other);
+    }
+    release();
+    _width = _height = _nChannels = 0;
+    _rowStride = _channelStride = 0;
+    _alignedRows = false;
+    swap(other);
+    return *this;
+}
+#endif
+
+template <typename D>
+void imagein::Image_t<D>::makeView(const Image_t<D>& img, const Rectangle& rect)
+{
+    if(rect.x + rect.w > img._width || rect.y + rect.h > img._height) {
+        throw std::out_of_range("Invalid rectangle for a view");
+    }
+    //The view writes in the buffer of img, which must be its own.
+    Image_t<D>& source = const_cast<Image_t<D>&>(img);
+    source.detach();
+    if(source._ownsData) {
+        header(source._mat)->viewed = true;
+    }
+    release();
+
+    _width = rect.w;
+    _height = rect.h;
+    _nChannels = img._nChannels;
+    _layout = img._layout;
+    _alignedRows = false;
+    _ownsData = false;
+    _rowStride = img._rowStride;
+    _channelStride = img._channelStride;
+    _mat = const_cast<D*>(img._mat) + img.offset(rect.x, rect.y, 0);
 }
 
 template <typename D>
@@ -109,13 +277,9 @@ imagein::Image_t<D>& imagein::Image_t<D>::operator=(const imagein::Image_t<D>& o
 {
     if (this == &other) return *this; // handle self assignment
 
-    this->_width = other._width;
-    this->_height = other._height;
-    this->_nChannels = other._nChannels;
-
-    delete[] _mat;
-    _mat = new D[_width*_height*_nChannels];
-    std::copy(other.begin(), other.end(), _mat);
+    //other may be a view of this image : the values are copied before the buffer is released.
+    Image_t<D> copy(other);
+    swap(copy);
 
     return *this;
 }
@@ -127,8 +291,7 @@ D imagein::Image_t<D>::getPixel(unsigned int x, unsigned int y, unsigned int cha
         throw std::out_of_range("Invalid coordinates for getPixel");
     }
 	
-//	return _mat[y*_nChannels*_width + x*_nChannels + channel];
-    return _mat[channel*_width*_height + y*_width + x];
+    return _mat[offset(x, y, channel)];
 }
 
 template <typename D>
@@ -138,8 +301,8 @@ void imagein::Image_t<D>::setPixel(unsigned int x, unsigned int y, unsigned int
         throw std::out_of_range("Invalid coordinates for setPixel");
     }
 
-//    _mat[y*_width*_nChannels + x*_nChannels + channel] = cPixel;
-    _mat[channel*_width*_height + y*_width + x] = cPixel;
+    detach();
+    _mat[offset(x, y, channel)] = cPixel;
 }
 
 //template <typename D>
@@ -157,6 +320,12 @@ bool imagein::Image_t<D>::operator==(const imagein::Image_t<D>& img) const {
     if(this->_width != img._width) return false;
     if(this->_height != img._height) return false;
     if(this->_nChannels != img._nChannels) return false;
+    if(this->_layout != img._layout || this->_rowStride != img._rowStride || this->_channelStride != img._channelStride || !this->isContiguous()) {
+        for(unsigned int c = 0; c < _nChannels; ++c) {
+            if(!std::equal(channelBegin(c), channelEnd(c), img.channelBegin(c))) return false;
+        }
+        return true;
+    }
     for(const_iterator it = this->begin(), jt = img.begin(); it < this->end(); ++it, ++jt) {
         if(*it != *jt) return false;
     }
@@ -166,9 +335,15 @@ bool imagein::Image_t<D>::operator==(const imagein::Image_t<D>& img) const {
 template <typename D>
 void imagein::Image_t<D>::save(const std::string& filename) const
 {
+    if(!isContiguous()) {
+        Image_t<D> packed(*this, _layout);
+        packed.save(filename);
+        return;
+    }
+
     imagein::ImageFile* im = imagein::ImageFileAbsFactory::getFactory()->getImageFile(filename);
 
-    im->writeData(reinterpret_cast<const char* const>(_mat), _width, _height, _nChannels, sizeof(D)*8);
+    im->writeData(reinterpret_cast<const char* const>(_mat), _width, _height, _nChannels, sizeof(D)*8, _layout);
 
     delete im;
 }
@@ -176,137 +351,103 @@ void imagein::Image_t<D>::save(const std::string& filename) const
 template <typename D>
 imagein::Image_t<D>* imagein::Image_t<D>::crop(const imagein::Rectangle& rect) const
 {
-    imagein::Image_t<D>* ret = new imagein::Image_t<D>(rect.w, rect.h, this->_nChannels);
+    imagein::Image_t<D>* ret = new imagein::Image_t<D>(rect.w, rect.h, this->_nChannels, NULL, this->_layout, this->_alignedRows);
 
-    crop(rect, ret->_mat);
+    crop(rect, *ret);
 
     return ret;
 }
 
 template <typename D>
-void imagein::Image_t<D>::crop(const imagein::Rectangle& rect, D* mat) const
+void imagein::Image_t<D>::crop(const imagein::Rectangle& rect, Image_t<D>& dst) const
 {
-    D* di = mat; //pointer to the first element of data
-    for(unsigned int nChannel = 0; nChannel < _nChannels; ++nChannel) {
-        const unsigned int channelBegin = nChannel*_width*_height;
-        const unsigned int topLeft = channelBegin + rect.y*_width + rect.x;
-        const unsigned int bottomRight = topLeft + (rect.h-1)*_width + (rect.w-1) + 1;
-
-        imagein::Image_t<D>::const_iterator it = this->begin() + topLeft; //iterator pointing on the top-left corner of the rectangle
-        imagein::Image_t<D>::const_iterator end = this->begin() + bottomRight; //iterator pointing just after the bottom-right corner of the rectangle
-
-
-        unsigned int columnNo = 0;
-
-        while(it < end) {
-            *di = *it;
-            ++di;
-            ++it;
-
-            ++columnNo;
-
-            if(columnNo == rect.w) {
-                it += (_width-rect.w);
-                columnNo = 0;
+    if(dst._layout != _layout) {
+        for(unsigned int c = 0; c < _nChannels; ++c) {
+            for(unsigned int j = 0; j < rect.h; ++j) {
+                const_line_iterator it(_mat + offset(rect.x, rect.y + j, c), getPixelStride());
+                std::copy(it, it + rect.w, line_iterator(dst._mat + dst.offset(0, j, c), dst.getPixelStride()));
             }
         }
+        return;
+    }
+    //The lines of the rectangle in a plane are contiguous, and the interleaved image is a single plane.
+    const unsigned int nPlanes = (_layout == LAYOUT_PLANAR) ? _nChannels : 1;
+    const unsigned int lineSize = rect.w * getPixelStride();
+    for(unsigned int plane = 0; plane < nPlanes; ++plane) {
+        for(unsigned int j = 0; j < rect.h; ++j) {
+            const_iterator it = this->begin() + offset(rect.x, rect.y + j, plane);
+            std::copy(it, it + lineSize, dst.begin() + dst.offset(0, j, plane));
+        }
     }
 }
 
 template <typename D>
-D imagein::Image_t<D>::min(unsigned int channel) const {
-    D min = std::numeric_limits<D>::max();
-    for(unsigned int j = 0; j < getHeight(); ++j) {
-        for(unsigned int i = 0; i < getWidth(); ++i) {
-            const D value = getPixel(i, j, channel);
-            if(value < min) min = value;
-        }
+void imagein::Image_t<D>::copyTo(Image_t<D>& dst) const
+{
+    if(dst._layout == _layout && dst._rowStride == _rowStride && dst._channelStride == _channelStride) {
+        std::copy(begin(), end(), dst._mat);
+        return;
     }
-    return min;
+    crop(Rectangle(0, 0, _width, _height), dst);
+}
+
+template <typename D>
+void imagein::Image_t<D>::setLayout(Layout layout)
+{
+    if(layout == _layout) return;
+    Image_t<D> tmp(*this, layout, _alignedRows);
+    std::swap(_mat, tmp._mat);
+    std::swap(_ownsData, tmp._ownsData);
+    std::swap(_rowStride, tmp._rowStride);
+    std::swap(_channelStride, tmp._channelStride);
+    _layout = layout;
+}
+
+template <typename D>
+D imagein::Image_t<D>::min(unsigned int channel) const {
+    return static_cast<D>(getStatistics()[channel].min);
 }
 
 template <typename D>
 D imagein::Image_t<D>::max(unsigned int channel) const {
-    D max = std::numeric_limits<D>::min();
-    for(unsigned int j = 0; j < getHeight(); ++j) {
-        for(unsigned int i = 0; i < getWidth(); ++i) {
-            const D value = getPixel(i, j, channel);
-            if(value > max) max = value;
-        }
-    }
-    return max;
+    return static_cast<D>(getStatistics()[channel].max);
 }
 
 template <typename D>
 double imagein::Image_t<D>::mean(unsigned int channel) const {
-    double mean = 0;
-    for(unsigned int j = 0; j < getHeight(); ++j) {
-        for(unsigned int i = 0; i < getWidth(); ++i) {
-            mean += getPixel(i, j, channel);
-        }
-    }
-    return (mean / (getWidth()*getHeight()) );
+    return getStatistics()[channel].mean();
 }
 
 template <typename D>
 double imagein::Image_t<D>::deviation(unsigned int channel, double mean) const {
-    double deviation = 0;
-    for(unsigned int j = 0; j < getHeight(); ++j) {
-        for(unsigned int i = 0; i < getWidth(); ++i) {
-            int delta = getPixel(i, j, channel) - mean;
-            deviation += delta*delta;
-        }
-    }
-    return sqrt(deviation / (getWidth()*getHeight()) );
+    return getStatistics()[channel].deviation(mean);
 }
 
 template <typename D>
 D imagein::Image_t<D>::min() const {
-    D min = std::numeric_limits<D>::max();
-    for(unsigned int c = 0; c < getNbChannels(); ++c) {
-        const D value = this->min(c);
-        if(value < min) min = value;
-    }
-    return min;
+    return static_cast<D>(getStatistics().total().min);
 }
 
 template <typename D>
 D imagein::Image_t<D>::max() const {
-    D max = std::numeric_limits<D>::min();
-    for(unsigned int c = 0; c < getNbChannels(); ++c) {
-        const D value = this->max(c);
-        if(value > max) max = value;
-    }
-    return max;
+    return static_cast<D>(getStatistics().total().max);
 }
 
 template <typename D>
 double imagein::Image_t<D>::mean() const {
-    double mean = 0;
-    for(unsigned int c = 0; c < getNbChannels(); ++c) {
-        mean += this->mean(c);
-    }
-    return (mean / getNbChannels());
+    return getStatistics().total().mean();
 }
 
 template <typename D>
 double imagein::Image_t<D>::deviation(double mean) const {
-    double deviation = 0;
-    for(unsigned int c = 0; c < getNbChannels(); ++c) {
-        for(unsigned int j = 0; j < getHeight(); ++j) {
-            for(unsigned int i = 0; i < getWidth(); ++i) {
-                int delta = getPixel(i, j, c) - mean;
-                deviation += delta*delta;
-            }
-        }
-    }
-    return sqrt(deviation / size());
+    return getStatistics().total().deviation(mean);
 }
 
 template<typename D>
 void imagein::Image_t<D>::normalize(double dstMin, double dstMax) {
-   double actualMin = static_cast<double>(this->min());
-   double actualMax = static_cast<double>(this->max());
+   const ChannelStatistics stats = getStatistics().total();
+   double actualMin = stats.min;
+   double actualMax = stats.max;
    double offset = dstMin - actualMin;
    double ratio = (dstMax - dstMin) / (actualMax - actualMin);
    std::cout << actualMax << ":" << actualMin << std::endl;
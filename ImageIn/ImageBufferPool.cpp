@@ -0,0 +1,162 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ImageBufferPool.h"
+
+using namespace imagein;
+
+ImageBufferPool::ImageBufferPool(std::size_t maxCachedBytes) : _maxCachedBytes(maxCachedBytes)
+{
+#ifdef __linux__
+    pthread_mutex_init(&_mutex, NULL);
+#endif
+    _stats.bytesInUse = 0;
+    _stats.bytesCached = 0;
+    resetStatistics();
+}
+
+ImageBufferPool::~ImageBufferPool()
+{
+    clear();
+#ifdef __linux__
+    pthread_mutex_destroy(&_mutex);
+#endif
+}
+
+ImageBufferPool& ImageBufferPool::instance()
+{
+    static ImageBufferPool pool;
+    return pool;
+}
+
+void ImageBufferPool::lock() const
+{
+#ifdef __linux__
+    pthread_mutex_lock(&_mutex);
+#endif
+}
+
+void ImageBufferPool::unlock() const
+{
+#ifdef __linux__
+    pthread_mutex_unlock(&_mutex);
+#endif
+}
+
+std::size_t ImageBufferPool::sizeClass(std::size_t size)
+{
+    const std::size_t minSize = 256;
+    if(size <= minSize) return minSize;
+    //Rounds up to a multiple of a quarter of the greatest power of two not above size.
+    std::size_t power = minSize;
+    while(power <= size / 2) power *= 2;
+    const std::size_t step = power / 4;
+    return (size + step - 1) / step * step;
+}
+
+char* ImageBufferPool::acquire(std::size_t size, std::size_t& capacity)
+{
+    capacity = sizeClass(size);
+    char* block = NULL;
+    lock();
+    ++_stats.acquisitions;
+    _stats.bytesInUse += capacity;
+    if(_stats.bytesInUse > _stats.peakBytesInUse) _stats.peakBytesInUse = _stats.bytesInUse;
+    std::map<std::size_t, std::vector<char*> >::iterator it = _blocks.find(capacity);
+    if(it != _blocks.end() && !it->second.empty()) {
+        block = it->second.back();
+        it->second.pop_back();
+        _stats.bytesCached -= capacity;
+        ++_stats.hits;
+    }
+    unlock();
+    //The allocation is done outside of the lock.
+    return (block != NULL) ? block : new char[capacity];
+}
+
+void ImageBufferPool::release(char* block, std::size_t capacity)
+{
+    if(block == NULL) return;
+    bool kept = false;
+    lock();
+    ++_stats.releases;
+    _stats.bytesInUse -= capacity;
+    if(_stats.bytesCached + capacity <= _maxCachedBytes) {
+        _blocks[capacity].push_back(block);
+        _stats.bytesCached += capacity;
+        kept = true;
+    }
+    unlock();
+    if(!kept) delete[] block;
+}
+
+std::size_t ImageBufferPool::getMaxCachedBytes() const
+{
+    lock();
+    const std::size_t maxCachedBytes = _maxCachedBytes;
+    unlock();
+    return maxCachedBytes;
+}
+
+void ImageBufferPool::setMaxCachedBytes(std::size_t maxCachedBytes)
+{
+    lock();
+    _maxCachedBytes = maxCachedBytes;
+    trim(maxCachedBytes);
+    unlock();
+}
+
+void ImageBufferPool::clear()
+{
+    lock();
+    trim(0);
+    unlock();
+}
+
+void ImageBufferPool::trim(std::size_t maxBytes)
+{
+    while(_stats.bytesCached > maxBytes && !_blocks.empty()) {
+        std::map<std::size_t, std::vector<char*> >::iterator it = _blocks.end();
+        --it;
+        while(!it->second.empty() && _stats.bytesCached > maxBytes) {
+            delete[] it->second.back();
+            it->second.pop_back();
+            _stats.bytesCached -= it->first;
+        }
+        if(it->second.empty()) _blocks.erase(it);
+    }
+}
+
+ImageBufferPool::Statistics ImageBufferPool::getStatistics() const
+{
+    lock();
+    const Statistics stats = _stats;
+    unlock();
+    return stats;
+}
+
+void ImageBufferPool::resetStatistics()
+{
+    lock();
+    _stats.acquisitions = 0;
+    _stats.hits = 0;
+    _stats.releases = 0;
+    _stats.peakBytesInUse = _stats.bytesInUse;
+    unlock();
+}
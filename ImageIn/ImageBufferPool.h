@@ -0,0 +1,128 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef IMAGEBUFFERPOOL_H
+#define IMAGEBUFFERPOOL_H
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+namespace imagein
+{
+    /*!
+     * \brief Cache of memory blocks for the buffers of the images.
+     *
+     * The buffers of the images (see Image_t) are taken from the library-wide pool returned by instance().
+     * When an image is destroyed, its block is kept for a later image instead of being freed, so that the
+     * temporary images of the algorithms (opening, closing, gradient, successive filters...) don't go through
+     * the system allocator at each call.
+     *
+     * The blocks are sorted by size class : a size is rounded up to the next quarter of a power of two,
+     * so that images of nearly the same size share their blocks while wasting at most a quarter of a block.
+     * The pool never keeps more than getMaxCachedBytes() bytes of free blocks; setMaxCachedBytes(0) turns the
+     * caching off. All the methods can be called from several threads at the same time.
+     */
+    class ImageBufferPool
+    {
+        public:
+            //! Counters of the activity of a pool since its creation or the last call to resetStatistics().
+            struct Statistics
+            {
+                unsigned long acquisitions; //!< Number of blocks given by acquire()
+                unsigned long hits; //!< Number of blocks given by acquire() which were taken from the cache
+                unsigned long releases; //!< Number of blocks given back with release()
+                std::size_t bytesInUse; //!< Number of bytes of the blocks given and not yet given back
+                std::size_t peakBytesInUse; //!< Greatest value of bytesInUse
+                std::size_t bytesCached; //!< Number of bytes of the free blocks kept by the pool
+            };
+
+            enum { DEFAULT_MAX_CACHED_BYTES = 64 << 20 }; //!< Default limit of the free blocks kept by a pool, in bytes.
+
+            /*!
+             * \brief Creates an empty pool.
+             *
+             * \param maxCachedBytes The greatest number of bytes of free blocks the pool keeps.
+             */
+            explicit ImageBufferPool(std::size_t maxCachedBytes = DEFAULT_MAX_CACHED_BYTES);
+
+            //! Frees the blocks kept by the pool. The blocks still in use must not be given back to it afterwards.
+            ~ImageBufferPool();
+
+            //! Returns the pool used by the images of the library.
+            static ImageBufferPool& instance();
+
+            /*!
+             * \brief Returns a block of at least size bytes.
+             *
+             * \param size The number of bytes needed.
+             * \param capacity Receives the size class of the block, which must be given back to release().
+             */
+            char* acquire(std::size_t size, std::size_t& capacity);
+
+            /*!
+             * \brief Gives back a block returned by acquire(), which is kept for later or freed.
+             *
+             * \param block The block.
+             * \param capacity The capacity returned by acquire() with the block.
+             */
+            void release(char* block, std::size_t capacity);
+
+            //! Returns the greatest number of bytes of free blocks the pool keeps.
+            std::size_t getMaxCachedBytes() const;
+
+            //! Changes the greatest number of bytes of free blocks the pool keeps, and frees the blocks in excess.
+            void setMaxCachedBytes(std::size_t maxCachedBytes);
+
+            //! Frees all the blocks kept by the pool.
+            void clear();
+
+            //! Returns the counters of the pool.
+            Statistics getStatistics() const;
+
+            //! Resets the counters of the pool, except bytesInUse and bytesCached.
+            void resetStatistics();
+
+            //! Returns the size of the blocks used for size bytes.
+            static std::size_t sizeClass(std::size_t size);
+
+        private:
+            ImageBufferPool(const ImageBufferPool&);
+            ImageBufferPool& operator=(const ImageBufferPool&);
+
+            //! Frees free blocks, the largest first, until there are at most maxBytes bytes of them. The pool must be locked.
+            void trim(std::size_t maxBytes);
+
+            void lock() const;
+            void unlock() const;
+
+            std::map<std::size_t, std::vector<char*> > _blocks;
+            std::size_t _maxCachedBytes;
+            Statistics _stats;
+#ifdef __linux__
+            mutable pthread_mutex_t _mutex;
+#endif
+    };
+}
+
+#endif // IMAGEBUFFERPOOL_H
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ImageFile.h"
+#include "mystdint.h"
+
+#include <cstring>
+
+using namespace imagein;
+
+void* ImageFile::readData(Layout layout)
+{
+    void* data = readData();
+    const unsigned int nChannels = readNbChannels();
+    if(layout == LAYOUT_PLANAR || nChannels == 1) {
+        return data;
+    }
+
+    const unsigned int width = readWidth(), height = readHeight(), bytes = (readDepth() + 7) / 8;
+    uint8_t* result = new uint8_t[width * height * nChannels * bytes];
+    interleave(data, result, width, height, nChannels, bytes);
+    delete[] reinterpret_cast<uint8_t*>(data);
+    return result;
+}
+
+void ImageFile::writeData(const void* const data, unsigned int width, unsigned int height, unsigned int nChannels, unsigned int depth, Layout layout)
+{
+    if(layout == LAYOUT_PLANAR || nChannels == 1) {
+        writeData(data, width, height, nChannels, depth);
+        return;
+    }
+
+    uint8_t* planar = new uint8_t[width * height * nChannels * depth / 8];
+    deinterleave(data, planar, width, height, nChannels, depth / 8);
+    try {
+        writeData(planar, width, height, nChannels, depth);
+    }
+    catch(...) {
+        delete[] planar;
+        throw;
+    }
+    delete[] planar;
+}
+
+void ImageFile::interleave(const void* planar, void* interleaved, unsigned int width, unsigned int height, unsigned int nChannels, unsigned int bytes)
+{
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(planar);
+    uint8_t* dst = reinterpret_cast<uint8_t*>(interleaved);
+    const unsigned int size = width * height;
+    for(unsigned int c = 0; c < nChannels; ++c) {
+        const uint8_t* channel = src + c * size * bytes;
+        if(bytes == 1) {
+            for(unsigned int i = 0; i < size; ++i) {
+                dst[i * nChannels + c] = channel[i];
+            }
+            continue;
+        }
+        for(unsigned int i = 0; i < size; ++i) {
+            std::memcpy(dst + (i * nChannels + c) * bytes, channel + i * bytes, bytes);
+        }
+    }
+}
+
+void ImageFile::deinterleave(const void* interleaved, void* planar, unsigned int width, unsigned int height, unsigned int nChannels, unsigned int bytes)
+{
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(interleaved);
+    uint8_t* dst = reinterpret_cast<uint8_t*>(planar);
+    const unsigned int size = width * height;
+    for(unsigned int c = 0; c < nChannels; ++c) {
+        uint8_t* channel = dst + c * size * bytes;
+        if(bytes == 1) {
+            for(unsigned int i = 0; i < size; ++i) {
+                channel[i] = src[i * nChannels + c];
+            }
+            continue;
+        }
+        for(unsigned int i = 0; i < size; ++i) {
+            std::memcpy(channel + i * bytes, src + (i * nChannels + c) * bytes, bytes);
+        }
+    }
+}
@@ -22,6 +22,7 @@
 
 #include <string>
 #include "ImageFileException.h"
+#include "Layout.h"
 
 namespace imagein
 {
@@ -109,6 +110,17 @@ namespace imagein
              * \return an array of char representing the image data.
              */
             virtual void* readData()=0;
+            /*!
+             * \brief Reads the image data from the file in the given layout.
+             *
+             * The default implementation reorders the data returned by readData(). Formats storing interleaved data should
+             * reimplement it to avoid reordering the data twice.
+             *
+             * \param layout The layout of the returned data.
+             * \throw FileNotFoundException if the file doesn't exist.
+             * \return an array of char representing the image data.
+             */
+            virtual void* readData(Layout layout);
 
             /*!
              * \brief Writes image data into a file.
@@ -120,8 +132,27 @@ namespace imagein
              * \param depth The size (in bits) of the data in each value of a pixel. Must represent an integer number of bytes (8, 16, 24...)
              */
             virtual void writeData(const void* const data, unsigned int width, unsigned int height, unsigned int nChannels, unsigned int depth)=0;
+            /*!
+             * \brief Writes image data given in some layout into a file.
+             *
+             * The default implementation reorders interleaved data before calling writeData(). Formats storing interleaved data should
+             * reimplement it to avoid reordering the data twice.
+             *
+             * \param layout The layout of data.
+             * \sa writeData()
+             */
+            virtual void writeData(const void* const data, unsigned int width, unsigned int height, unsigned int nChannels, unsigned int depth, Layout layout);
 
         protected:
+            /*!
+             * \brief Copies planar data into interleaved data.
+             *
+             * \param bytes The size of a value of a channel, in bytes.
+             */
+            static void interleave(const void* planar, void* interleaved, unsigned int width, unsigned int height, unsigned int nChannels, unsigned int bytes);
+            //! Copies interleaved data into planar data. \sa interleave()
+            static void deinterleave(const void* interleaved, void* planar, unsigned int width, unsigned int height, unsigned int nChannels, unsigned int bytes);
+
             std::string _filename;
     };
 }
@@ -0,0 +1,167 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ImageStatistics.h"
+
+#include "CpuFeatures.h"
+
+#ifdef IMAGEIN_X86_SIMD
+#include <immintrin.h>
+#endif
+
+using namespace imagein;
+
+//! Reduces contiguous 8 bits values : updates the extrema and adds the sums.
+typedef void (*ByteKernel)(const uint8_t* values, unsigned int size, uint8_t& min, uint8_t& max, int64_t& sum, int64_t& sumOfSquares);
+
+static void reduceBytesScalar(const uint8_t* values, unsigned int size, uint8_t& min, uint8_t& max, int64_t& sum, int64_t& sumOfSquares) {
+    uint32_t mn = min, mx = max, s = 0;
+    uint64_t sq = 0;
+    for(unsigned int i = 0; i < size; ++i) {
+        const uint32_t v = values[i];
+        mn = v < mn ? v : mn;
+        mx = v > mx ? v : mx;
+        s += v;
+        sq += v * v;
+    }
+    min = mn;
+    max = mx;
+    sum += s;
+    sumOfSquares += sq;
+}
+
+#ifdef IMAGEIN_X86_SIMD
+//! Number of vectors whose squares can be added in 32 bits lanes without overflow.
+static const unsigned int squareBlock = 4096;
+
+__attribute__((target("sse2")))
+static void reduceBytesSse2(const uint8_t* values, unsigned int size, uint8_t& min, uint8_t& max, int64_t& sum, int64_t& sumOfSquares) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i vmin = _mm_set1_epi8(static_cast<char>(min));
+    __m128i vmax = _mm_set1_epi8(static_cast<char>(max));
+    __m128i vsum = zero, vsq = zero;
+    unsigned int i = 0;
+    while(i + 16 <= size) {
+        __m128i sq32 = zero;
+        for(unsigned int n = 0; n < squareBlock && i + 16 <= size; ++n, i += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+            vmin = _mm_min_epu8(vmin, v);
+            vmax = _mm_max_epu8(vmax, v);
+            vsum = _mm_add_epi64(vsum, _mm_sad_epu8(v, zero));
+            const __m128i lo = _mm_unpacklo_epi8(v, zero);
+            const __m128i hi = _mm_unpackhi_epi8(v, zero);
+            sq32 = _mm_add_epi32(sq32, _mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi)));
+        }
+        vsq = _mm_add_epi64(vsq, _mm_add_epi64(_mm_unpacklo_epi32(sq32, zero), _mm_unpackhi_epi32(sq32, zero)));
+    }
+    uint8_t mins[16], maxs[16];
+    int64_t sums[2], squares[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(mins), vmin);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(maxs), vmax);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(sums), vsum);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(squares), vsq);
+    for(unsigned int l = 0; l < 16; ++l) {
+        if(mins[l] < min) min = mins[l];
+        if(maxs[l] > max) max = maxs[l];
+    }
+    sum += sums[0] + sums[1];
+    sumOfSquares += squares[0] + squares[1];
+    reduceBytesScalar(values + i, size - i, min, max, sum, sumOfSquares);
+}
+
+__attribute__((target("avx2")))
+static void reduceBytesAvx2(const uint8_t* values, unsigned int size, uint8_t& min, uint8_t& max, int64_t& sum, int64_t& sumOfSquares) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i vmin = _mm256_set1_epi8(static_cast<char>(min));
+    __m256i vmax = _mm256_set1_epi8(static_cast<char>(max));
+    __m256i vsum = zero, vsq = zero;
+    unsigned int i = 0;
+    while(i + 32 <= size) {
+        __m256i sq32 = zero;
+        for(unsigned int n = 0; n < squareBlock && i + 32 <= size; ++n, i += 32) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+            vmin = _mm256_min_epu8(vmin, v);
+            vmax = _mm256_max_epu8(vmax, v);
+            vsum = _mm256_add_epi64(vsum, _mm256_sad_epu8(v, zero));
+            const __m256i lo = _mm256_unpacklo_epi8(v, zero);
+            const __m256i hi = _mm256_unpackhi_epi8(v, zero);
+            sq32 = _mm256_add_epi32(sq32, _mm256_add_epi32(_mm256_madd_epi16(lo, lo), _mm256_madd_epi16(hi, hi)));
+        }
+        vsq = _mm256_add_epi64(vsq, _mm256_add_epi64(_mm256_unpacklo_epi32(sq32, zero), _mm256_unpackhi_epi32(sq32, zero)));
+    }
+    uint8_t mins[32], maxs[32];
+    int64_t sums[4], squares[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(mins), vmin);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(maxs), vmax);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(sums), vsum);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(squares), vsq);
+    for(unsigned int l = 0; l < 32; ++l) {
+        if(mins[l] < min) min = mins[l];
+        if(maxs[l] > max) max = maxs[l];
+    }
+    sum += sums[0] + sums[1] + sums[2] + sums[3];
+    sumOfSquares += squares[0] + squares[1] + squares[2] + squares[3];
+    reduceBytesScalar(values + i, size - i, min, max, sum, sumOfSquares);
+}
+#endif
+
+static ByteKernel selectReduceBytes() {
+#ifdef IMAGEIN_X86_SIMD
+    if(CpuFeatures::hasAvx2()) return reduceBytesAvx2;
+    if(CpuFeatures::hasSse2()) return reduceBytesSse2;
+#endif
+    return reduceBytesScalar;
+}
+
+static const ByteKernel reduceBytes = selectReduceBytes();
+
+void ImageStatistics::reduceLine(const uint8_t* it, unsigned int stride, unsigned int width, Accumulator<uint8_t, true>& acc)
+{
+    if(stride != 1) {
+        reduceLine<uint8_t>(it, stride, width, acc);
+        return;
+    }
+    reduceBytes(it, width, acc.min, acc.max, acc.sum, acc.sumOfSquares);
+    acc.count += width;
+}
+
+void ChannelStatistics::merge(const ChannelStatistics& other)
+{
+    if(other.count == 0) return;
+    if(count == 0) {
+        *this = other;
+        return;
+    }
+    const double delta = other.mean() - mean();
+    const double n = static_cast<double>(count), m = static_cast<double>(other.count);
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+    sum += other.sum;
+    sumOfSquaredDeviations += other.sumOfSquaredDeviations + delta * delta * (n * m / (n + m));
+    count += other.count;
+}
+
+ChannelStatistics ImageStatistics::total() const
+{
+    ChannelStatistics total;
+    for(unsigned int c = 0; c < _channels.size(); ++c) {
+        total.merge(_channels[c]);
+    }
+    return total;
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef IMAGESTATISTICS_H
+#define IMAGESTATISTICS_H
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+#include "mystdint.h"
+#include "Accumulators.h"
+#include "Rectangle.h"
+
+namespace imagein
+{
+    template <typename D>
+    class Image_t;
+
+    /*!
+     * \brief Statistics of the values of a channel : extrema, sum, sum of the squared deviations from the mean and number of values.
+     *
+     * The squared deviations are summed around the mean rather than deduced from the sum of the squares, which would cancel out
+     * for values far from zero. Statistics of several areas or channels are merged with the update of Chan et al.
+     */
+    struct ChannelStatistics
+    {
+        double min; //!< Minimum value
+        double max; //!< Maximum value
+        double sum; //!< Sum of the values
+        double sumOfSquaredDeviations; //!< Sum of the squares of the differences between the values and their mean
+        uint64_t count; //!< Number of values
+
+        //! Statistics of no value.
+        ChannelStatistics() : min(0.), max(0.), sum(0.), sumOfSquaredDeviations(0.), count(0) {}
+
+        //! Returns the mean of the values, or 0 if there is no value.
+        inline double mean() const { return count > 0 ? sum / count : 0.; }
+
+        //! Returns the sum of the squares of the values.
+        inline double sumOfSquares() const { return sumOfSquaredDeviations + sum * mean(); }
+
+        //! Returns the variance of the values, or 0 if there is no value.
+        inline double variance() const { return count > 0 ? sumOfSquaredDeviations / count : 0.; }
+
+        //! Returns the standard deviation of the values.
+        inline double deviation() const { return std::sqrt(variance()); }
+
+        /*!
+         * \brief Returns the root mean square of the differences between the values and a given mean.
+         *
+         * \param mean The value the differences are taken from.
+         */
+        inline double deviation(double mean) const {
+            const double offset = this->mean() - mean;
+            return std::sqrt(variance() + (count > 0 ? offset * offset : 0.));
+        }
+
+        /*!
+         * \brief Adds the values of other statistics to these ones.
+         *
+         * \param other The statistics to merge.
+         */
+        void merge(const ChannelStatistics& other);
+    };
+
+    /*!
+     * \brief Statistics of each channel of an image, computed in a single pass.
+     *
+     * All the channels are reduced together : the lines of the image are split in strips between the threads
+     * of the ThreadPool, each strip keeps its own extrema and sums, and the strips are merged at the end.
+     * The lines of 8 bits values are reduced with SSE2 or AVX2 when the processor supports them.
+     *
+     * Use this class (or Image_t::getStatistics()) rather than several calls to Image_t::min(), Image_t::max(),
+     * Image_t::mean() and Image_t::deviation(), which each compute the statistics of the whole image.
+     */
+    class ImageStatistics
+    {
+        public:
+            /*!
+             * \brief Computes the statistics of each channel of an image.
+             *
+             * \param img The image.
+             * \param rect The image area on which to calculate the statistics.
+             * \throw std::out_of_range if the rectangle is not inside the image.
+             */
+            template <typename D>
+            explicit ImageStatistics(const Image_t<D>& img, const Rectangle& rect = Rectangle());
+
+            //! Returns the number of channels.
+            inline unsigned int getNbChannels() const { return _channels.size(); }
+
+            /*!
+             * \brief Returns the statistics of a channel.
+             *
+             * \param channel The channel.
+             * \throw std::out_of_range if the channel does not exist.
+             */
+            inline const ChannelStatistics& operator[](unsigned int channel) const { return _channels.at(channel); }
+
+            //! Returns the statistics of the values of all the channels together.
+            ChannelStatistics total() const;
+
+        private:
+            template <typename D, bool exact = std::numeric_limits<D>::is_integer && sizeof(D) <= 2>
+            struct Accumulator;
+
+            template <typename D>
+            class ReduceTask;
+
+            template <typename D>
+            static void reduceLine(const D* it, unsigned int stride, unsigned int width, Accumulator<D, true>& acc);
+            template <typename D>
+            static void reduceLine(const D* it, unsigned int stride, unsigned int width, Accumulator<D, false>& acc);
+            static void reduceLine(const uint8_t* it, unsigned int stride, unsigned int width, Accumulator<uint8_t, true>& acc);
+
+            std::vector<ChannelStatistics> _channels;
+    };
+}
+
+#include "ImageStatistics.tpp"
+
+#endif // IMAGESTATISTICS_H
@@ -0,0 +1,238 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//#include "ImageStatistics.h"
+#include "Image.h"
+#include "ThreadPool.h"
+
+#include <limits>
+#include <stdexcept>
+
+/*!
+ * \brief Extrema and exact sums of the integer values of at most 16 bits of a channel over a strip of lines.
+ */
+template <typename D>
+struct imagein::ImageStatistics::Accumulator<D, true>
+{
+    typedef typename SumAccumulators<true, true>::sum_t sum_t;
+    typedef typename SumAccumulators<true, true>::square_t square_t;
+
+    Accumulator() : min(std::numeric_limits<D>::max()), max(std::numeric_limits<D>::min()), sum(0), sumOfSquares(0), count(0) {}
+
+    //! Returns the statistics of the values, the squared deviations being computed from the exact sums.
+    ChannelStatistics statistics() const {
+        ChannelStatistics stats;
+        if(count == 0) return stats;
+        //sum * sum / count = sum * q + sum * r / count, with sum = q * count + r
+        const sum_t n = static_cast<sum_t>(count);
+        const sum_t q = sum / n;
+        const sum_t r = sum % n;
+        stats.min = static_cast<double>(min);
+        stats.max = static_cast<double>(max);
+        stats.sum = static_cast<double>(sum);
+        stats.sumOfSquaredDeviations = std::max(0., static_cast<double>(sumOfSquares - sum * q) - static_cast<double>(sum) * r / n);
+        stats.count = count;
+        return stats;
+    }
+
+    D min;
+    D max;
+    sum_t sum;
+    square_t sumOfSquares;
+    uint64_t count;
+};
+
+/*!
+ * \brief Extrema, mean and squared deviations of the other values of a channel over a strip of lines.
+ */
+template <typename D>
+struct imagein::ImageStatistics::Accumulator<D, false>
+{
+    Accumulator()
+     : min(std::numeric_limits<D>::max()),
+       max(std::numeric_limits<D>::is_integer ? std::numeric_limits<D>::min() : -std::numeric_limits<D>::max()) {}
+
+    inline ChannelStatistics statistics() const {
+        ChannelStatistics result = stats;
+        result.min = static_cast<double>(min);
+        result.max = static_cast<double>(max);
+        return result;
+    }
+
+    D min;
+    D max;
+    ChannelStatistics stats;
+};
+
+/*!
+ * \brief Reduces the lines of the strips, line by line so that the channels of an interleaved line are read while it is cached.
+ *
+ * The accumulators are laid out by strip, then by channel.
+ */
+template <typename D>
+class imagein::ImageStatistics::ReduceTask : public imagein::ParallelTask
+{
+    public:
+        ReduceTask(const Image_t<D>& img, unsigned int x, unsigned int width, const std::vector<unsigned int>& rows,
+                   std::vector<Accumulator<D> >& accs)
+         : _img(img), _x(x), _width(width), _rows(rows), _accs(accs) {}
+
+        void run(unsigned int begin, unsigned int end) {
+            const unsigned int nChannels = _img.getNbChannels();
+            for(unsigned int s = begin; s < end; ++s) {
+                const D* line = _img.begin() + _rows[s] * _img.getRowStride() + _x * _img.getPixelStride();
+                for(unsigned int j = _rows[s]; j < _rows[s+1]; ++j, line += _img.getRowStride()) {
+                    for(unsigned int c = 0; c < nChannels; ++c) {
+                        reduceLine(line + c * _img.getChannelStride(), _img.getPixelStride(), _width, _accs[s * nChannels + c]);
+                    }
+                }
+            }
+        }
+
+    private:
+        const Image_t<D>& _img;
+        unsigned int _x;
+        unsigned int _width;
+        const std::vector<unsigned int>& _rows;
+        std::vector<Accumulator<D> >& _accs;
+};
+
+template <typename D>
+void imagein::ImageStatistics::reduceLine(const D* it, unsigned int stride, unsigned int width, Accumulator<D, true>& acc)
+{
+    typedef typename Accumulator<D, true>::sum_t sum_t;
+    typedef typename Accumulator<D, true>::square_t square_t;
+
+    //Four independent lanes, merged at the end of the line.
+    D mins[4] = {acc.min, acc.min, acc.min, acc.min};
+    D maxs[4] = {acc.max, acc.max, acc.max, acc.max};
+    sum_t sums[4] = {0, 0, 0, 0};
+    square_t squares[4] = {0, 0, 0, 0};
+    unsigned int i = 0;
+    for(; i + 4 <= width; i += 4, it += 4 * stride) {
+        for(unsigned int l = 0; l < 4; ++l) {
+            const D v = it[l * stride];
+            mins[l] = v < mins[l] ? v : mins[l];
+            maxs[l] = v > maxs[l] ? v : maxs[l];
+            sums[l] += v;
+            squares[l] += static_cast<square_t>(v) * v;
+        }
+    }
+    for(; i < width; ++i, it += stride) {
+        const D v = *it;
+        mins[0] = v < mins[0] ? v : mins[0];
+        maxs[0] = v > maxs[0] ? v : maxs[0];
+        sums[0] += v;
+        squares[0] += static_cast<square_t>(v) * v;
+    }
+    for(unsigned int l = 0; l < 4; ++l) {
+        if(mins[l] < acc.min) acc.min = mins[l];
+        if(maxs[l] > acc.max) acc.max = maxs[l];
+        acc.sum += sums[l];
+        acc.sumOfSquares += squares[l];
+    }
+    acc.count += width;
+}
+
+template <typename D>
+void imagein::ImageStatistics::reduceLine(const D* it, unsigned int stride, unsigned int width, Accumulator<D, false>& acc)
+{
+    if(width == 0) return;
+
+    //The values are summed relative to the first one of the line, so that the squares don't cancel out
+    //when the values are far from zero. The line is then merged into the strip.
+    const double shift = static_cast<double>(*it);
+    D mins[4] = {acc.min, acc.min, acc.min, acc.min};
+    D maxs[4] = {acc.max, acc.max, acc.max, acc.max};
+    double sums[4] = {0., 0., 0., 0.};
+    double squares[4] = {0., 0., 0., 0.};
+    unsigned int i = 0;
+    for(; i + 4 <= width; i += 4, it += 4 * stride) {
+        for(unsigned int l = 0; l < 4; ++l) {
+            const D v = it[l * stride];
+            mins[l] = v < mins[l] ? v : mins[l];
+            maxs[l] = v > maxs[l] ? v : maxs[l];
+            const double d = static_cast<double>(v) - shift;
+            sums[l] += d;
+            squares[l] += d * d;
+        }
+    }
+    for(; i < width; ++i, it += stride) {
+        const D v = *it;
+        mins[0] = v < mins[0] ? v : mins[0];
+        maxs[0] = v > maxs[0] ? v : maxs[0];
+        const double d = static_cast<double>(v) - shift;
+        sums[0] += d;
+        squares[0] += d * d;
+    }
+    double sum = 0., squareSum = 0.;
+    for(unsigned int l = 0; l < 4; ++l) {
+        if(mins[l] < acc.min) acc.min = mins[l];
+        if(maxs[l] > acc.max) acc.max = maxs[l];
+        sum += sums[l];
+        squareSum += squares[l];
+    }
+
+    ChannelStatistics line;
+    line.sum = shift * width + sum;
+    line.sumOfSquaredDeviations = std::max(0., squareSum - sum * sum / width);
+    line.count = width;
+    acc.stats.merge(line);
+}
+
+template <typename D>
+imagein::ImageStatistics::ImageStatistics(const imagein::Image_t<D>& img, const imagein::Rectangle& rect)
+ : _channels(img.getNbChannels())
+{
+    unsigned int maxw = rect.w > 0 ? rect.x+rect.w : img.getWidth();
+    unsigned int maxh = rect.h > 0 ? rect.y+rect.h : img.getHeight();
+    if(maxw > img.getWidth() || maxh > img.getHeight()) {
+        throw std::out_of_range("Invalid rectangle for the statistics");
+    }
+    const unsigned int width = maxw > rect.x ? maxw - rect.x : 0;
+    const unsigned int height = maxh > rect.y ? maxh - rect.y : 0;
+    const unsigned int nChannels = img.getNbChannels();
+    if(width == 0 || height == 0 || nChannels == 0) {
+        return;
+    }
+
+    //Each strip must reduce enough values to be worth a task.
+    const unsigned long minStripValues = 1ul << 16;
+    unsigned long nStrips = (static_cast<unsigned long>(width) * height * nChannels) / minStripValues;
+    nStrips = std::max(1ul, std::min(nStrips, static_cast<unsigned long>(ThreadPool::instance().getNbThreads())));
+    std::vector<unsigned int> rows(nStrips + 1);
+    for(unsigned int s = 0; s <= nStrips; ++s) {
+        rows[s] = rect.y + (s * height) / nStrips;
+    }
+
+    std::vector<Accumulator<D> > accs(nStrips * nChannels);
+    ReduceTask<D> task(img, rect.x, width, rows, accs);
+    if(nStrips > 1) {
+        ThreadPool::instance().parallelFor(task, 0, nStrips, 1);
+    }
+    else {
+        task.run(0, 1);
+    }
+
+    for(unsigned int s = 0; s < nStrips; ++s) {
+        for(unsigned int c = 0; c < nChannels; ++c) {
+            _channels[c].merge(accs[s * nChannels + c].statistics());
+        }
+    }
+}
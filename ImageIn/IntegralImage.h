@@ -0,0 +1,140 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INTEGRALIMAGE_H
+#define INTEGRALIMAGE_H
+
+#include <vector>
+#include <limits>
+
+#include "mystdint.h"
+#include "Accumulators.h"
+#include "Image.h"
+#include "Rectangle.h"
+#include "ThreadPool.h"
+
+namespace imagein
+{
+    /*!
+     * \brief Integral image (summed-area table) of a channel of an image, and of the squares of its values.
+     *
+     * The element (x, y) of the table is the sum of the values of the pixels [0, x[ x [0, y[, so that the sum over any
+     * rectangle, and the mean and the variance deduced from it, are given by four elements of the table whatever the size of
+     * the rectangle. This is the basis of box filters and of local statistics over windows of any size.
+     *
+     * The table is built in two passes split between the threads of the ThreadPool : the sums along the lines, in parallel
+     * over the lines, then the sums along the columns, in parallel over blocks of columns.
+     *
+     * \tparam D the depth of the image
+     */
+    template <typename D>
+    class IntegralImage_t
+    {
+        public:
+            typedef typename SumAccumulators<std::numeric_limits<D>::is_integer, sizeof(D) <= 2>::sum_t sum_t; //!< Type of the sums of values
+            typedef typename SumAccumulators<std::numeric_limits<D>::is_integer, sizeof(D) <= 2>::square_t square_t; //!< Type of the sums of squares
+
+            /*!
+             * \brief Builds the integral image of a channel of an image.
+             *
+             * \param img The image.
+             * \param channel The channel to sum.
+             * \param withSquares If false, only the values are summed and sumOfSquares(), variance() and deviation() must not be called.
+             * \throw out_of_range if the channel is not in the image.
+             */
+            IntegralImage_t(const Image_t<D>& img, unsigned int channel = 0, bool withSquares = true);
+
+            //! Returns the width of the image.
+            inline unsigned int getWidth() const { return _width; }
+            //! Returns the height of the image.
+            inline unsigned int getHeight() const { return _height; }
+            //! Returns true if the squares of the values are summed too.
+            inline bool hasSquares() const { return !_squares.empty(); }
+
+            /*!
+             * \brief Returns the sum of the values of the pixels [x0, x1[ x [y0, y1[, without checking the coordinates.
+             *
+             * \param x0 The first column, at most x1.
+             * \param y0 The first line, at most y1.
+             * \param x1 The column after the last one, at most getWidth().
+             * \param y1 The line after the last one, at most getHeight().
+             */
+            inline sum_t sum(unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1) const {
+                return boxSum(_sums, x0, y0, x1, y1);
+            }
+
+            /*!
+             * \brief Returns the line y of the table of sums, of getWidth()+1 elements.
+             *
+             * The element x of the line is the sum of the values of the pixels [0, x[ x [0, y[, so that loops over many
+             * rectangles can read the table directly.
+             */
+            inline const sum_t* getSumsLine(unsigned int y) const { return &_sums[y * static_cast<std::size_t>(_width + 1)]; }
+
+            //! Returns the sum of the squares of the values of the pixels [x0, x1[ x [y0, y1[, without checking the coordinates.
+            inline square_t sumOfSquares(unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1) const {
+                return boxSum(_squares, x0, y0, x1, y1);
+            }
+
+            /*!
+             * \brief Returns the sum of the values of the pixels in a rectangle.
+             *
+             * As for Histogram, a rectangle of width (or height) 0 extends to the right (or bottom) of the image.
+             * The rectangle is clipped to the image.
+             */
+            sum_t sum(const Rectangle& rect) const;
+
+            //! Returns the sum of the squares of the values of the pixels in a rectangle, clipped to the image.
+            square_t sumOfSquares(const Rectangle& rect) const;
+
+            //! Returns the mean of the values of the pixels in a rectangle, clipped to the image, or 0 if it is empty.
+            double mean(const Rectangle& rect) const;
+
+            //! Returns the variance of the values of the pixels in a rectangle, clipped to the image, or 0 if it is empty.
+            double variance(const Rectangle& rect) const;
+
+            //! Returns the standard deviation of the values of the pixels in a rectangle, clipped to the image, or 0 if it is empty.
+            double deviation(const Rectangle& rect) const;
+
+        private:
+            template <typename T>
+            class BuildTask;
+
+            //! Sum over [x0, x1[ x [y0, y1[ given by a table.
+            template <typename T>
+            inline T boxSum(const std::vector<T>& table, unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1) const {
+                const std::size_t stride = _width + 1;
+                return table[y1 * stride + x1] - table[y1 * stride + x0] - table[y0 * stride + x1] + table[y0 * stride + x0];
+            }
+
+            //! Clips a rectangle to the image.
+            void clip(const Rectangle& rect, unsigned int& x0, unsigned int& y0, unsigned int& x1, unsigned int& y1) const;
+
+            unsigned int _width;
+            unsigned int _height;
+            std::vector<sum_t> _sums; //!< (width+1) x (height+1) table, the first line and column being 0.
+            std::vector<square_t> _squares;
+    };
+
+    typedef IntegralImage_t<depth_default_t> IntegralImage; //!< Integral image of a standard Image.
+}
+
+#include "IntegralImage.tpp"
+
+#endif // INTEGRALIMAGE_H
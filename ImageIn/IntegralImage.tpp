@@ -0,0 +1,153 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//#include "IntegralImage.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+
+/*!
+ * \brief Builds a table of sums, the values being given by a function object.
+ *
+ * The lines pass computes the sums along the lines [begin, end[, the columns pass adds each line
+ * to the next one for the columns [begin, end[.
+ */
+template <typename D>
+template <typename T>
+class imagein::IntegralImage_t<D>::BuildTask : public imagein::ParallelTask
+{
+    public:
+        BuildTask(const Image_t<D>& img, unsigned int channel, bool squares, std::vector<T>& table)
+         : _img(img), _channel(channel), _squares(squares), _table(table), _columns(false) {}
+
+        //! Switches to the columns pass.
+        inline void setColumnsPass() { _columns = true; }
+
+        void run(unsigned int begin, unsigned int end) {
+            const unsigned int width = _img.getWidth();
+            const std::size_t stride = width + 1;
+            if(_columns) {
+                for(unsigned int j = 1; j <= _img.getHeight(); ++j) {
+                    const T* above = &_table[(j - 1) * stride];
+                    T* line = &_table[j * stride];
+                    for(unsigned int i = begin; i < end; ++i) {
+                        line[i] += above[i];
+                    }
+                }
+                return;
+            }
+            const unsigned int pixelStride = _img.getPixelStride();
+            for(unsigned int j = begin; j < end; ++j) {
+                const D* it = _img.begin() + _channel * _img.getChannelStride() + j * _img.getRowStride();
+                T* line = &_table[(j + 1) * stride];
+                T run = 0;
+                line[0] = 0;
+                for(unsigned int i = 0; i < width; ++i, it += pixelStride) {
+                    const T value = static_cast<T>(*it);
+                    run += _squares ? value * value : value;
+                    line[i + 1] = run;
+                }
+            }
+        }
+
+    private:
+        const Image_t<D>& _img;
+        unsigned int _channel;
+        bool _squares;
+        std::vector<T>& _table;
+        bool _columns;
+};
+
+template <typename D>
+imagein::IntegralImage_t<D>::IntegralImage_t(const Image_t<D>& img, unsigned int channel, bool withSquares)
+ : _width(img.getWidth()), _height(img.getHeight()),
+   _sums(static_cast<std::size_t>(img.getWidth() + 1) * (img.getHeight() + 1), 0)
+{
+    if(channel >= img.getNbChannels()) {
+        throw std::out_of_range("Invalid channel for the integral image");
+    }
+    ThreadPool& pool = ThreadPool::instance();
+    //The blocks of columns span several cache lines, so that the threads don't write to the same ones.
+    const unsigned int columnsGrain = std::max(64u, _width / (4 * pool.getNbThreads()));
+    BuildTask<sum_t> sums(img, channel, false, _sums);
+    pool.parallelFor(sums, 0, _height);
+    sums.setColumnsPass();
+    pool.parallelFor(sums, 1, _width + 1, columnsGrain);
+    if(withSquares) {
+        _squares.assign(_sums.size(), 0);
+        BuildTask<square_t> squares(img, channel, true, _squares);
+        pool.parallelFor(squares, 0, _height);
+        squares.setColumnsPass();
+        pool.parallelFor(squares, 1, _width + 1, columnsGrain);
+    }
+}
+
+template <typename D>
+void imagein::IntegralImage_t<D>::clip(const Rectangle& rect, unsigned int& x0, unsigned int& y0, unsigned int& x1, unsigned int& y1) const
+{
+    x0 = std::min(rect.x, _width);
+    y0 = std::min(rect.y, _height);
+    x1 = rect.w > 0 ? std::min(rect.x + rect.w, _width) : _width;
+    y1 = rect.h > 0 ? std::min(rect.y + rect.h, _height) : _height;
+    x1 = std::max(x0, x1);
+    y1 = std::max(y0, y1);
+}
+
+template <typename D>
+typename imagein::IntegralImage_t<D>::sum_t imagein::IntegralImage_t<D>::sum(const Rectangle& rect) const
+{
+    unsigned int x0, y0, x1, y1;
+    clip(rect, x0, y0, x1, y1);
+    return sum(x0, y0, x1, y1);
+}
+
+template <typename D>
+typename imagein::IntegralImage_t<D>::square_t imagein::IntegralImage_t<D>::sumOfSquares(const Rectangle& rect) const
+{
+    unsigned int x0, y0, x1, y1;
+    clip(rect, x0, y0, x1, y1);
+    return sumOfSquares(x0, y0, x1, y1);
+}
+
+template <typename D>
+double imagein::IntegralImage_t<D>::mean(const Rectangle& rect) const
+{
+    unsigned int x0, y0, x1, y1;
+    clip(rect, x0, y0, x1, y1);
+    const double count = static_cast<double>(x1 - x0) * (y1 - y0);
+    return count > 0 ? static_cast<double>(sum(x0, y0, x1, y1)) / count : 0.;
+}
+
+template <typename D>
+double imagein::IntegralImage_t<D>::variance(const Rectangle& rect) const
+{
+    unsigned int x0, y0, x1, y1;
+    clip(rect, x0, y0, x1, y1);
+    const double count = static_cast<double>(x1 - x0) * (y1 - y0);
+    if(count == 0) return 0.;
+    const double mean = static_cast<double>(sum(x0, y0, x1, y1)) / count;
+    return std::max(0., static_cast<double>(sumOfSquares(x0, y0, x1, y1)) / count - mean * mean);
+}
+
+template <typename D>
+double imagein::IntegralImage_t<D>::deviation(const Rectangle& rect) const
+{
+    return std::sqrt(variance(rect));
+}
@@ -208,6 +208,10 @@ unsigned int JpgImage::readDepth(){
 }
 
 void* JpgImage::readData(){
+    return readData(LAYOUT_PLANAR);
+}
+
+void* JpgImage::readData(Layout layout){
     struct jpeg_decompress_struct cinfo;
     FILE* fileHandler;
     /* We open the file to give a handler to the JPEG library */
@@ -275,35 +279,30 @@ void* JpgImage::readData(){
      * warnings occurred (test whether jerr.pub.num_warnings is nonzero).
      */
 
-    uint8_t* image = new uint8_t[height*rowSize];
-    for(unsigned int j = 0; j < height; ++j) {
-        for(unsigned int i = 0; i < width; ++i) {
-            for(unsigned int c = 0; c < nChannels; ++c) {
-                image[width*( height*c + j) + i] = data[j*rowSize + i*nChannels + c];
-            }
-        }
+    /* The file is interleaved, so is data. */
+    if(layout == LAYOUT_INTERLEAVED || nChannels == 1) {
+        return data;
     }
+
+    uint8_t* image = new uint8_t[height*rowSize];
+    deinterleave(data, image, width, height, nChannels, sizeof(JSAMPLE));
     delete[] data;
     return image;
+}
 
-    /* And we're done! */
-//    return data;
+void JpgImage::writeData(const void* const data, unsigned int width, unsigned int height, unsigned int nChannels, unsigned int depth){
+    writeData(data, width, height, nChannels, depth, LAYOUT_PLANAR);
 }
 
-void JpgImage::writeData(const void* const data_, unsigned int width, unsigned int height, unsigned int nChannels, unsigned int depth){
-
-    const uint8_t* const image = reinterpret_cast<const uint8_t* const>(data_);
-    uint8_t* data = new uint8_t[width*height*nChannels*depth/8];
-    const unsigned int nDepth = depth/8;
-    for(unsigned int j = 0; j < height; ++j) {
-        for(unsigned int i = 0; i < width; ++i) {
-            for(unsigned int c = 0; c < nChannels; ++c) {
-                for(unsigned int d = 0; d < (depth/8); ++d) {
-                    const uint8_t v = image[nDepth*( width*( height*c + j ) + i ) + d];
-                    data[nDepth*( nChannels*( width*j + i ) + c) + d] = v;
-                }
-            }
-        }
+void JpgImage::writeData(const void* const data_, unsigned int width, unsigned int height, unsigned int nChannels, unsigned int depth, Layout layout){
+
+    //The file is interleaved, planar data is reordered in a buffer.
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(data_);
+    uint8_t* buffer = NULL;
+    if(layout == LAYOUT_PLANAR && nChannels > 1) {
+        buffer = new uint8_t[width*height*nChannels*depth/8];
+        interleave(data, buffer, width, height, nChannels, depth/8);
+        data = buffer;
     }
 
     /* This struct contains the JPEG compression parameters and pointers to
@@ -425,5 +424,5 @@ void JpgImage::writeData(const void* const data_, unsigned int width, unsigned i
     jpeg_destroy_compress(&cinfo);
 
     /* And we're done! */
-    delete[] data;
+    delete[] buffer;
 }
@@ -36,8 +36,10 @@ namespace imagein
             unsigned int readNbChannels();
             unsigned int readDepth();
             void* readData();
+            void* readData(Layout layout);
 
             void writeData(const void* const data, unsigned int width, unsigned int height, unsigned int nChannels, unsigned int depth);
+            void writeData(const void* const data, unsigned int width, unsigned int height, unsigned int nChannels, unsigned int depth, Layout layout);
 
         private:
     };
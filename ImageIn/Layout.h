@@ -0,0 +1,41 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+namespace imagein
+{
+    /*!
+     * \brief Order of the values of an image in memory.
+     *
+     * With LAYOUT_PLANAR, the channels are stored one after the other, each one line by line : the value of the channel c of the pixel (x, y)
+     * is at c*width*height + y*width + x.
+     *
+     * With LAYOUT_INTERLEAVED, the pixels are stored line by line, each one with all its channels : the value of the channel c of the pixel (x, y)
+     * is at (y*width + x)*nChannels + c. This is the order of the image files and of the display, so loading, processing and showing an image in
+     * this layout doesn't reorder its data.
+     */
+    typedef enum {
+        LAYOUT_PLANAR,
+        LAYOUT_INTERLEAVED
+    } Layout;
+}
+
+#endif // LAYOUT_H
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LookupTable.h"
+
+#include <cmath>
+#include <cstring>
+#include "CpuFeatures.h"
+
+#ifdef IMAGEIN_X86_SIMD
+#include <immintrin.h>
+#endif
+
+using namespace imagein;
+
+LookupTable::LookupTable()
+{
+    for(unsigned int v = 0; v < 256; ++v) {
+        _values[v] = static_cast<uint8_t>(v);
+    }
+}
+
+LookupTable::LookupTable(const uint8_t* values)
+{
+    for(unsigned int v = 0; v < 256; ++v) {
+        _values[v] = values[v];
+    }
+}
+
+LookupTable LookupTable::gamma(double gamma)
+{
+    LookupTable table;
+    for(unsigned int v = 0; v < 256; ++v) {
+        table._values[v] = static_cast<uint8_t>(255. * std::pow(v / 255., gamma) + 0.5);
+    }
+    return table;
+}
+
+LookupTable LookupTable::linear(double gain, double offset)
+{
+    LookupTable table;
+    for(unsigned int v = 0; v < 256; ++v) {
+        double value = gain * v + offset + 0.5;
+        if(value < 0.) value = 0.;
+        if(value > 255.) value = 255.;
+        table._values[v] = static_cast<uint8_t>(value);
+    }
+    return table;
+}
+
+LookupTable LookupTable::then(const LookupTable& other) const
+{
+    LookupTable table;
+    for(unsigned int v = 0; v < 256; ++v) {
+        table._values[v] = other._values[_values[v]];
+    }
+    return table;
+}
+
+typedef void (*LookupKernel)(const uint8_t* table, const uint8_t* in, uint8_t* out, std::size_t count);
+
+/*
+ * The values are read and written 8 at a time, which halves the number of memory accesses of a byte by byte loop.
+ * Each byte is put back at the position it was read from, whatever the endianness.
+ */
+static void lookupScalar(const uint8_t* table, const uint8_t* in, uint8_t* out, std::size_t count) {
+    std::size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        uint64_t values;
+        std::memcpy(&values, in + i, 8);
+        uint64_t result = 0;
+        for(unsigned int k = 0; k < 64; k += 8) {
+            result |= static_cast<uint64_t>(table[(values >> k) & 0xFF]) << k;
+        }
+        std::memcpy(out + i, &result, 8);
+    }
+    for(; i < count; ++i) {
+        out[i] = table[in[i]];
+    }
+}
+
+#ifdef IMAGEIN_X86_SIMD
+/*
+ * A byte shuffle looks up 32 values at a time in a table of 16 bytes, so the table is split in 16 parts which are all
+ * looked up with the low 4 bits of the values. The high 4 bits then choose between the 16 results, one bit at a time,
+ * with blends : the blends use the high bit of each byte, so the bits 4, 5 and 6 are shifted there first.
+ * With SSSE3 only (16 values at a time, no blend), this is not faster than lookupScalar.
+ */
+__attribute__((target("avx2")))
+static void lookupAvx2(const uint8_t* table, const uint8_t* in, uint8_t* out, std::size_t count) {
+    __m256i parts[16];
+    for(unsigned int k = 0; k < 16; ++k) {
+        parts[k] = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table + 16 * k)));
+    }
+    const __m256i lowBits = _mm256_set1_epi8(0x0F);
+    std::size_t i = 0;
+    for(; i + 32 <= count; i += 32) {
+        const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        const __m256i index = _mm256_and_si256(values, lowBits);
+        const __m256i bit4 = _mm256_slli_epi16(values, 3);
+        const __m256i bit5 = _mm256_slli_epi16(values, 2);
+        const __m256i bit6 = _mm256_slli_epi16(values, 1);
+        __m256i results[8];
+        for(unsigned int k = 0; k < 8; ++k) {
+            results[k] = _mm256_blendv_epi8(_mm256_shuffle_epi8(parts[2 * k], index), _mm256_shuffle_epi8(parts[2 * k + 1], index), bit4);
+        }
+        for(unsigned int k = 0; k < 4; ++k) {
+            results[k] = _mm256_blendv_epi8(results[2 * k], results[2 * k + 1], bit5);
+        }
+        results[0] = _mm256_blendv_epi8(results[0], results[1], bit6);
+        results[1] = _mm256_blendv_epi8(results[2], results[3], bit6);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_blendv_epi8(results[0], results[1], values));
+    }
+    lookupScalar(table, in + i, out + i, count - i);
+}
+#endif
+
+static LookupKernel selectLookup() {
+#ifdef IMAGEIN_X86_SIMD
+    if(CpuFeatures::hasAvx2()) return lookupAvx2;
+#endif
+    return lookupScalar;
+}
+
+static const LookupKernel lookup = selectLookup();
+
+void LookupTable::apply(const uint8_t* in, uint8_t* out, std::size_t count) const
+{
+    lookup(_values, in, out, count);
+}
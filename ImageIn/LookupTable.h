@@ -0,0 +1,115 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LOOKUPTABLE_H
+#define LOOKUPTABLE_H
+
+#include <cstddef>
+
+#include "mystdint.h"
+#include "Image.h"
+#include "AlgorithmException.h"
+
+namespace imagein
+{
+    /*!
+     * \brief Table of the 256 results of a point operation on 8 bits values.
+     *
+     * On 8 bits images, any operation whose result only depends on the value of the pixel (inversion, bit plane, thresholds,
+     * gamma, contrast...) can be computed once for each of the 256 possible values, and then applied to the image by
+     * looking the values up in the table. PixelAlgorithm_t and Binarization_t do so automatically on 8 bits depths.
+     *
+     * The tables are applied with byte shuffles on processors with AVX2, 32 values at a time.
+     */
+    class LookupTable
+    {
+        public:
+            //! Constructs the identity table.
+            LookupTable();
+
+            /*!
+             * \brief Constructs a table from its values.
+             *
+             * \param values The 256 values of the table.
+             */
+            explicit LookupTable(const uint8_t* values);
+
+            /*!
+             * \brief Constructs the table of a function object, such as a chain of pipeline operations.
+             *
+             * \param f The function object, called once for each value from 0 to 255.
+             */
+            template <class F>
+            static LookupTable fromFunction(const F& f);
+
+            /*!
+             * \brief Constructs the table of a gamma correction : 255 * (v / 255) ^ gamma, rounded.
+             */
+            static LookupTable gamma(double gamma);
+
+            /*!
+             * \brief Constructs the table of a contrast and brightness adjustment : gain * v + offset, rounded and saturated.
+             */
+            static LookupTable linear(double gain, double offset);
+
+            //! Returns the result for a value.
+            inline uint8_t operator[](unsigned int value) const { return _values[value]; }
+            //! Returns a reference to the result for a value.
+            inline uint8_t& operator[](unsigned int value) { return _values[value]; }
+
+            //! Returns the table applying this table, then other.
+            LookupTable then(const LookupTable& other) const;
+
+            /*!
+             * \brief Looks up count values.
+             *
+             * \param in The values to look up.
+             * \param out The results, which can be in.
+             * \param count The number of values.
+             */
+            void apply(const uint8_t* in, uint8_t* out, std::size_t count) const;
+
+            /*!
+             * \brief Looks up the values of an image and writes them to another one.
+             *
+             * dst must have the dimensions, the number of channels and, if there are several channels, the layout of src.
+             * Both can be views or padded.
+             *
+             * \throw ImageTypeException if the depth of one of the images isn't 8 bits.
+             * \throw ImageSizeException if the images don't have the same dimensions.
+             */
+            template <typename S, typename T>
+            void apply(const Image_t<S>& src, Image_t<T>& dst) const;
+
+            /*!
+             * \brief Looks up the values of an image in place.
+             *
+             * \throw ImageTypeException if the depth of the image isn't 8 bits.
+             */
+            template <typename D>
+            void applyInPlace(Image_t<D>& img) const;
+
+        private:
+            uint8_t _values[256];
+    };
+}
+
+#include "LookupTable.tpp"
+
+#endif // LOOKUPTABLE_H
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//#include "LookupTable.h"
+
+template <class F>
+imagein::LookupTable imagein::LookupTable::fromFunction(const F& f)
+{
+    LookupTable table;
+    for(unsigned int v = 0; v < 256; ++v) {
+        table._values[v] = static_cast<uint8_t>(f(static_cast<uint8_t>(v)));
+    }
+    return table;
+}
+
+template <typename S, typename T>
+void imagein::LookupTable::apply(const Image_t<S>& src, Image_t<T>& dst) const
+{
+    if(sizeof(S) != 1 || sizeof(T) != 1) {
+        throw ImageTypeException(__LINE__, __FILE__);
+    }
+    if(src.getWidth() != dst.getWidth() || src.getHeight() != dst.getHeight() || src.getNbChannels() != dst.getNbChannels()
+       || (src.getNbChannels() > 1 && src.getLayout() != dst.getLayout())) {
+        throw ImageSizeException(__LINE__, __FILE__);
+    }
+    //dst first : if it shares its buffer, it gets its own copy before src is read, which also works when src is dst.
+    uint8_t* out = reinterpret_cast<uint8_t*>(dst.begin());
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(src.begin());
+    if(src.isContiguous() && dst.isContiguous()) {
+        apply(in, out, src.size());
+        return;
+    }
+    //The values of a line are contiguous, for one channel or for all of them.
+    const bool interleaved = (src.getLayout() == LAYOUT_INTERLEAVED);
+    const unsigned int nRuns = interleaved ? 1 : src.getNbChannels();
+    const unsigned int length = interleaved ? src.getWidth() * src.getNbChannels() : src.getWidth();
+    for(unsigned int c = 0; c < nRuns; ++c) {
+        for(unsigned int j = 0; j < src.getHeight(); ++j) {
+            apply(in + c * src.getChannelStride() + j * src.getRowStride(),
+                  out + c * dst.getChannelStride() + j * dst.getRowStride(), length);
+        }
+    }
+}
+
+template <typename D>
+void imagein::LookupTable::applyInPlace(Image_t<D>& img) const
+{
+    apply(img, img);
+}
@@ -21,9 +21,11 @@
 #define PIXELALGORITHM_H
 
 #include <vector>
+#include <limits>
 
 #include "Algorithm.h"
 #include "Converter.h"
+#include "LookupTable.h"
 
 namespace imagein
 {
@@ -38,12 +40,48 @@ namespace imagein
      * Unline Algorithm_t the method algorithm is implemented, the user of PixelAlgorithm_t must define another method called pixelOp.
      * The pixelOp method specify the operation to do with the pixels of the input images to obtain the pixel of the output image.
      * The algorithm method go through each pixel of the resulting image and set them using pixelOp.
+     *
+     * The algorithms of arity 1 can also modify an image in place with applyInPlace(), which doesn't create any image.
+     * For them, pixelOp must only depend on its parameter : on 8 bits depths, it is called once per possible value to fill
+     * a LookupTable, which is then applied to the image.
      */
     template <class I, unsigned int A=1>
     class PixelAlgorithm_t : public Algorithm_t<I, A> {
 
         protected:
             typedef typename I::depth_t D;
+
+        public:
+            /*!
+             * \brief Applies the operation to the values of an image, without creating another image.
+             *
+             * Only available for the algorithms of arity 1. The image keeps its type, its layout and its padding,
+             * and a view modifies the values of the image it looks at.
+             *
+             * \param img The image to modify.
+             */
+            void applyInPlace(Image_t<D>& img) const {
+                typedef char arity_must_be_1[(A == 1) ? 1 : -1];
+                (void)sizeof(arity_must_be_1);
+                if(img.isContiguous()) {
+                    D* values = img.begin();
+                    transform(values, values + img.bufferSize(), values);
+                    return;
+                }
+                //The values of a line are contiguous, for one channel or for all of them.
+                const bool interleaved = (img.getLayout() == LAYOUT_INTERLEAVED);
+                const unsigned int nRuns = interleaved ? 1 : img.getNbChannels();
+                const unsigned int length = interleaved ? img.getWidth() * img.getNbChannels() : img.getWidth();
+                D* values = img.begin();
+                for(unsigned int c = 0; c < nRuns; ++c) {
+                    for(unsigned int j = 0; j < img.getHeight(); ++j) {
+                        D* line = values + c * img.getChannelStride() + j * img.getRowStride();
+                        transform(line, line + length, line);
+                    }
+                }
+            }
+
+        protected:
             /*!
              * \brief The operation to apply to the input images' pixels in order to obtain the output image's pixel
              * \param pixels The pixels of the input images.
@@ -59,29 +97,70 @@ namespace imagein
             I* algorithm(const std::vector<const Image_t<D>*>& imgs) {
 
                 for(typename std::vector<const Image_t<D>*>::const_iterator it = imgs.begin(); it < imgs.end(); ++it) {
-                    if((*it)->end()-(*it)->begin()!=imgs[0]->end()-imgs[0]->begin()) {
+                    if((*it)->size()!=imgs[0]->size()) {
                         throw ImageSizeException(__LINE__, __FILE__);
                     }
                 }
 
-                Image_t<D>* result = new Image_t<D>(imgs[0]->getWidth(), imgs[0]->getHeight(), imgs[0]->getNbChannels());
+                //The values are walked through in memory order, so the images must have the same layout and padding.
+                const Layout layout = imgs[0]->getLayout();
+                const bool alignRows = imgs[0]->hasAlignedRows();
+                std::vector<const Image_t<D>*> copies;
+                Image_t<D>* result = new Image_t<D>(imgs[0]->getWidth(), imgs[0]->getHeight(), imgs[0]->getNbChannels(), NULL, layout, alignRows);
                 typename Image_t<D>::const_iterator iIt[A];
-                for(unsigned int i=0; i<A; ++i) iIt[i] = imgs[i]->begin();
+                for(unsigned int i=0; i<A; ++i) {
+                    if(imgs[i]->getLayout() != layout || imgs[i]->getRowStride() != result->getRowStride()
+                       || imgs[i]->getChannelStride() != result->getChannelStride()) {
+                        copies.push_back(new Image_t<D>(*imgs[i], layout, alignRows));
+                        iIt[i] = copies.back()->begin();
+                    }
+                    else {
+                        iIt[i] = imgs[i]->begin();
+                    }
+                }
                 typename I::iterator oIt = result->begin();
                 D pixels[A];
 
-                while(oIt < result->end()) {
+                if(A == 1) {
+                    transform(iIt[0], iIt[0] + result->bufferSize(), oIt);
+                }
+                else while(oIt < result->end()) {
                     for(unsigned int i=0; i<A; ++i) pixels[i] = *iIt[i];
                     *oIt = pixelOp(pixels);
                     ++oIt;
                     for(unsigned int i=0; i<A; ++i) ++iIt[i];
                 }
                 //result->save("tmp.png");
+                for(typename std::vector<const Image_t<D>*>::iterator it = copies.begin(); it < copies.end(); ++it) {
+                    delete *it;
+                }
 
+                //The converter shares the buffer of result when it can, so this doesn't copy the values.
                 I* finalResult = Converter<I>::convert(*result);
+                delete result;
 
                 return finalResult;
             }
+
+        private:
+            //! For an algorithm of arity 1, writes the results of pixelOp on the values of [first, last) to out, which can be first.
+            void transform(const D* first, const D* last, D* out) const {
+                D pixels[A];
+                if(std::numeric_limits<D>::is_integer && sizeof(D) == 1) {
+                    //Only 256 values are possible : pixelOp is called once for each of them.
+                    LookupTable table;
+                    for(unsigned int v = 0; v < 256; ++v) {
+                        pixels[0] = static_cast<D>(v);
+                        table[v] = static_cast<uint8_t>(pixelOp(pixels));
+                    }
+                    table.apply(reinterpret_cast<const uint8_t*>(first), reinterpret_cast<uint8_t*>(out), last - first);
+                    return;
+                }
+                for(; first != last; ++first, ++out) {
+                    pixels[0] = *first;
+                    *out = pixelOp(pixels);
+                }
+            }
     };
 
     //template <typename D, template <typename D> class I, unsigned int A>
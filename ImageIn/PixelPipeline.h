@@ -0,0 +1,216 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXELPIPELINE_H
+#define PIXELPIPELINE_H
+
+#include <limits>
+
+#include "Image.h"
+#include "GrayscaleImage.h"
+#include "AlgorithmException.h"
+#include "ColorSpace.h"
+
+namespace imagein
+{
+    /*!
+     * \brief Operations on the values of an image which are chained at compile time and applied in a single pass.
+     *
+     * Chaining point algorithms such as RgbToGrayscale_t, Inversion, BitPlane and Binarization_t creates an image after each step,
+     * and calls a virtual pixelOp() for each value. The operations of this namespace are small function objects instead :
+     * operator>> chains them into a new function object, in which the compiler can inline all the steps, and apply() runs the
+     * whole chain on each value of the image, creating only the result.
+     *
+     * \code
+     * using namespace imagein::pipeline;
+     * GrayscaleImage* res = apply(rgbImage, Grayscale<depth_default_t>() >> Inversion<depth_default_t>() >> Binarization<depth_default_t>(128));
+     * \endcode
+     *
+     * A ValueOp transforms a value into another one, and is applied to each channel. A ReductionOp makes one value from
+     * the channels of a pixel, and can only start a chain : the result of a chain starting with it is a GrayscaleImage_t.
+     * New operations only need to derive from ValueOp or ReductionOp and to define depth_t and operator().
+     */
+    namespace pipeline
+    {
+        //! Base of the operations on one value. Derived is the operation, which defines D operator()(D value) const.
+        template <class Derived>
+        struct ValueOp
+        {
+            inline const Derived& derived() const { return static_cast<const Derived&>(*this); }
+        };
+
+        //! Base of the operations making a value from the channels of a pixel. Derived is the operation, which defines D operator()(const D* pixel, unsigned int channelStride) const and an enum value nChannels.
+        template <class Derived>
+        struct ReductionOp
+        {
+            inline const Derived& derived() const { return static_cast<const Derived&>(*this); }
+        };
+
+        //! Applies A then B.
+        template <class A, class B>
+        struct ValueChain : public ValueOp<ValueChain<A, B> >
+        {
+            typedef typename A::depth_t depth_t;
+            ValueChain(const A& a, const B& b) : _a(a), _b(b) {}
+            inline depth_t operator()(depth_t value) const { return _b(_a(value)); }
+          private:
+            A _a;
+            B _b;
+        };
+
+        //! Applies the reduction R then the value operation V.
+        template <class R, class V>
+        struct ReductionChain : public ReductionOp<ReductionChain<R, V> >
+        {
+            typedef typename R::depth_t depth_t;
+            enum { nChannels = R::nChannels };
+            ReductionChain(const R& r, const V& v) : _r(r), _v(v) {}
+            inline depth_t operator()(const depth_t* pixel, unsigned int channelStride) const { return _v(_r(pixel, channelStride)); }
+          private:
+            R _r;
+            V _v;
+        };
+
+        template <class A, class B>
+        inline ValueChain<A, B> operator>>(const ValueOp<A>& a, const ValueOp<B>& b) {
+            return ValueChain<A, B>(a.derived(), b.derived());
+        }
+
+        template <class R, class V>
+        inline ReductionChain<R, V> operator>>(const ReductionOp<R>& r, const ValueOp<V>& v) {
+            return ReductionChain<R, V>(r.derived(), v.derived());
+        }
+
+        //! Returns the value unchanged, as algorithm::Identity.
+        template <typename D>
+        struct Identity : public ValueOp<Identity<D> >
+        {
+            typedef D depth_t;
+            inline D operator()(D value) const { return value; }
+        };
+
+        //! Inverts the bits of the value, as algorithm::Inversion.
+        template <typename D>
+        struct Inversion : public ValueOp<Inversion<D> >
+        {
+            typedef D depth_t;
+            inline D operator()(D value) const { return ~value; }
+        };
+
+        //! Keeps the bits of the value which are set in a mask, as algorithm::BitPlane.
+        template <typename D>
+        struct BitPlane : public ValueOp<BitPlane<D> >
+        {
+            typedef D depth_t;
+            explicit BitPlane(D mask) : _mask(mask) {}
+            inline D operator()(D value) const { return value & _mask; }
+          private:
+            D _mask;
+        };
+
+        //! Binarizes the value with one or two thresholds, as algorithm::Binarization_t.
+        template <typename D>
+        struct Binarization : public ValueOp<Binarization<D> >
+        {
+            typedef D depth_t;
+            explicit Binarization(D threshold) : _threshold(threshold), _threshold2(0), _blackBand(false) {}
+            Binarization(D infThreshold, D supThreshold, bool blackBand = false) : _threshold(infThreshold), _threshold2(supThreshold), _blackBand(blackBand) {}
+            inline D operator()(D value) const {
+                if(_threshold2 > _threshold) {
+                    const bool inBand = (_threshold < value && value < _threshold2);
+                    return (inBand == _blackBand) ? std::numeric_limits<D>::max() : 0;
+                }
+                return (value <= _threshold) ? 0 : std::numeric_limits<D>::max();
+            }
+          private:
+            D _threshold;
+            D _threshold2;
+            bool _blackBand;
+        };
+
+        /*!
+         * \brief Weighted sum of the first three channels, as algorithm::RgbToGrayscale_t.
+         *
+         * On 8 bits depths, the result is the same as ColorSpace::rgbToGrayscale() : the weights are rounded to its fixed point
+         * when ColorSpace::toFixedPoint() accepts them, and the sum is rounded down and saturated. The fixed point weights are
+         * kept as doubles, in which the sums of their products with 8 bits values are exact, so both cases use the same code.
+         */
+        template <typename D>
+        struct Grayscale : public ReductionOp<Grayscale<D> >
+        {
+            typedef D depth_t;
+            enum { nChannels = 3 };
+            Grayscale() : _r(0.299), _g(0.587), _b(0.114) { init(); }
+            Grayscale(double redFactor, double greenFactor, double blueFactor) : _r(redFactor), _g(greenFactor), _b(blueFactor) { init(); }
+            inline D operator()(const D* pixel, unsigned int channelStride) const {
+                const double sum = pixel[0] * _r + pixel[channelStride] * _g + pixel[2 * channelStride] * _b;
+                if(!eightBits) return static_cast<D>(sum);
+                return static_cast<D>(sum < 0. ? 0. : (sum > 255. ? 255. : sum));
+            }
+          private:
+            static const bool eightBits = std::numeric_limits<D>::is_integer && !std::numeric_limits<D>::is_signed && std::numeric_limits<D>::digits == 8;
+            void init() {
+                int16_t r, g, b;
+                if(eightBits && ColorSpace::toFixedPoint(_r, r) && ColorSpace::toFixedPoint(_g, g) && ColorSpace::toFixedPoint(_b, b)) {
+                    const double scale = 1 << ColorSpace::fixedPointBits;
+                    _r = r / scale;
+                    _g = g / scale;
+                    _b = b / scale;
+                }
+            }
+            double _r;
+            double _g;
+            double _b;
+        };
+
+        /*!
+         * \brief Applies a chain of value operations to each value of an image.
+         *
+         * \param img The image.
+         * \param op The operation.
+         * \return An image with the dimensions, the layout and the padding of img.
+         */
+        template <typename D, class Op>
+        Image_t<D>* apply(const Image_t<D>& img, const ValueOp<Op>& op);
+
+        /*!
+         * \brief Applies a chain starting with a reduction to each pixel of an image.
+         *
+         * \param img The image.
+         * \param op The operation.
+         * \return A grayscale image with the dimensions and the padding of img.
+         * \throw ImageTypeException if img has less channels than the reduction needs.
+         */
+        template <typename D, class Op>
+        GrayscaleImage_t<D>* apply(const Image_t<D>& img, const ReductionOp<Op>& op);
+
+        /*!
+         * \brief Applies a chain of value operations to each value of an image, without creating another image.
+         *
+         * \param img The image to modify.
+         * \param op The operation.
+         */
+        template <typename D, class Op>
+        void applyInPlace(Image_t<D>& img, const ValueOp<Op>& op);
+    }
+}
+
+#include "PixelPipeline.tpp"
+
+#endif // PIXELPIPELINE_H
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//#include "PixelPipeline.h"
+
+namespace imagein {
+    namespace pipeline {
+        template <typename D, class Op>
+        Image_t<D>* apply(const Image_t<D>& img, const ValueOp<Op>& op)
+        {
+            const Op& f = op.derived();
+            Image_t<D>* result = new Image_t<D>(img.getWidth(), img.getHeight(), img.getNbChannels(), NULL, img.getLayout(), img.hasAlignedRows());
+            //The values of a line are contiguous, for one channel or for all of them.
+            const bool interleaved = (img.getLayout() == LAYOUT_INTERLEAVED);
+            const unsigned int nRuns = interleaved ? 1 : img.getNbChannels();
+            const unsigned int length = interleaved ? img.getWidth() * img.getNbChannels() : img.getWidth();
+            const D* in = img.begin();
+            D* out = result->begin();
+            for(unsigned int c = 0; c < nRuns; ++c) {
+                for(unsigned int j = 0; j < img.getHeight(); ++j) {
+                    const D* src = in + c * img.getChannelStride() + j * img.getRowStride();
+                    D* dst = out + c * result->getChannelStride() + j * result->getRowStride();
+                    for(unsigned int i = 0; i < length; ++i) {
+                        dst[i] = f(src[i]);
+                    }
+                }
+            }
+            return result;
+        }
+
+        template <typename D, class Op>
+        GrayscaleImage_t<D>* apply(const Image_t<D>& img, const ReductionOp<Op>& op)
+        {
+            if(img.getNbChannels() < static_cast<unsigned int>(Op::nChannels)) {
+                throw ImageTypeException(__LINE__, __FILE__);
+            }
+            const Op& f = op.derived();
+            GrayscaleImage_t<D>* result = new GrayscaleImage_t<D>(img.getWidth(), img.getHeight(), NULL, img.hasAlignedRows());
+            const unsigned int pixelStride = img.getPixelStride();
+            const unsigned int channelStride = img.getChannelStride();
+            const D* in = img.begin();
+            D* out = result->begin();
+            for(unsigned int j = 0; j < img.getHeight(); ++j) {
+                const D* src = in + j * img.getRowStride();
+                D* dst = out + j * result->getRowStride();
+                for(unsigned int i = 0; i < img.getWidth(); ++i, src += pixelStride) {
+                    dst[i] = f(src, channelStride);
+                }
+            }
+            return result;
+        }
+
+        template <typename D, class Op>
+        void applyInPlace(Image_t<D>& img, const ValueOp<Op>& op)
+        {
+            const Op& f = op.derived();
+            const bool interleaved = (img.getLayout() == LAYOUT_INTERLEAVED);
+            const unsigned int nRuns = interleaved ? 1 : img.getNbChannels();
+            const unsigned int length = interleaved ? img.getWidth() * img.getNbChannels() : img.getWidth();
+            D* values = img.begin();
+            for(unsigned int c = 0; c < nRuns; ++c) {
+                for(unsigned int j = 0; j < img.getHeight(); ++j) {
+                    D* line = values + c * img.getChannelStride() + j * img.getRowStride();
+                    for(unsigned int i = 0; i < length; ++i) {
+                        line[i] = f(line[i]);
+                    }
+                }
+            }
+        }
+    }
+}
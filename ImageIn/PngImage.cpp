@@ -48,6 +48,11 @@ PngImage::~PngImage()
 }
 
 void* PngImage::readData()
+{
+    return readData(LAYOUT_PLANAR);
+}
+
+void* PngImage::readData(Layout layout)
 {
     if(!_readPngPtr) {
         initRead();
@@ -79,35 +84,31 @@ void* PngImage::readData()
 
     delete[] rowPtrs;
 
-    uint8_t* image = new uint8_t[h*rowSize];
-    for(unsigned int j = 0; j < h; ++j) {
-        for(unsigned int i = 0; i < w; ++i) {
-            for(unsigned int k = 0; k < c; ++k) {
-                image[w*(h*k + j) + i] = data[j*rowSize + i*c + k];
-            }
-        }
+    //The file is interleaved, so is data.
+    if(layout == LAYOUT_INTERLEAVED || c == 1) {
+        return data;
     }
+
+    uint8_t* image = new uint8_t[h*rowSize];
+    deinterleave(data, image, w, h, c, d/8);
     delete[] data;
     return image;
+}
 
-
-//    return data;
+void PngImage::writeData(const void* const data, unsigned int width, unsigned int height, unsigned int nChannels, unsigned int depth)
+{
+    writeData(data, width, height, nChannels, depth, LAYOUT_PLANAR);
 }
 
-void PngImage::writeData(const void* const data_, unsigned int width, unsigned int height, unsigned int nChannels, unsigned int depth)
+void PngImage::writeData(const void* const data_, unsigned int width, unsigned int height, unsigned int nChannels, unsigned int depth, Layout layout)
 {
-    const uint8_t* const image = reinterpret_cast<const uint8_t* const>(data_);
-    uint8_t* data = new uint8_t[width*height*nChannels*depth/8];
-    const unsigned int nDepth = depth/8;
-    for(unsigned int j = 0; j < height; ++j) {
-        for(unsigned int i = 0; i < width; ++i) {
-            for(unsigned int c = 0; c < nChannels; ++c) {
-                for(unsigned int d = 0; d < (depth/8); ++d) {
-                    const uint8_t v = image[nDepth*( width*( height*c + j ) + i ) + d];
-                    data[nDepth*( nChannels*( width*j + i ) + c) + d] = v;
-                }
-            }
-        }
+    //The file is interleaved, planar data is reordered in a buffer.
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(data_);
+    uint8_t* buffer = NULL;
+    if(layout == LAYOUT_PLANAR && nChannels > 1) {
+        buffer = new uint8_t[width*height*nChannels*depth/8];
+        interleave(data, buffer, width, height, nChannels, depth/8);
+        data = buffer;
     }
 
     if(!_writePngPtr) {
@@ -152,7 +153,7 @@ void PngImage::writeData(const void* const data_, unsigned int width, unsigned i
 
     //then the end of the file.
     png_write_end(_writePngPtr, _writeInfoPtr);
-    delete[] data;
+    delete[] buffer;
 }
 
 void PngImage::initRead()
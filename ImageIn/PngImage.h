@@ -43,8 +43,10 @@ namespace imagein
             inline unsigned int readDepth();
 
             void* readData();
+            void* readData(Layout layout);
 
             void writeData(const void* const data, unsigned int width, unsigned int height, unsigned int nChannels, unsigned int depth);
+            void writeData(const void* const data, unsigned int width, unsigned int height, unsigned int nChannels, unsigned int depth, Layout layout);
 
         private:
             png_structp _readPngPtr, _writePngPtr;
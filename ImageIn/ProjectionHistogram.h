@@ -23,6 +23,7 @@
 
 #include "Array.h"
 #include "Image.h"
+#include "SubImage.h"
 #include <iostream>
 
 namespace imagein
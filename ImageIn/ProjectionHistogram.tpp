@@ -26,21 +26,20 @@ imagein::ProjectionHistogram_t<D>::ProjectionHistogram_t(const Image_t<D>& img,
     else _width = rect.w;
     delete [] _array;
     _array = new unsigned int[_width];
-    // We crop the Image to the Rectangle given in parameter
-    Image_t<D>* workImg = img.crop(rect);
+    // We look at the Rectangle given in parameter through a view, without copying it
+    const SubImage_t<Image_t<D> > workImg(img, rect);
     // We prepare to iterate through the Image, we get the max width and height now to avoid to calculate it every iteration
     unsigned int wmax, hmax, iterw, iterh;
-    wmax = workImg->getWidth();
-    hmax = workImg->getHeight();
+    wmax = workImg.getWidth();
+    hmax = workImg.getHeight();
     for(iterw=0;iterw<wmax;iterw++) {
         for(iterh=0;iterh<hmax;iterh++) {
-            if(workImg->getPixel(iterw,iterh,channel)==value) {
+            if(workImg.getPixel(iterw,iterh,channel)==value) {
                 if(horizontal) _array[iterh]++;
                 else _array[iterw]++;
             }
         }
     }
-	delete workImg;
 }
 
 template <typename D>
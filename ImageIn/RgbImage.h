@@ -50,9 +50,12 @@ namespace imagein
              * \param width The image width
              * \param height The image height
              * \param data The actual data matrix containing the pixels of the image.  No verification of the size of the array is performed.
+             * \param layout The layout of the image, and of data.
+             * \param alignRows If true, each line is padded to start on an ALIGNMENT bytes boundary.
 			 *
              */
-            RgbImage_t(unsigned int width=0, unsigned int height=0, const D* data=NULL) : Image_t<D>(width, height, 3, data) {};
+            RgbImage_t(unsigned int width=0, unsigned int height=0, const D* data=NULL, Layout layout=LAYOUT_PLANAR, bool alignRows=false)
+                : Image_t<D>(width, height, 3, data, layout, alignRows) {};
 		
 			/*!
              * \brief Constructs an image from the given file.
@@ -60,10 +63,11 @@ namespace imagein
              * See Image_t constructor for more information.
              *
              * \param filename The relative or absolute filename to the image file.
+             * \param layout The layout of the image.
 			 * \throw ImageFileException if the file format isn't supported or if there is an error while reading the file.
 			 * \throw BadImageException if the file does not contains 3 channels. 
 			 */
-            RgbImage_t(std::string filename);
+            RgbImage_t(std::string filename, Layout layout = LAYOUT_PLANAR);
 		
 			/*!
 			 * \brief Copy constructor.
@@ -71,6 +75,12 @@ namespace imagein
 			 * \param other The Image to be copied.
 			 */
             RgbImage_t(const RgbImage_t<D>& other) : Image_t<D>(other) {};
+
+#ifdef IMAGEIN_HAS_RVALUE_REFERENCES
+            RgbImage_t(RgbImage_t<D>&& other) : Image_t<D>(std::move(other)) {}
+            RgbImage_t<D>& operator=(const RgbImage_t<D>& other) { Image_t<D>::operator=(other); return *this; }
+            RgbImage_t<D>& operator=(RgbImage_t<D>&& other) { Image_t<D>::operator=(std::move(other)); return *this; }
+#endif
 			
 			/*!
              * \brief Crops the image to the boundaries defined by a Rectangle.
@@ -22,8 +22,8 @@
 #include "BadImageException.h"
 
 template <typename D>
-imagein::RgbImage_t<D>::RgbImage_t(std::string filename)
- : imagein::Image_t<D>(filename)
+imagein::RgbImage_t<D>::RgbImage_t(std::string filename, Layout layout)
+ : imagein::Image_t<D>(filename, layout)
 {
     if(this->_nChannels != 3) 
         throw BadImageException("Image with 3 channels expected", __LINE__, __FILE__);
@@ -32,9 +32,9 @@ imagein::RgbImage_t<D>::RgbImage_t(std::string filename)
 template <typename D>
 imagein::RgbImage_t<D>* imagein::RgbImage_t<D>::crop(const Rectangle& rect) const
 {
-    RgbImage_t<D>* ret = new RgbImage_t<D>(rect.w, rect.h);
+    RgbImage_t<D>* ret = new RgbImage_t<D>(rect.w, rect.h, NULL, this->_layout, this->_alignedRows);
 
-    Image_t<D>::crop(rect, ret->_mat);
+    Image_t<D>::crop(rect, *ret);
 
     return ret;
 }
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SlidingHistogram.h"
+
+#include <algorithm>
+#include "CpuFeatures.h"
+
+#ifdef IMAGEIN_X86_SIMD
+#include <immintrin.h>
+#endif
+
+using namespace imagein;
+
+//! Adds the bins of the entering column to the bins of the window, and subtracts the bins of the leaving column.
+typedef void (*SlideKernel)(unsigned int* bins, const unsigned int* entering, const unsigned int* leaving);
+
+//! Bins of a missing column.
+static const unsigned int noColumn[256] = {0};
+
+static void slideScalar(unsigned int* bins, const unsigned int* entering, const unsigned int* leaving) {
+    for(unsigned int i = 0; i < 256; ++i) {
+        bins[i] += entering[i] - leaving[i];
+    }
+}
+
+#ifdef IMAGEIN_X86_SIMD
+__attribute__((target("sse2")))
+static void slideSse2(unsigned int* bins, const unsigned int* entering, const unsigned int* leaving) {
+    for(unsigned int i = 0; i < 256; i += 4) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(entering + i));
+        const __m128i out = _mm_loadu_si128(reinterpret_cast<const __m128i*>(leaving + i));
+        __m128i* window = reinterpret_cast<__m128i*>(bins + i);
+        _mm_storeu_si128(window, _mm_add_epi32(_mm_loadu_si128(window), _mm_sub_epi32(in, out)));
+    }
+}
+
+__attribute__((target("avx2")))
+static void slideAvx2(unsigned int* bins, const unsigned int* entering, const unsigned int* leaving) {
+    for(unsigned int i = 0; i < 256; i += 8) {
+        const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(entering + i));
+        const __m256i out = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(leaving + i));
+        __m256i* window = reinterpret_cast<__m256i*>(bins + i);
+        _mm256_storeu_si256(window, _mm256_add_epi32(_mm256_loadu_si256(window), _mm256_sub_epi32(in, out)));
+    }
+}
+#endif
+
+static SlideKernel selectSlide() {
+#ifdef IMAGEIN_X86_SIMD
+    if(CpuFeatures::hasAvx2()) return slideAvx2;
+    if(CpuFeatures::hasSse2()) return slideSse2;
+#endif
+    return slideScalar;
+}
+
+static const SlideKernel slide = selectSlide();
+
+SlidingHistogram::SlidingHistogram(unsigned int width, unsigned int radius, bool withBins)
+ : _width(width), _radius(radius), _withBins(withBins),
+   _columnBins(withBins ? width * 256 : 0, 0), _columnSums(width, 0), _columnSumsOfSquares(width, 0), _nLines(0),
+   _sum(0), _sumOfSquares(0), _nColumns(0), _x(0)
+{
+    std::fill(_bins, _bins + 256, 0u);
+}
+
+void SlidingHistogram::addLine(const uint8_t* line)
+{
+    for(unsigned int x = 0; x < _width; ++x) {
+        const unsigned int v = line[x];
+        if(_withBins) ++_columnBins[x * 256 + v];
+        _columnSums[x] += v;
+        _columnSumsOfSquares[x] += v * v;
+    }
+    ++_nLines;
+}
+
+void SlidingHistogram::removeLine(const uint8_t* line)
+{
+    for(unsigned int x = 0; x < _width; ++x) {
+        const unsigned int v = line[x];
+        if(_withBins) --_columnBins[x * 256 + v];
+        _columnSums[x] -= v;
+        _columnSumsOfSquares[x] -= v * v;
+    }
+    --_nLines;
+}
+
+void SlidingHistogram::startLine()
+{
+    std::fill(_bins, _bins + 256, 0u);
+    _sum = _sumOfSquares = 0;
+    _nColumns = 0;
+    _x = 0;
+    for(unsigned int x = 0; x <= _radius && x < _width; ++x) {
+        addColumn(x);
+    }
+}
+
+void SlidingHistogram::moveRight()
+{
+    ++_x;
+    const bool entering = (_x + _radius < _width);
+    const bool leaving = (_x > _radius);
+    if(_withBins && (entering || leaving)) {
+        slide(_bins, entering ? &_columnBins[(_x + _radius) * 256] : noColumn, leaving ? &_columnBins[(_x - _radius - 1) * 256] : noColumn);
+    }
+    if(entering) {
+        _sum += _columnSums[_x + _radius];
+        _sumOfSquares += _columnSumsOfSquares[_x + _radius];
+        ++_nColumns;
+    }
+    if(leaving) {
+        _sum -= _columnSums[_x - _radius - 1];
+        _sumOfSquares -= _columnSumsOfSquares[_x - _radius - 1];
+        --_nColumns;
+    }
+}
+
+void SlidingHistogram::addColumn(unsigned int x)
+{
+    if(_withBins) {
+        slide(_bins, &_columnBins[x * 256], noColumn);
+    }
+    _sum += _columnSums[x];
+    _sumOfSquares += _columnSumsOfSquares[x];
+    ++_nColumns;
+}
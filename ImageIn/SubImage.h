@@ -0,0 +1,78 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef SUBIMAGE_H
+#define SUBIMAGE_H
+
+#include "Image.h"
+#include "RgbImage.h"
+#include "GrayscaleImage.h"
+
+namespace imagein
+{
+    /*!
+     * \brief View of a rectangle of an image, which shares the values of the image instead of copying them.
+     *
+     * A SubImage_t is an image of type I, so it can be given to the algorithms, the histograms and the converters
+     * in place of a crop of the image. Creating it costs nothing whatever the size of the rectangle.
+     *
+     * The image must outlive the view, and a change of the values of one is seen in the other. The view gives write
+     * access to the values : a view of a const image should only be used through a const reference.
+     * The lines of a view are as far apart as in the image, so code walking through the values with begin() and end()
+     * must check isContiguous() first. Copying a SubImage_t into an I, or changing its layout, gives an independent image.
+     *
+     * \tparam I The type of the image, such as Image_t<D>, RgbImage_t<D> or GrayscaleImage_t<D>.
+     */
+    template <class I>
+    class SubImage_t : public I
+    {
+        public:
+            /*!
+             * \brief Constructs a view of a rectangle of an image.
+             *
+             * \param img The image to look at.
+             * \param rect The rectangle of the image to look at.
+             * \throw out_of_range if the rectangle doesn't fit in the image.
+             */
+            SubImage_t(const I& img, const Rectangle& rect);
+
+            /*!
+             * \brief Constructs a view of the whole image.
+             *
+             * \param img The image to look at.
+             */
+            explicit SubImage_t(const I& img);
+
+            /*!
+             * \brief Copy constructor. The copy is a view of the same values.
+             *
+             * \param other The view to be copied.
+             */
+            SubImage_t(const SubImage_t<I>& other);
+
+            virtual ~SubImage_t() {}
+    };
+
+    typedef SubImage_t<Image> SubImage; //!< View of a standard Image.
+    typedef SubImage_t<RgbImage> RgbSubImage; //!< View of a standard RGB Image.
+    typedef SubImage_t<GrayscaleImage> GrayscaleSubImage; //!< View of a standard grayscale Image.
+}
+
+#include "SubImage.tpp"
+
+#endif // SUBIMAGE_H
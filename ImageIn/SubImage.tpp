@@ -0,0 +1,37 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+//#include "SubImage.h"
+
+template <class I>
+imagein::SubImage_t<I>::SubImage_t(const I& img, const Rectangle& rect)
+{
+    this->makeView(img, rect);
+}
+
+template <class I>
+imagein::SubImage_t<I>::SubImage_t(const I& img)
+{
+    this->makeView(img, Rectangle(0, 0, img.getWidth(), img.getHeight()));
+}
+
+template <class I>
+imagein::SubImage_t<I>::SubImage_t(const SubImage_t<I>& other) : I()
+{
+    this->makeView(other, Rectangle(0, 0, other.getWidth(), other.getHeight()));
+}
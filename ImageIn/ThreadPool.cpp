@@ -0,0 +1,270 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <unistd.h>
+
+using namespace imagein;
+
+ThreadPool::ThreadPool(unsigned int nThreads) : _nThreads(nThreads > 0 ? nThreads : nbProcessors())
+{
+#ifdef __linux__
+    _nextWorker = 0;
+    _pending = 0;
+    _stopping = false;
+    pthread_mutex_init(&_mutex, NULL);
+    pthread_cond_init(&_workCond, NULL);
+    pthread_cond_init(&_doneCond, NULL);
+    start();
+#endif
+}
+
+ThreadPool::~ThreadPool()
+{
+#ifdef __linux__
+    stop();
+    pthread_cond_destroy(&_doneCond);
+    pthread_cond_destroy(&_workCond);
+    pthread_mutex_destroy(&_mutex);
+#endif
+}
+
+ThreadPool& ThreadPool::instance()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+unsigned int ThreadPool::nbProcessors()
+{
+#ifdef _SC_NPROCESSORS_ONLN
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? static_cast<unsigned int>(n) : 1;
+#else
+    return 1;
+#endif
+}
+
+void ThreadPool::setNbThreads(unsigned int nThreads)
+{
+    if(nThreads == 0) nThreads = nbProcessors();
+    if(nThreads == _nThreads) return;
+#ifdef __linux__
+    stop();
+    _nThreads = nThreads;
+    start();
+#else
+    _nThreads = nThreads;
+#endif
+}
+
+#ifndef __linux__
+
+void ThreadPool::parallelFor(ParallelTask& task, unsigned int begin, unsigned int end, unsigned int)
+{
+    if(begin < end) task.run(begin, end);
+}
+
+#else
+
+void ThreadPool::start()
+{
+    _stopping = false;
+    // The calling thread of parallelFor is one of the _nThreads threads.
+    for(unsigned int i = 0; i + 1 < _nThreads; ++i) {
+        Worker* worker = new Worker;
+        worker->pool = this;
+        worker->index = i;
+        pthread_mutex_init(&worker->mutex, NULL);
+        _workers.push_back(worker);
+    }
+    for(unsigned int i = 0; i < _workers.size(); ++i) {
+        pthread_create(&_workers[i]->thread, NULL, &ThreadPool::workerMain, _workers[i]);
+    }
+}
+
+void ThreadPool::stop()
+{
+    pthread_mutex_lock(&_mutex);
+    _stopping = true;
+    pthread_cond_broadcast(&_workCond);
+    pthread_mutex_unlock(&_mutex);
+
+    for(unsigned int i = 0; i < _workers.size(); ++i) {
+        pthread_join(_workers[i]->thread, NULL);
+    }
+    for(unsigned int i = 0; i < _workers.size(); ++i) {
+        pthread_mutex_destroy(&_workers[i]->mutex);
+        delete _workers[i];
+    }
+    _workers.clear();
+    _nextWorker = 0;
+}
+
+void* ThreadPool::workerMain(void* data)
+{
+    Worker* worker = static_cast<Worker*>(data);
+    ThreadPool* pool = worker->pool;
+    Chunk chunk;
+
+    while(true) {
+        if(pool->takeChunk(worker->index, chunk)) {
+            pool->runChunk(chunk);
+            continue;
+        }
+        pthread_mutex_lock(&pool->_mutex);
+        while(pool->_pending == 0 && !pool->_stopping) {
+            pthread_cond_wait(&pool->_workCond, &pool->_mutex);
+        }
+        bool stopping = pool->_stopping && pool->_pending == 0;
+        pthread_mutex_unlock(&pool->_mutex);
+        if(stopping) break;
+    }
+    return NULL;
+}
+
+bool ThreadPool::takeChunk(unsigned int index, Chunk& chunk)
+{
+    const unsigned int nWorkers = _workers.size();
+    if(nWorkers == 0) return false;
+
+    // Our own queue first, from the back : its chunks were pushed last and are the most likely to be in cache.
+    if(index < nWorkers) {
+        Worker* worker = _workers[index];
+        pthread_mutex_lock(&worker->mutex);
+        bool found = !worker->chunks.empty();
+        if(found) {
+            chunk = worker->chunks.back();
+            worker->chunks.pop_back();
+        }
+        pthread_mutex_unlock(&worker->mutex);
+        if(found) {
+            pthread_mutex_lock(&_mutex);
+            --_pending;
+            pthread_mutex_unlock(&_mutex);
+            return true;
+        }
+    }
+
+    // Then steal from the front of the other queues.
+    const unsigned int first = (index < nWorkers) ? index + 1 : 0;
+    for(unsigned int n = 0; n < nWorkers; ++n) {
+        Worker* victim = _workers[(first + n) % nWorkers];
+        if(victim->index == index) continue;
+        pthread_mutex_lock(&victim->mutex);
+        bool found = !victim->chunks.empty();
+        if(found) {
+            chunk = victim->chunks.front();
+            victim->chunks.pop_front();
+        }
+        pthread_mutex_unlock(&victim->mutex);
+        if(found) {
+            pthread_mutex_lock(&_mutex);
+            --_pending;
+            pthread_mutex_unlock(&_mutex);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::runChunk(const Chunk& chunk)
+{
+    chunk.job->task->run(chunk.begin, chunk.end);
+
+    pthread_mutex_lock(&_mutex);
+    if(--chunk.job->remaining == 0) {
+        pthread_cond_broadcast(&_doneCond);
+    }
+    pthread_mutex_unlock(&_mutex);
+}
+
+void ThreadPool::parallelFor(ParallelTask& task, unsigned int begin, unsigned int end, unsigned int grain)
+{
+    if(begin >= end) return;
+    const unsigned int size = end - begin;
+
+    if(grain == 0) {
+        // A few chunks per thread, so that the threads which finish first can steal work from the others.
+        grain = size / (4 * _nThreads);
+        if(grain == 0) grain = 1;
+    }
+    if(_workers.empty() || size <= grain) {
+        task.run(begin, end);
+        return;
+    }
+
+    Job job;
+    job.task = &task;
+    job.remaining = (size + grain - 1) / grain;
+
+    const unsigned int nWorkers = _workers.size();
+    const unsigned int nChunks = job.remaining;
+
+    // The chunks are counted before they are pushed, so that a worker which takes one never decrements _pending below 0.
+    // _nextWorker is rotated under the same lock, as parallelFor may be called from several threads at once.
+    pthread_mutex_lock(&_mutex);
+    _pending += nChunks;
+    const unsigned int firstWorker = _nextWorker;
+    _nextWorker = (_nextWorker + 1) % nWorkers;
+    pthread_mutex_unlock(&_mutex);
+
+    // The chunks are distributed in contiguous blocks, so that each worker starts with neighbouring items.
+    unsigned int first = begin;
+    for(unsigned int w = 0; w < nWorkers; ++w) {
+        Worker* worker = _workers[(firstWorker + w) % nWorkers];
+        unsigned int count = nChunks / nWorkers + (w < nChunks % nWorkers ? 1 : 0);
+        pthread_mutex_lock(&worker->mutex);
+        // Pushed in reverse order : the owner pops from the back, and so processes its block in order.
+        for(unsigned int c = count; c > 0; --c) {
+            Chunk chunk;
+            chunk.job = &job;
+            chunk.begin = first + (c - 1) * grain;
+            chunk.end = std::min(chunk.begin + grain, end);
+            worker->chunks.push_back(chunk);
+        }
+        pthread_mutex_unlock(&worker->mutex);
+        first += count * grain;
+    }
+
+    pthread_mutex_lock(&_mutex);
+    pthread_cond_broadcast(&_workCond);
+    pthread_mutex_unlock(&_mutex);
+
+    // The calling thread helps until all the chunks of the job are done.
+    Chunk chunk;
+    while(true) {
+        if(takeChunk(nWorkers, chunk)) {
+            runChunk(chunk);
+            continue;
+        }
+        pthread_mutex_lock(&_mutex);
+        bool done = (job.remaining == 0);
+        if(!done) {
+            pthread_cond_wait(&_doneCond, &_mutex);
+            done = (job.remaining == 0);
+        }
+        pthread_mutex_unlock(&_mutex);
+        if(done) break;
+    }
+}
+
+#endif
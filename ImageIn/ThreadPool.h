@@ -0,0 +1,156 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <deque>
+
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+namespace imagein
+{
+    /*!
+     * \brief Interface of the work given to a ThreadPool.
+     *
+     * The work is a range of items (lines of an image, blocks...) which can be processed independently.
+     * The ThreadPool splits it in chunks and calls run() on each chunk, possibly from several threads at the same time.
+     */
+    class ParallelTask
+    {
+        public:
+            virtual ~ParallelTask() {}
+
+            /*!
+             * \brief Processes the items of the range [begin, end[.
+             */
+            virtual void run(unsigned int begin, unsigned int end) = 0;
+    };
+
+    /*!
+     * \brief Persistent pool of worker threads shared by the algorithms of the library.
+     *
+     * The threads are created once and wait for work, so that an algorithm can be parallelized
+     * without paying for the creation of threads at each call. Each worker owns a queue of chunks,
+     * and steals chunks from the other queues when its own is empty, which balances the load when the chunks
+     * don't take the same time. The thread calling parallelFor() also processes chunks until the work is done,
+     * so parallelFor() can be called from a task.
+     *
+     * Most users only need the library-wide pool returned by instance(). Its number of threads defaults to the
+     * number of processors and can be changed with setNbThreads().
+     *
+     * On systems without pthreads, the work is done by the calling thread.
+     */
+    class ThreadPool
+    {
+        public:
+            /*!
+             * \brief Creates a pool.
+             *
+             * \param nThreads The number of threads working on a parallelFor(), including the calling thread.
+             * 0 means the number of processors.
+             */
+            explicit ThreadPool(unsigned int nThreads = 0);
+
+            //! Waits for the worker threads to end.
+            ~ThreadPool();
+
+            //! Returns the pool shared by the algorithms of the library.
+            static ThreadPool& instance();
+
+            //! Returns the number of threads working on a parallelFor(), including the calling thread.
+            inline unsigned int getNbThreads() const { return _nThreads; }
+
+            /*!
+             * \brief Changes the number of threads of the pool.
+             *
+             * Must not be called while a parallelFor() is running.
+             *
+             * \param nThreads The number of threads, including the calling thread. 0 means the number of processors.
+             */
+            void setNbThreads(unsigned int nThreads);
+
+            /*!
+             * \brief Runs a task on the range [begin, end[ and returns when the whole range is processed.
+             *
+             * \param task The task to run.
+             * \param begin The first item of the range.
+             * \param end The item after the last item of the range.
+             * \param grain The maximum number of items of a chunk. 0 lets the pool choose.
+             */
+            void parallelFor(ParallelTask& task, unsigned int begin, unsigned int end, unsigned int grain = 0);
+
+        private:
+            ThreadPool(const ThreadPool&);
+            ThreadPool& operator=(const ThreadPool&);
+
+            //! Returns the number of processors.
+            static unsigned int nbProcessors();
+
+            unsigned int _nThreads;
+
+#ifdef __linux__
+            struct Job
+            {
+                ParallelTask* task;
+                unsigned int remaining;
+            };
+
+            struct Chunk
+            {
+                Job* job;
+                unsigned int begin;
+                unsigned int end;
+            };
+
+            struct Worker
+            {
+                ThreadPool* pool;
+                unsigned int index;
+                pthread_t thread;
+                pthread_mutex_t mutex;
+                std::deque<Chunk> chunks;
+            };
+
+            static void* workerMain(void* data);
+
+            void start();
+            void stop();
+
+            //! Takes a chunk from the queue of the given worker (from the back), or steals one from another queue (from the front).
+            bool takeChunk(unsigned int index, Chunk& chunk);
+
+            //! Runs a chunk and signals the end of its job if it was the last one.
+            void runChunk(const Chunk& chunk);
+
+            std::vector<Worker*> _workers;
+            unsigned int _nextWorker; //!< Worker receiving the first block of the next job, protected by _mutex.
+            unsigned int _pending; //!< Number of chunks in the queues, protected by _mutex.
+            bool _stopping;
+            pthread_mutex_t _mutex;
+            pthread_cond_t _workCond;
+            pthread_cond_t _doneCond;
+#endif
+    };
+}
+
+#endif // THREADPOOL_H
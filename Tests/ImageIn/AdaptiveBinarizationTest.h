@@ -0,0 +1,151 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ADAPTIVEBINARIZATIONTEST_H
+#define ADAPTIVEBINARIZATIONTEST_H
+
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include <GrayscaleImage.h>
+#include <ThreadPool.h>
+#include <Algorithm/AdaptiveBinarization.h>
+
+#include "Test.h"
+
+/*
+ * Compares AdaptiveBinarization_t on a random 8-bit image, binarized by strips in the ThreadPool,
+ * with the thresholds computed directly on the window of each pixel.
+ */
+class AdaptiveBinarizationTest : public Test {
+
+  public:
+    typedef imagein::algorithm::AdaptiveBinarization_t<uint8_t> Algo;
+
+    AdaptiveBinarizationTest(std::string name, Algo::Method method, unsigned int radius, unsigned int nThreads, unsigned int width, unsigned int height)
+        : Test(name), _method(method), _radius(radius), _nThreads(nThreads), _width(width), _height(height), _img(NULL), _failure("") {}
+
+    virtual bool init() {
+        srand(_radius + _width);
+        //A gradient with dark blocks and noise, as an unevenly lit document.
+        _img = new imagein::GrayscaleImage_t<uint8_t>(_width, _height);
+        for(unsigned int j = 0; j < _height; ++j) {
+            for(unsigned int i = 0; i < _width; ++i) {
+                double value = (i + j) * 0.8 + rand() % 60;
+                if((i / 10 + j / 7) % 3 == 0) value -= 40;
+                _img->setPixel(i, j, static_cast<uint8_t>(std::max(0., std::min(255., value))));
+            }
+        }
+        return true;
+    }
+
+    virtual bool test() {
+        imagein::ThreadPool& pool = imagein::ThreadPool::instance();
+        const unsigned int nThreads = pool.getNbThreads();
+        pool.setNbThreads(_nThreads);
+        imagein::GrayscaleImage_t<uint8_t>* result = NULL;
+        try {
+            Algo algo(_method, _radius);
+            result = algo(_img);
+        }
+        catch(...) {
+            pool.setNbThreads(nThreads);
+            throw;
+        }
+        pool.setNbThreads(nThreads);
+
+        std::ostringstream oss;
+        for(unsigned int j = 0; j < _height && oss.str().empty(); ++j) {
+            for(unsigned int i = 0; i < _width; ++i) {
+                const uint8_t expected = (_img->getPixel(i, j) <= threshold(i, j)) ? 0 : 255;
+                if(result->getPixel(i, j) != expected) {
+                    oss << "pixel (" << i << ", " << j << ") is " << static_cast<int>(result->getPixel(i, j)) << ", expected " << static_cast<int>(expected);
+                    break;
+                }
+            }
+        }
+        delete result;
+        _failure = oss.str();
+        return _failure.empty();
+    }
+
+    virtual bool cleanup() {
+        delete _img;
+        return true;
+    }
+
+    virtual std::string info() {
+        return _failure;
+    }
+
+  protected:
+    //The threshold of the window of the pixel (x, y), clipped to the image.
+    double threshold(unsigned int x, unsigned int y) const {
+        const unsigned int x0 = (x > _radius) ? x - _radius : 0, x1 = std::min(_width - 1, x + _radius);
+        const unsigned int y0 = (y > _radius) ? y - _radius : 0, y1 = std::min(_height - 1, y + _radius);
+        unsigned int bins[256] = {0};
+        double sum = 0., sumOfSquares = 0., count = 0.;
+        for(unsigned int j = y0; j <= y1; ++j) {
+            for(unsigned int i = x0; i <= x1; ++i) {
+                const unsigned int value = _img->getPixel(i, j);
+                ++bins[value];
+                sum += value;
+                sumOfSquares += value * value;
+                ++count;
+            }
+        }
+        if(_method == Algo::METHOD_LOCAL_OTSU) {
+            //The first threshold which maximizes the between-class variance.
+            double weightb = 0., sumb = 0., maxVariance = 0.;
+            unsigned int chosen = 0;
+            for(unsigned int t = 0; t < 256; ++t) {
+                weightb += bins[t];
+                if(weightb == 0.) continue;
+                if(weightb == count) break;
+                sumb += static_cast<double>(t) * bins[t];
+                const double diff = sumb * count - sum * weightb;
+                const double variance = diff * diff / (weightb * (count - weightb));
+                if(variance > maxVariance) {
+                    maxVariance = variance;
+                    chosen = t;
+                }
+            }
+            return chosen;
+        }
+        const double mean = sum / count;
+        const double deviation = std::sqrt(std::max(0., sumOfSquares / count - mean * mean));
+        if(_method == Algo::METHOD_NIBLACK) {
+            return mean - 0.2 * deviation;
+        }
+        return mean * (1. + 0.5 * (deviation / 128. - 1.));
+    }
+
+    Algo::Method _method;
+    unsigned int _radius;
+    unsigned int _nThreads;
+    unsigned int _width;
+    unsigned int _height;
+    imagein::GrayscaleImage_t<uint8_t>* _img;
+    std::string _failure;
+};
+
+#endif //!ADAPTIVEBINARIZATIONTEST_H
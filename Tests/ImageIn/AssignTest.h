@@ -0,0 +1,116 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ASSIGNTEST_H
+#define ASSIGNTEST_H
+
+#include <string>
+
+#include <Rectangle.h>
+#include <Image.h>
+#include <SubImage.h>
+#include <ImageBufferPool.h>
+#include "Test.h"
+
+/*
+ * Checks the affectation of a view of an image to this image, which must copy the values before freeing the buffer.
+ * The buffers are not kept by the pool during the test, so that reading a freed buffer is caught by memory checkers.
+ */
+class AssignTest : public Test {
+
+  public:
+    typedef unsigned char D;
+    typedef imagein::SubImage_t<imagein::Image_t<D> > View;
+
+    AssignTest()
+        : Test("Affectation of a view"), _failure(""), _maxCachedBytes(0) {}
+
+    virtual bool init() {
+        _maxCachedBytes = imagein::ImageBufferPool::instance().getMaxCachedBytes();
+        imagein::ImageBufferPool::instance().setMaxCachedBytes(0);
+        return true;
+    }
+
+    virtual bool test() {
+        const imagein::Rectangle rect(2, 2, 4, 4);
+
+        //Temporary view
+        imagein::Image_t<D> a(8, 8, 2, D(0));
+        fill(a);
+        a = View(a, rect);
+        if(!check(a, rect)) _failure = "temporary view";
+
+        //Named view
+        imagein::Image_t<D> b(8, 8, 2, D(0));
+        fill(b);
+        View v(b, rect);
+        b = v;
+        if(!check(b, rect)) _failure = "named view";
+
+        //View in an interleaved image
+        imagein::Image_t<D> c(8, 8, 2, D(0));
+        fill(c);
+        imagein::Image_t<D> d(c, imagein::LAYOUT_INTERLEAVED);
+        d = View(d, rect);
+        if(!check(d, rect)) _failure = "interleaved view";
+
+        return _failure.empty();
+    }
+
+    virtual bool cleanup() {
+        imagein::ImageBufferPool::instance().setMaxCachedBytes(_maxCachedBytes);
+        return true;
+    }
+
+    virtual std::string info() {
+        return _failure;
+    }
+
+  protected:
+    static D value(unsigned int x, unsigned int y, unsigned int c) {
+        return static_cast<D>(1 + x + 8 * y + 64 * c);
+    }
+
+    static void fill(imagein::Image_t<D>& img) {
+        for(unsigned int c = 0; c < img.getNbChannels(); ++c) {
+            for(unsigned int j = 0; j < img.getHeight(); ++j) {
+                for(unsigned int i = 0; i < img.getWidth(); ++i) {
+                    img.setPixel(i, j, c, value(i, j, c));
+                }
+            }
+        }
+    }
+
+    static bool check(const imagein::Image_t<D>& img, const imagein::Rectangle& rect) {
+        if(img.getWidth() != rect.w || img.getHeight() != rect.h || img.getNbChannels() != 2) return false;
+        for(unsigned int c = 0; c < img.getNbChannels(); ++c) {
+            for(unsigned int j = 0; j < img.getHeight(); ++j) {
+                for(unsigned int i = 0; i < img.getWidth(); ++i) {
+                    if(img.getPixel(i, j, c) != value(rect.x + i, rect.y + j, c)) return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    std::string _failure;
+    std::size_t _maxCachedBytes;
+};
+
+#endif //!ASSIGNTEST_H
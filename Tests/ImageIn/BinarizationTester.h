@@ -22,6 +22,7 @@
 
 #include "Tester.h"
 #include "AlgorithmTest.h"
+#include "AdaptiveBinarizationTest.h"
 #include <Algorithm/Binarization.h>
 #include <Algorithm/Otsu.h>
 
@@ -43,6 +44,15 @@ class BinarizationTester : public Tester {
         addTest(new AlgorithmTest<D>("Otsu on harewood", _otsu, "res/harewood.png", "res/harewood_BW.png", nodiff));
         addTest(new AlgorithmTest<D>("Otsu on snow", _otsu, "res/snow.jpg", "res/snow_BW.png", nodiff));
         addTest(new AlgorithmTest<D>("Otsu on nutsBolts", _otsu, "res/nutsBolts.jpg", "res/nutsBolts_BW.png", nodiff));
+
+        typedef AdaptiveBinarizationTest::Algo Adaptive;
+        addTest(new AdaptiveBinarizationTest("Niblack", Adaptive::METHOD_NIBLACK, 7, 4, 123, 200));
+        addTest(new AdaptiveBinarizationTest("Sauvola", Adaptive::METHOD_SAUVOLA, 7, 4, 123, 200));
+        addTest(new AdaptiveBinarizationTest("Local Otsu", Adaptive::METHOD_LOCAL_OTSU, 7, 4, 123, 200));
+        addTest(new AdaptiveBinarizationTest("Sauvola, radius larger than a strip", Adaptive::METHOD_SAUVOLA, 60, 4, 123, 200));
+        addTest(new AdaptiveBinarizationTest("Local Otsu, radius larger than a strip", Adaptive::METHOD_LOCAL_OTSU, 45, 3, 97, 101));
+        addTest(new AdaptiveBinarizationTest("Niblack, radius larger than the image", Adaptive::METHOD_NIBLACK, 300, 4, 123, 200));
+        addTest(new AdaptiveBinarizationTest("Sauvola, radius 0", Adaptive::METHOD_SAUVOLA, 0, 1, 64, 64));
     }
 
     void clean() {
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BINARYMORPHOTEST_H
+#define BINARYMORPHOTEST_H
+
+#include <string>
+#include <sstream>
+#include <cstdlib>
+
+#include <Image.h>
+#include <GrayscaleImage.h>
+#include <BinaryImage.h>
+#include <Algorithm/MorphoMat.h>
+#include "Test.h"
+
+/*
+ * Compares the word-parallel operators of BinaryImage with the operators of MorphoMat on a random 0/255 image.
+ */
+class BinaryMorphoTest : public Test {
+
+  public:
+
+    BinaryMorphoTest(std::string name, unsigned int width, unsigned int height, const imagein::MorphoMat::StructElem& elem)
+        : Test(name), _width(width), _height(height), _elem(elem), _img(NULL), _failure("") {}
+
+    virtual bool init() {
+        srand(_width * 31 + _height);
+        _img = new imagein::GrayscaleImage_t<uint8_t>(_width, _height);
+        for(imagein::Image_t<uint8_t>::iterator it = _img->begin(); it < _img->end(); ++it) {
+            *it = (rand() % 3 != 0) ? 255 : 0;
+        }
+        return true;
+    }
+
+    virtual bool test() {
+        using namespace imagein::MorphoMat;
+        const imagein::BinaryImage binary(*_img);
+        Erosion<uint8_t> erosion(_elem);
+        Dilatation<uint8_t> dilatation(_elem);
+        Opening<uint8_t> opening(_elem);
+        Closing<uint8_t> closing(_elem);
+        return compare("erosion", binary.erode(_elem), erosion)
+            && compare("dilatation", binary.dilate(_elem), dilatation)
+            && compare("opening", binary.open(_elem), opening)
+            && compare("closing", binary.close(_elem), closing);
+    }
+
+    virtual bool cleanup() {
+        delete _img;
+        return true;
+    }
+
+    virtual std::string info() {
+        return _failure;
+    }
+
+  protected:
+    bool compare(const std::string& op, const imagein::BinaryImage& result, imagein::GenericAlgorithm_t<uint8_t>& algo) {
+        imagein::Image_t<uint8_t>* expected = algo(_img);
+        for(unsigned int y = 0; y < _height; ++y) {
+            for(unsigned int x = 0; x < _width; ++x) {
+                if(result.getPixel(x, y) != (expected->getPixel(x, y, 0) != 0)) {
+                    std::ostringstream oss;
+                    oss << op << " differs at (" << x << ", " << y << ")";
+                    _failure = oss.str();
+                    delete expected;
+                    return false;
+                }
+            }
+        }
+        delete expected;
+        return true;
+    }
+
+    unsigned int _width;
+    unsigned int _height;
+    imagein::MorphoMat::StructElem _elem;
+    imagein::GrayscaleImage_t<uint8_t>* _img;
+    std::string _failure;
+};
+
+#endif //!BINARYMORPHOTEST_H
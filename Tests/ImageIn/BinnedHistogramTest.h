@@ -0,0 +1,168 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BINNEDHISTOGRAMTEST_H
+#define BINNEDHISTOGRAMTEST_H
+
+#include <string>
+#include <sstream>
+#include <vector>
+#include <limits>
+#include <cstdlib>
+
+#include <Rectangle.h>
+#include <Image.h>
+#include <SubImage.h>
+#include <Histogram.h>
+#include <ThreadPool.h>
+#include "Test.h"
+
+/*
+ * Compares the histograms of a random image, counted by strips in the ThreadPool, with a naive count in the bins they report.
+ * The image is large enough to be split in several strips, and the histograms can be computed on a view.
+ */
+template<typename D>
+class BinnedHistogramTest : public Test {
+
+  public:
+
+    BinnedHistogramTest(std::string name, double offset, double spread, imagein::Layout layout, bool view, unsigned int nbBins,
+                        const imagein::Rectangle& rect = imagein::Rectangle())
+        : Test(name), _offset(offset), _spread(spread), _layout(layout), _view(view), _nbBins(nbBins), _rect(rect), _img(NULL), _failure("") {}
+
+    virtual bool init() {
+        srand(5);
+        imagein::Image_t<D> img(613, 507, 3, D());
+        for(typename imagein::Image_t<D>::iterator it = img.begin(); it < img.end(); ++it) {
+            *it = static_cast<D>(_offset + _spread * (rand() / static_cast<double>(RAND_MAX)));
+        }
+        _img = new imagein::Image_t<D>(img, _layout, true);
+        return true;
+    }
+
+    virtual bool test() {
+        imagein::ThreadPool& pool = imagein::ThreadPool::instance();
+        const unsigned int nThreads = pool.getNbThreads();
+        pool.setNbThreads(4);
+        bool success = false;
+        try {
+            if(_view) {
+                const imagein::SubImage_t<imagein::Image_t<D> > view(*_img, imagein::Rectangle(9, 4, 597, 500));
+                success = check(view);
+            }
+            else {
+                success = check(*_img);
+            }
+        }
+        catch(...) {
+            pool.setNbThreads(nThreads);
+            throw;
+        }
+        pool.setNbThreads(nThreads);
+        return success;
+    }
+
+    virtual bool cleanup() {
+        delete _img;
+        return true;
+    }
+
+    virtual std::string info() {
+        return _failure;
+    }
+
+  protected:
+    bool check(const imagein::Image_t<D>& img) {
+        for(unsigned int c = 0; c < img.getNbChannels(); ++c) {
+            const imagein::Histogram histogram = (_nbBins > 0) ? imagein::Histogram(img, c, _nbBins, _rect) : imagein::Histogram(img, c, _rect);
+            if(!compare("histogram", img, c, histogram, true)) return false;
+        }
+        if(_nbBins == 0) {
+            const std::vector<imagein::Histogram> histograms = imagein::Histogram::computeAll(img, _rect);
+            for(unsigned int c = 0; c < img.getNbChannels(); ++c) {
+                if(!compare("computeAll", img, c, histograms[c], true)) return false;
+            }
+        }
+        if(!std::numeric_limits<D>::is_integer) {
+            //A range covering the middle of the values : the others are not counted.
+            const imagein::Histogram histogram(img, 1, _offset + _spread / 4., _offset + 3. * _spread / 4., 50, _rect);
+            if(!compare("given range", img, 1, histogram, false)) return false;
+        }
+        return true;
+    }
+
+    //The value of a pixel in the image, 8-bit values being unsigned.
+    static double value(const imagein::Image_t<D>& img, unsigned int i, unsigned int j, unsigned int c) {
+        const D v = img.getPixel(i, j, c);
+        return (sizeof(D) == 1) ? static_cast<double>(static_cast<unsigned char>(v)) : static_cast<double>(v);
+    }
+
+    bool compare(const std::string& what, const imagein::Image_t<D>& img, unsigned int c, const imagein::Histogram& histogram, bool autoRange) {
+        const unsigned int x0 = _rect.x, y0 = _rect.y;
+        const unsigned int x1 = _rect.w > 0 ? _rect.x + _rect.w : img.getWidth();
+        const unsigned int y1 = _rect.h > 0 ? _rect.y + _rect.h : img.getHeight();
+        const unsigned int nbBins = histogram.getWidth();
+        const double min = histogram.getMin(), max = histogram.getMax();
+        std::ostringstream oss;
+
+        double valueMin = std::numeric_limits<double>::max(), valueMax = -valueMin;
+        std::vector<unsigned int> bins(nbBins, 0);
+        for(unsigned int j = y0; j < y1; ++j) {
+            for(unsigned int i = x0; i < x1; ++i) {
+                const double v = value(img, i, j, c);
+                valueMin = std::min(valueMin, v);
+                valueMax = std::max(valueMax, v);
+                if(std::numeric_limits<D>::is_integer) {
+                    const double bin = std::floor((v - min) / histogram.getBinWidth());
+                    if(bin >= 0. && bin < nbBins) ++bins[static_cast<unsigned int>(bin)];
+                }
+                else if(v >= min && v <= max) {
+                    const unsigned int bin = static_cast<unsigned int>((v - min) * (nbBins / (max - min)));
+                    ++bins[std::min(bin, nbBins - 1)];
+                }
+            }
+        }
+
+        //The automatic ranges start at the minimum of the values, and cover the maximum.
+        if(autoRange && sizeof(D) > 1 && (min != valueMin || max < valueMax)) {
+            oss << what << " : range [" << min << ", " << max << "] for values in [" << valueMin << ", " << valueMax << "]";
+        }
+        else if(autoRange && nbBins > (_nbBins > 0 ? _nbBins : imagein::Histogram::DEFAULT_NB_BINS)) {
+            oss << what << " : " << nbBins << " bins";
+        }
+        for(unsigned int b = 0; b < nbBins && oss.str().empty(); ++b) {
+            if(histogram[b] != bins[b]) {
+                oss << what << " : bin " << b << " of the channel " << c << " has " << histogram[b] << " values, expected " << bins[b];
+            }
+        }
+        _failure = oss.str();
+        return _failure.empty();
+    }
+
+    double _offset;
+    double _spread;
+    imagein::Layout _layout;
+    bool _view;
+    unsigned int _nbBins;
+    imagein::Rectangle _rect;
+    imagein::Image_t<D>* _img;
+    std::string _failure;
+};
+
+#endif //!BINNEDHISTOGRAMTEST_H
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COLORSPACETEST_H
+#define COLORSPACETEST_H
+
+#include <string>
+#include <sstream>
+#include <cmath>
+#include <cstdlib>
+
+#include <Image.h>
+#include <ColorSpace.h>
+#include "Test.h"
+
+/*
+ * Compares the fixed point conversions of ColorSpace on a random image with the formulas computed in double precision,
+ * within 1. The width decides how many values are left after the vector loops.
+ */
+class ColorSpaceTest : public Test {
+
+  public:
+
+    ColorSpaceTest(std::string name, unsigned int width, imagein::Layout layout)
+        : Test(name), _width(width), _layout(layout), _img(NULL), _failure("") {}
+
+    virtual bool init() {
+        srand(_width);
+        _img = new imagein::Image_t<imagein::depth8_t>(_width, 9, 3, NULL, _layout, true);
+        for(imagein::Image_t<imagein::depth8_t>::iterator it = _img->begin(); it < _img->end(); ++it) {
+            *it = static_cast<imagein::depth8_t>(rand());
+        }
+        return true;
+    }
+
+    virtual bool test() {
+        using imagein::ColorSpace;
+        static const double gray[3][3] = { { 0.299, 0.587, 0.114 }, { 0., 0., 0. }, { 0., 0., 0. } };
+        static const double custom[3][3] = { { -0.25, 1., 0.5 }, { 0., 0., 0. }, { 0., 0., 0. } };
+        static const double toYCbCr[3][3] = { { 0.299, 0.587, 0.114 }, { -0.168736, -0.331264, 0.5 }, { 0.5, -0.418688, -0.081312 } };
+        static const double fromYCbCr[3][3] = { { 1., 0., 1.402 }, { 1., -0.344136, -0.714136 }, { 1., 1.772, 0. } };
+        static const double noOffsets[3] = { 0., 0., 0. };
+        static const double yCbCrOffsets[3] = { 0., 128., 128. };
+        static const double rgbOffsets[3] = { -1.402 * 128., (0.344136 + 0.714136) * 128., -1.772 * 128. };
+
+        imagein::Image_t<imagein::depth8_t>* result = ColorSpace::rgbToGrayscale(*_img);
+        bool success = compare("grayscale", *result, gray, noOffsets, true);
+        delete result;
+        result = ColorSpace::rgbToGrayscale(*_img, custom[0][0], custom[0][1], custom[0][2]);
+        success = success && compare("grayscale with a negative weight", *result, custom, noOffsets, true);
+        delete result;
+        result = ColorSpace::rgbToYCbCr(*_img);
+        success = success && compare("YCbCr", *result, toYCbCr, yCbCrOffsets, false);
+        delete result;
+        //The random image is read as YCbCr values.
+        result = ColorSpace::yCbCrToRgb(*_img);
+        success = success && compare("RGB", *result, fromYCbCr, rgbOffsets, false);
+        delete result;
+        return success;
+    }
+
+    virtual bool cleanup() {
+        delete _img;
+        return true;
+    }
+
+    virtual std::string info() {
+        return _failure;
+    }
+
+  protected:
+    //The grayscale is rounded down, the other conversions to the nearest.
+    bool compare(const std::string& conversion, const imagein::Image_t<imagein::depth8_t>& result, const double weights[3][3], const double offsets[3], bool roundDown) {
+        for(unsigned int c = 0; c < result.getNbChannels(); ++c) {
+            for(unsigned int j = 0; j < result.getHeight(); ++j) {
+                for(unsigned int i = 0; i < result.getWidth(); ++i) {
+                    double value = offsets[c];
+                    for(unsigned int k = 0; k < 3; ++k) {
+                        value += weights[c][k] * _img->getPixel(i, j, k);
+                    }
+                    value = roundDown ? std::floor(value) : std::floor(value + 0.5);
+                    value = std::max(0., std::min(255., value));
+                    if(std::abs(result.getPixel(i, j, c) - value) > 1.) {
+                        std::ostringstream oss;
+                        oss << conversion << " : " << static_cast<int>(result.getPixel(i, j, c)) << " at (" << i << ", " << j << ", " << c << "), expected " << value;
+                        _failure = oss.str();
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    unsigned int _width;
+    imagein::Layout _layout;
+    imagein::Image_t<imagein::depth8_t>* _img;
+    std::string _failure;
+};
+
+#endif //!COLORSPACETEST_H
@@ -22,6 +22,7 @@
 
 #include "Tester.h"
 #include "ComponentLabelingTest.h"
+#include "ComponentStripsTest.h"
 
 using namespace imagein;
 using namespace imagein::MorphoMat;
@@ -43,6 +44,9 @@ class ComponentLabelingTester : public Tester {
         addTest(new ComponentLabelingTest<D>("Rice & sugar", "res/ricensugar.png", 785, 28.67, con8, true));
         addTest(new ComponentLabelingTest<D>("M (w/ white top-hat)", "res/M_wtophat_d15.png", 3, 187, con8, true));
         addTest(new ComponentLabelingTest<D>("QR Code", "res/qrcode.png", 186, 495.14, con4, false));
+        addTest(new ComponentStripsTest<D>("Strips, 8-connectivity", con8, 4, 150, 200));
+        addTest(new ComponentStripsTest<D>("Strips, 4-connectivity", con4, 4, 150, 200));
+        addTest(new ComponentStripsTest<D>("Strips, uneven", con8, 3, 97, 101));
     }
 
     void clean() {
@@ -0,0 +1,195 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMPONENTSTRIPSTEST_H
+#define COMPONENTSTRIPSTEST_H
+
+#include <string>
+#include <sstream>
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <cstdlib>
+
+#include <GrayscaleImage.h>
+#include <ThreadPool.h>
+#include <Algorithm/ComponentLabeling.h>
+
+#include "Test.h"
+
+/*
+ * Labels a random image crossed by shapes which join across the boundaries between the strips, by strips in parallel
+ * and sequentially, and compares both labelings and their ComponentStats with a flood fill of the image.
+ */
+template<typename D>
+class ComponentStripsTest : public Test {
+
+  public:
+    typedef imagein::algorithm::ComponentLabeling_t<D> Labeling;
+    typedef typename Labeling::Connectivity Connectivity;
+    typedef typename Labeling::ComponentStats ComponentStats;
+
+    ComponentStripsTest(std::string name, Connectivity connectivity, unsigned int nThreads, unsigned int width, unsigned int height)
+        : Test(name), _connectivity(connectivity), _nThreads(nThreads), _width(width), _height(height), _img(NULL), _failure("") {}
+
+    virtual bool init() {
+        const D on = std::numeric_limits<D>::max();
+        srand(_width + _nThreads);
+        _img = new imagein::GrayscaleImage_t<D>(_width, _height);
+        for(typename imagein::Image_t<D>::iterator it = _img->begin(); it < _img->end(); ++it) {
+            *it = (rand() % 5 == 0) ? on : 0;
+        }
+        //A frame of background around the shapes, so they don't touch the noise.
+        for(unsigned int j = 0; j < _height; ++j) {
+            for(unsigned int i = 2; i < 14; ++i) _img->setPixel(i, j, 0);
+        }
+        //A U whose two branches cross every strip and only join on the last line.
+        for(unsigned int j = 0; j < _height; ++j) {
+            _img->setPixel(4, j, on);
+            _img->setPixel(8, j, on);
+        }
+        for(unsigned int i = 4; i <= 8; ++i) _img->setPixel(i, _height - 1, on);
+        //A diagonal, which is one component with the 8-connectivity and one component per pixel with the 4-connectivity.
+        for(unsigned int j = 0; j < _height && j < 4; ++j) _img->setPixel(11 + (j % 2), j, on);
+        for(unsigned int j = 4; j < _height; ++j) _img->setPixel(11 + (j % 2), j, (j / 4) % 2 ? on : 0);
+        return true;
+    }
+
+    virtual bool test() {
+        imagein::ThreadPool& pool = imagein::ThreadPool::instance();
+        const unsigned int nThreads = pool.getNbThreads();
+        pool.setNbThreads(_nThreads);
+        bool success = false;
+        try {
+            success = check("parallel", true) && check("sequential", false);
+        }
+        catch(...) {
+            pool.setNbThreads(nThreads);
+            throw;
+        }
+        pool.setNbThreads(nThreads);
+        return success;
+    }
+
+    virtual bool cleanup() {
+        delete _img;
+        return true;
+    }
+
+    virtual std::string info() {
+        return _failure;
+    }
+
+  protected:
+    bool check(const std::string& mode, bool parallel) {
+        std::vector<unsigned int> expected;
+        std::vector<ComponentStats> expectedStats;
+        floodFill(expected, expectedStats);
+
+        Labeling labeling(_connectivity, true, false);
+        labeling.setParallel(parallel);
+        imagein::GrayscaleImage_t<unsigned int>* labels = labeling.label(_img);
+        std::ostringstream oss;
+        for(unsigned int j = 0; j < _height && oss.str().empty(); ++j) {
+            for(unsigned int i = 0; i < _width; ++i) {
+                if(labels->getPixel(i, j) != expected[j * _width + i]) {
+                    oss << mode << " : label " << labels->getPixel(i, j) << " at (" << i << ", " << j << "), expected " << expected[j * _width + i];
+                    break;
+                }
+            }
+        }
+        delete labels;
+        if(oss.str().empty() && labeling.getNbComponents() != expectedStats.size()) {
+            oss << mode << " : " << labeling.getNbComponents() << " components, expected " << expectedStats.size();
+        }
+        for(unsigned int c = 0; c < expectedStats.size() && oss.str().empty(); ++c) {
+            const ComponentStats& s = labeling.getComponentStats()[c];
+            const ComponentStats& e = expectedStats[c];
+            if(s.area != e.area || s.perimeter != e.perimeter
+            || s.boundingBox.x != e.boundingBox.x || s.boundingBox.y != e.boundingBox.y
+            || s.boundingBox.w != e.boundingBox.w || s.boundingBox.h != e.boundingBox.h
+            || std::abs(s.centroidX - e.centroidX) > 1e-9 || std::abs(s.centroidY - e.centroidY) > 1e-9) {
+                oss << mode << " : wrong statistics for the component " << c + 1;
+            }
+        }
+        _failure = oss.str();
+        return _failure.empty();
+    }
+
+    //Labels the components in the order of their first pixel with a flood fill, and measures them.
+    void floodFill(std::vector<unsigned int>& labels, std::vector<ComponentStats>& stats) const {
+        const D on = std::numeric_limits<D>::max();
+        const int w = _width, h = _height;
+        const int neighbours = (_connectivity == Labeling::CONNECT_8) ? 8 : 4;
+        const int dx[8] = {1, 0, -1, 0, 1, 1, -1, -1};
+        const int dy[8] = {0, 1, 0, -1, 1, -1, 1, -1};
+        labels.assign(_width * _height, 0);
+        stats.clear();
+        for(int j = 0; j < h; ++j) {
+            for(int i = 0; i < w; ++i) {
+                if(_img->getPixel(i, j) != on || labels[j * w + i] != 0) continue;
+                const unsigned int label = stats.size() + 1;
+                unsigned int area = 0, perimeter = 0;
+                int minX = i, maxX = i, minY = j, maxY = j;
+                double sumX = 0., sumY = 0.;
+                std::vector<int> stack(1, j * w + i);
+                labels[j * w + i] = label;
+                while(!stack.empty()) {
+                    const int x = stack.back() % w, y = stack.back() / w;
+                    stack.pop_back();
+                    ++area;
+                    sumX += x;
+                    sumY += y;
+                    minX = std::min(minX, x);
+                    maxX = std::max(maxX, x);
+                    minY = std::min(minY, y);
+                    maxY = std::max(maxY, y);
+                    for(int n = 0; n < neighbours; ++n) {
+                        const int nx = x + dx[n], ny = y + dy[n];
+                        const bool inside = nx >= 0 && nx < w && ny >= 0 && ny < h;
+                        if(!inside || _img->getPixel(nx, ny) != on) {
+                            if(n < 4) ++perimeter;
+                            continue;
+                        }
+                        if(labels[ny * w + nx] == 0) {
+                            labels[ny * w + nx] = label;
+                            stack.push_back(ny * w + nx);
+                        }
+                    }
+                }
+                ComponentStats s;
+                s.area = area;
+                s.perimeter = perimeter;
+                s.boundingBox = imagein::Rectangle(minX, minY, maxX - minX + 1, maxY - minY + 1);
+                s.centroidX = sumX / area;
+                s.centroidY = sumY / area;
+                stats.push_back(s);
+            }
+        }
+    }
+
+    Connectivity _connectivity;
+    unsigned int _nThreads;
+    unsigned int _width;
+    unsigned int _height;
+    imagein::GrayscaleImage_t<D>* _img;
+    std::string _failure;
+};
+
+#endif //!COMPONENTSTRIPSTEST_H
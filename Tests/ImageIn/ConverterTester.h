@@ -22,6 +22,7 @@
 
 #include "Tester.h"
 #include "ConverterTest.h"
+#include "ColorSpaceTest.h"
 
 using namespace imagein;
 
@@ -38,6 +39,10 @@ class ConverterTester : public Tester {
         addTest(new ConverterTest<RgbImage_t<D>, GrayscaleImage_t<D> >("GrayscaleImage <-> RgbImage", _grayImg));
         addTest(new ConverterTest<Image_t<D>, RgbImage_t<D> >("RgbImage <-> Image", _rgbImg));
         addTest(new ConverterTest<Image_t<D>, GrayscaleImage_t<D> >("GrayscaleImage <-> Image", _grayImg));
+        addTest(new ColorSpaceTest("Color spaces (planar, 100 pixels)", 100, LAYOUT_PLANAR));
+        addTest(new ColorSpaceTest("Color spaces (planar, 47 pixels)", 47, LAYOUT_PLANAR));
+        addTest(new ColorSpaceTest("Color spaces (planar, 1 pixel)", 1, LAYOUT_PLANAR));
+        addTest(new ColorSpaceTest("Color spaces (interleaved, 47 pixels)", 47, LAYOUT_INTERLEAVED));
     }
 
     void clean() {
@@ -25,6 +25,11 @@
 #include "CropTest.h"
 #include "HistogramTest.h"
 #include "ProjHistTest.h"
+#include "ViewTest.h"
+#include "AssignTest.h"
+#include "StatisticsTest.h"
+#include "BinnedHistogramTest.h"
+#include "IntegralImageTest.h"
 
 using namespace imagein;
 
@@ -40,6 +45,22 @@ class CoreTester : public Tester {
         addTest(new CropTest());
         addTest(new HistogramTest());
         addTest(new ProjHistTest());
+        addTest(new ViewTest());
+        addTest(new AssignTest());
+        addTest(new StatisticsTest<uint8_t>("Statistics (8 bits)", 0., 255., LAYOUT_PLANAR));
+        addTest(new StatisticsTest<uint8_t>("Statistics (8 bits, interleaved)", 0., 255., LAYOUT_INTERLEAVED, Rectangle(5, 3, 301, 200)));
+        addTest(new StatisticsTest<int16_t>("Statistics (16 bits)", -32000., 64000., LAYOUT_PLANAR, Rectangle(1, 1, 100, 50)));
+        addTest(new StatisticsTest<float>("Statistics (float)", -1., 2., LAYOUT_INTERLEAVED));
+        addTest(new StatisticsTest<double>("Statistics (double, large offset)", 1e9, 1., LAYOUT_PLANAR));
+        addTest(new BinnedHistogramTest<uint8_t>("Histogram by strips (8 bits)", 0., 255., LAYOUT_PLANAR, false, 0, Rectangle(7, 5, 580, 480)));
+        addTest(new BinnedHistogramTest<uint8_t>("Histogram by strips (8 bits, interleaved view)", 0., 255., LAYOUT_INTERLEAVED, true, 0));
+        addTest(new BinnedHistogramTest<int16_t>("Histogram by strips (16 bits)", -32000., 64000., LAYOUT_PLANAR, false, 0, Rectangle(7, 5, 580, 480)));
+        addTest(new BinnedHistogramTest<int16_t>("Histogram by strips (16 bits, 100 bins, view)", -500., 3000., LAYOUT_INTERLEAVED, true, 100, Rectangle(3, 2, 0, 0)));
+        addTest(new BinnedHistogramTest<float>("Histogram by strips (float)", -1., 2., LAYOUT_PLANAR, false, 0, Rectangle(7, 5, 580, 480)));
+        addTest(new BinnedHistogramTest<float>("Histogram by strips (float, 70 bins, view)", 10., 0.5, LAYOUT_INTERLEAVED, true, 70));
+        addTest(new IntegralImageTest<uint8_t>("Integral image (8 bits)", 0., 255., LAYOUT_PLANAR));
+        addTest(new IntegralImageTest<int16_t>("Integral image (16 bits, interleaved)", -32000., 64000., LAYOUT_INTERLEAVED));
+        addTest(new IntegralImageTest<float>("Integral image (float)", -1., 2., LAYOUT_PLANAR));
     }
 
     void clean() {
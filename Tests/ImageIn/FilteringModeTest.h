@@ -0,0 +1,142 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FILTERINGMODETEST_H
+#define FILTERINGMODETEST_H
+
+#include <string>
+#include <sstream>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+#include <Image.h>
+#include <Algorithm/Filtering.h>
+
+#include "Test.h"
+
+/*
+ * Compares a convolution computed in a given mode with MODE_DIRECT on a random image.
+ * MODE_DIRECT itself (which applies separable filters as two passes) is compared with a naive convolution.
+ */
+class FilteringModeTest : public Test {
+  public:
+    typedef imagein::algorithm::Filtering Filtering;
+
+    FilteringModeTest(std::string name, std::vector<imagein::algorithm::Filter*> filters, Filtering::Mode mode, Filtering::Policy policy,
+                      unsigned int width, unsigned int height, double maxDiff)
+        : Test(name), _filters(filters), _mode(mode), _policy(policy), _width(width), _height(height), _img(NULL), _maxDiff(maxDiff), _diff(0.) {}
+
+    bool init() {
+        srand(_width * _height);
+        _img = new imagein::Image_t<double>(_width, _height, 2);
+        for(imagein::Image_t<double>::iterator it = _img->begin(); it < _img->end(); ++it) {
+            *it = rand() % 256;
+        }
+        return true;
+    }
+
+    bool test() {
+        Filtering filtering(_filters);
+        filtering.setMode(_mode);
+        filtering.setPolicy(_policy);
+        imagein::Image_t<double>* result = filtering(_img);
+
+        imagein::Image_t<double>* reference;
+        if(_mode == Filtering::MODE_DIRECT) {
+            reference = convolve(*_filters[0]);
+        }
+        else {
+            Filtering direct(_filters);
+            direct.setMode(Filtering::MODE_DIRECT);
+            direct.setPolicy(_policy);
+            reference = direct(_img);
+        }
+
+        _diff = 0.;
+        for(unsigned int c = 0; c < _img->getNbChannels(); ++c) {
+            for(unsigned int j = 0; j < _height; ++j) {
+                for(unsigned int i = 0; i < _width; ++i) {
+                    _diff = std::max(_diff, std::abs(result->getPixel(i, j, c) - reference->getPixel(i, j, c)));
+                }
+            }
+        }
+        delete result;
+        delete reference;
+        return _diff <= _maxDiff;
+    }
+
+    bool cleanup() {
+        delete _img;
+        for(unsigned int k = 0; k < _filters.size(); ++k) {
+            delete _filters[k];
+        }
+        return true;
+    }
+
+    std::string info() {
+        if(_diff <= _maxDiff) return "";
+        std::ostringstream oss;
+        oss << "max diff = " << _diff;
+        return oss.str();
+    }
+
+  private:
+    //Index of the pixel used for the coordinate i of a line of n pixels, -1 if it is ignored.
+    int index(int i, int n) const {
+        switch(_policy) {
+            case Filtering::POLICY_NEAREST: return std::min(std::max(i, 0), n - 1);
+            case Filtering::POLICY_TOR: return ((i % n) + n) % n;
+            default: return (i >= 0 && i < n) ? i : -1;
+        }
+    }
+
+    imagein::Image_t<double>* convolve(const imagein::algorithm::Filter& filter) const {
+        imagein::Image_t<double>* result = new imagein::Image_t<double>(_width, _height, _img->getNbChannels());
+        const int halfWidth = (filter.getWidth() - 1) / 2;
+        const int halfHeight = (filter.getHeight() - 1) / 2;
+        for(unsigned int c = 0; c < _img->getNbChannels(); ++c) {
+            for(unsigned int y = 0; y < _height; ++y) {
+                for(unsigned int x = 0; x < _width; ++x) {
+                    double sum = 0.;
+                    for(unsigned int j = 0; j < filter.getHeight(); ++j) {
+                        for(unsigned int i = 0; i < filter.getWidth(); ++i) {
+                            const int u = index(static_cast<int>(x + i) - halfWidth, _width);
+                            const int v = index(static_cast<int>(y + j) - halfHeight, _height);
+                            if(u >= 0 && v >= 0) sum += filter.getPixelAt(i, j) * _img->getPixel(u, v, c);
+                        }
+                    }
+                    result->setPixel(x, y, c, sum);
+                }
+            }
+        }
+        return result;
+    }
+
+    std::vector<imagein::algorithm::Filter*> _filters;
+    Filtering::Mode _mode;
+    Filtering::Policy _policy;
+    unsigned int _width;
+    unsigned int _height;
+    imagein::Image_t<double>* _img;
+    double _maxDiff;
+    double _diff;
+};
+
+#endif //!FILTERINGMODETEST_H
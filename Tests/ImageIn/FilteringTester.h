@@ -22,6 +22,7 @@
 
 #include "Tester.h"
 #include "FilteringTest.h"
+#include "FilteringModeTest.h"
 #include <Algorithm/Filtering.h>
 
 using namespace imagein;
@@ -38,12 +39,35 @@ class FilteringTester : public Tester {
     void init() {
         ImageDiff<D> nodiff(0, 0, 0);
         
-        Filtering* gaussian = new Filtering(Filter::gaussian(3));
+        Filtering* gaussian = new Filtering(Filter::gaussian(3.));
         addTest(new FilteringTest<D>("Gaussian blur", gaussian, "res/lena.png", "res/lena_gaussian_16.png", nodiff));
+
+        addTest(new FilteringModeTest("Direct 5x5 filter", randomFilter(5, 5), Filtering::MODE_DIRECT, Filtering::POLICY_BLACK, 67, 45, 1e-6));
+        addTest(new FilteringModeTest("Direct 4x3 filter (tor)", randomFilter(4, 3), Filtering::MODE_DIRECT, Filtering::POLICY_TOR, 67, 45, 1e-6));
+        addTest(new FilteringModeTest("Separable gaussian", Filter::gaussian(7, 1.5), Filtering::MODE_DIRECT, Filtering::POLICY_NEAREST, 67, 45, 1e-6));
+        addTest(new FilteringModeTest("Separable uniform", Filter::uniform(9), Filtering::MODE_DIRECT, Filtering::POLICY_BLACK, 67, 45, 1e-6));
+        addTest(new FilteringModeTest("FFT 5x5 filter", randomFilter(5, 5), Filtering::MODE_FFT, Filtering::POLICY_MIRROR, 67, 45, 1e-6));
+        addTest(new FilteringModeTest("FFT gaussian (tor)", Filter::gaussian(15, 3.), Filtering::MODE_FFT, Filtering::POLICY_TOR, 67, 45, 1e-6));
+        addTest(new FilteringModeTest("FFT bank", Filter::sobel(), Filtering::MODE_FFT, Filtering::POLICY_NEAREST, 67, 45, 1e-6));
+        addTest(new FilteringModeTest("Box 31x31", Filter::uniform(31), Filtering::MODE_AUTO, Filtering::POLICY_BLACK, 200, 150, 1e-6));
+        addTest(new FilteringModeTest("Box 31x31 (nearest)", Filter::uniform(31), Filtering::MODE_AUTO, Filtering::POLICY_NEAREST, 200, 150, 1e-6));
+        addTest(new FilteringModeTest("Box 31x31 (mirror)", Filter::uniform(31), Filtering::MODE_AUTO, Filtering::POLICY_MIRROR, 200, 150, 1e-6));
+        addTest(new FilteringModeTest("Box larger than the image", Filter::uniform(41), Filtering::MODE_AUTO, Filtering::POLICY_NEAREST, 30, 20, 1e-6));
     }
 
     void clean() {
     }
+
+  private:
+    static std::vector<Filter*> randomFilter(unsigned int width, unsigned int height) {
+        Filter* filter = new Filter(width, height);
+        for(unsigned int j = 0; j < height; ++j) {
+            for(unsigned int i = 0; i < width; ++i) {
+                filter->setPixelAt(i, j, (rand() % 21) - 10);
+            }
+        }
+        return std::vector<Filter*>(1, filter);
+    }
 };
 
 
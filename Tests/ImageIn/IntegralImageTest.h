@@ -0,0 +1,177 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INTEGRALIMAGETEST_H
+#define INTEGRALIMAGETEST_H
+
+#include <string>
+#include <sstream>
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <cstdlib>
+
+#include <Rectangle.h>
+#include <Image.h>
+#include <IntegralImage.h>
+#include <ThreadPool.h>
+#include "Test.h"
+
+/*
+ * Compares the sums, sums of squares, means and variances given by the integral image of a random image with a direct
+ * summation over the pixels, for every 1x1 rectangle, for rectangles touching the borders or crossing them, and for random ones.
+ * The sums of 8 and 16 bits values are exact, the others are compared within the rounding errors of the table.
+ */
+template<typename D>
+class IntegralImageTest : public Test {
+
+  public:
+
+    IntegralImageTest(std::string name, double offset, double spread, imagein::Layout layout)
+        : Test(name), _offset(offset), _spread(spread), _layout(layout), _img(NULL), _failure("") {}
+
+    virtual bool init() {
+        srand(3);
+        imagein::Image_t<D> img(211, 157, 3, D());
+        for(typename imagein::Image_t<D>::iterator it = img.begin(); it < img.end(); ++it) {
+            *it = static_cast<D>(_offset + _spread * (rand() / static_cast<double>(RAND_MAX)));
+        }
+        _img = new imagein::Image_t<D>(img, _layout, true);
+        return true;
+    }
+
+    virtual bool test() {
+        imagein::ThreadPool& pool = imagein::ThreadPool::instance();
+        const unsigned int nThreads = pool.getNbThreads();
+        pool.setNbThreads(4);
+        imagein::IntegralImage_t<D>* integral = NULL;
+        try {
+            integral = new imagein::IntegralImage_t<D>(*_img, 1);
+        }
+        catch(...) {
+            pool.setNbThreads(nThreads);
+            throw;
+        }
+        pool.setNbThreads(nThreads);
+
+        const unsigned int width = _img->getWidth(), height = _img->getHeight();
+        //The errors of the table grow with the sums it stores.
+        double total = 0., totalOfSquares = 0.;
+        for(unsigned int j = 0; j < height; ++j) {
+            for(unsigned int i = 0; i < width; ++i) {
+                const double v = _img->getPixel(i, j, 1);
+                total += std::abs(v);
+                totalOfSquares += v * v;
+            }
+        }
+        const bool exact = std::numeric_limits<D>::is_integer && sizeof(D) <= 2;
+        _sumTolerance = exact ? 0. : 1e-9 * total;
+        _squareTolerance = exact ? 0. : 1e-9 * totalOfSquares;
+
+        std::vector<imagein::Rectangle> rects;
+        rects.push_back(imagein::Rectangle());
+        rects.push_back(imagein::Rectangle(0, 0, 17, 9));
+        rects.push_back(imagein::Rectangle(40, 0, 0, 12));
+        rects.push_back(imagein::Rectangle(0, 30, 25, 0));
+        rects.push_back(imagein::Rectangle(width - 1, height - 1, 1, 1));
+        rects.push_back(imagein::Rectangle(width - 5, height - 3, 0, 0));
+        rects.push_back(imagein::Rectangle(width - 10, height - 10, 50, 50));
+        rects.push_back(imagein::Rectangle(width + 3, 2, 4, 4));
+        for(unsigned int k = 0; k < 100; ++k) {
+            const unsigned int x = rand() % width, y = rand() % height;
+            rects.push_back(imagein::Rectangle(x, y, 1 + rand() % (width - x), 1 + rand() % (height - y)));
+        }
+        bool success = true;
+        for(unsigned int k = 0; k < rects.size() && success; ++k) {
+            success = check(*integral, rects[k]);
+        }
+        for(unsigned int j = 0; j < height && success; ++j) {
+            for(unsigned int i = 0; i < width && success; ++i) {
+                success = check(*integral, imagein::Rectangle(i, j, 1, 1));
+            }
+        }
+        delete integral;
+        return success;
+    }
+
+    virtual bool cleanup() {
+        delete _img;
+        return true;
+    }
+
+    virtual std::string info() {
+        return _failure;
+    }
+
+  protected:
+    bool check(const imagein::IntegralImage_t<D>& integral, const imagein::Rectangle& rect) {
+        const unsigned int x0 = std::min(rect.x, _img->getWidth()), y0 = std::min(rect.y, _img->getHeight());
+        const unsigned int x1 = std::max(x0, rect.w > 0 ? std::min(rect.x + rect.w, _img->getWidth()) : _img->getWidth());
+        const unsigned int y1 = std::max(y0, rect.h > 0 ? std::min(rect.y + rect.h, _img->getHeight()) : _img->getHeight());
+        double sum = 0., sumOfSquares = 0.;
+        for(unsigned int j = y0; j < y1; ++j) {
+            for(unsigned int i = x0; i < x1; ++i) {
+                const double v = _img->getPixel(i, j, 1);
+                sum += v;
+                sumOfSquares += v * v;
+            }
+        }
+        const double count = static_cast<double>(x1 - x0) * (y1 - y0);
+        double variance = 0.;
+        if(count > 0) {
+            for(unsigned int j = y0; j < y1; ++j) {
+                for(unsigned int i = x0; i < x1; ++i) {
+                    const double delta = _img->getPixel(i, j, 1) - sum / count;
+                    variance += delta * delta;
+                }
+            }
+            variance /= count;
+        }
+
+        std::ostringstream oss;
+        if(std::abs(static_cast<double>(integral.sum(rect)) - sum) > _sumTolerance) {
+            oss << "sum " << integral.sum(rect) << " != " << sum;
+        }
+        else if(std::abs(static_cast<double>(integral.sumOfSquares(rect)) - sumOfSquares) > _squareTolerance) {
+            oss << "sum of squares " << integral.sumOfSquares(rect) << " != " << sumOfSquares;
+        }
+        else if(count > 0 && std::abs(integral.mean(rect) - sum / count) > 1e-9 * (std::abs(sum / count) + 1.) + _sumTolerance / count) {
+            oss << "mean " << integral.mean(rect) << " != " << sum / count;
+        }
+        else if(std::abs(integral.variance(rect) - variance) > 1e-6 * (variance + 1.) + _squareTolerance / std::max(count, 1.)) {
+            oss << "variance " << integral.variance(rect) << " != " << variance;
+        }
+        if(!oss.str().empty()) {
+            oss << " on (" << rect.x << ", " << rect.y << ", " << rect.w << ", " << rect.h << ")";
+            _failure = oss.str();
+            return false;
+        }
+        return true;
+    }
+
+    double _offset;
+    double _spread;
+    imagein::Layout _layout;
+    imagein::Image_t<D>* _img;
+    double _sumTolerance;
+    double _squareTolerance;
+    std::string _failure;
+};
+
+#endif //!INTEGRALIMAGETEST_H
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LOOKUPTABLETEST_H
+#define LOOKUPTABLETEST_H
+
+#include <string>
+#include <sstream>
+#include <vector>
+#include <cstdlib>
+
+#include <Image.h>
+#include <SubImage.h>
+#include <Rectangle.h>
+#include <LookupTable.h>
+#include "Test.h"
+
+/*
+ * Applies a random table to a buffer, to a view with a row stride and in place through a view,
+ * and compares the results with table[v] for each value.
+ * The widths aren't multiples of 32, so that the vector loops leave a tail.
+ */
+class LookupTableTest : public Test {
+
+  public:
+
+    LookupTableTest(std::string name, imagein::Layout layout, bool alignRows)
+        : Test(name), _layout(layout), _alignRows(alignRows), _img(NULL), _failure("") {}
+
+    virtual bool init() {
+        srand(11);
+        for(unsigned int v = 0; v < 256; ++v) {
+            _table[v] = static_cast<uint8_t>(rand());
+        }
+        _img = new imagein::Image(131, 37, 3, NULL, _layout, _alignRows);
+        for(imagein::Image::iterator it = _img->begin(); it < _img->end(); ++it) {
+            *it = static_cast<uint8_t>(rand());
+        }
+        return true;
+    }
+
+    virtual bool test() {
+        const imagein::Rectangle rect(3, 2, 77, 30);
+
+        //A buffer starting on an odd address.
+        std::vector<uint8_t> values(1 + 1037), results(values.size());
+        for(unsigned int i = 0; i < values.size(); ++i) {
+            values[i] = static_cast<uint8_t>(rand());
+        }
+        _table.apply(&values[1], &results[1], values.size() - 1);
+        for(unsigned int i = 1; i < values.size(); ++i) {
+            if(results[i] != _table[values[i]]) return fail("buffer", i, 0, 0);
+        }
+
+        const imagein::SubImage view(*_img, rect);
+        imagein::Image result(rect.w, rect.h, 3, NULL, _layout, false);
+        _table.apply(view, result);
+        for(unsigned int c = 0; c < 3; ++c) {
+            for(unsigned int j = 0; j < rect.h; ++j) {
+                for(unsigned int i = 0; i < rect.w; ++i) {
+                    if(result.getPixel(i, j, c) != _table[view.getPixel(i, j, c)]) return fail("view", i, j, c);
+                }
+            }
+        }
+
+        //In place through a view : the values out of the view must not change.
+        imagein::Image target(*_img);
+        imagein::SubImage targetView(target, rect);
+        _table.applyInPlace(targetView);
+        for(unsigned int c = 0; c < 3; ++c) {
+            for(unsigned int j = 0; j < _img->getHeight(); ++j) {
+                for(unsigned int i = 0; i < _img->getWidth(); ++i) {
+                    const bool inside = i >= rect.x && i < rect.x + rect.w && j >= rect.y && j < rect.y + rect.h;
+                    const uint8_t value = _img->getPixel(i, j, c);
+                    if(target.getPixel(i, j, c) != (inside ? _table[value] : value)) return fail("in place", i, j, c);
+                }
+            }
+        }
+        return true;
+    }
+
+    virtual bool cleanup() {
+        delete _img;
+        return true;
+    }
+
+    virtual std::string info() {
+        return _failure;
+    }
+
+  protected:
+    bool fail(const std::string& what, unsigned int i, unsigned int j, unsigned int c) {
+        std::ostringstream oss;
+        oss << what << " differs at (" << i << ", " << j << ", " << c << ")";
+        _failure = oss.str();
+        return false;
+    }
+
+    imagein::Layout _layout;
+    bool _alignRows;
+    imagein::LookupTable _table;
+    imagein::Image* _img;
+    std::string _failure;
+};
+
+#endif //!LOOKUPTABLETEST_H
@@ -22,6 +22,7 @@
 
 #include "Tester.h"
 #include "AlgorithmTest.h"
+#include "BinaryMorphoTest.h"
 #include <Algorithm/MorphoMat.h>
 
 using namespace imagein;
@@ -39,8 +40,8 @@ class MorphoMatTester : public Tester {
         
         ImageDiff<D> nodiff(0, 0, 0);
         
-        StructElem<depth_default_t> d15("res/diamond15x15.png");
-        StructElem<depth_default_t> d3("res/diamond3x3.png");
+        StructElem d15("res/diamond15x15.png");
+        StructElem d3("res/diamond3x3.png");
         
         //addTest(new AlgorithmTest<D>("Erosion d15", new Erosion<D>(d15), "res/rose.png", "res/rose_erosion_diamond15x15.png", nodiff));
         //addTest(new AlgorithmTest<D>("Dilatation d15", new Dilatation<D>(d15), "res/rose.png", "res/rose_dilatation_diamond15x15.png", nodiff));
@@ -59,6 +60,20 @@ class MorphoMatTester : public Tester {
         addTest(new AlgorithmTest<D>("Black Top Hat d15 on M", new BlackTopHat<D>(d15), "res/M.png", "res/M_btophat_d15.png", nodiff));
         addTest(new AlgorithmTest<D>("Gradient d3 on rose", new Gradient<D>(d3), "res/rose.png", "res/rose_gradient_diamond3x3.png", nodiff));
         addTest(new AlgorithmTest<D>("Gradient d3 on lena", new Gradient<D>(d3), "res/lena.png", "res/lena_gradient_d3.png", nodiff));
+
+        GrayscaleImage_t<bool> holed(5, 3);
+        for(unsigned int j = 0; j < 3; ++j) {
+            for(unsigned int i = 0; i < 5; ++i) {
+                holed.setPixel(i, j, (i + j) % 3 != 0);
+            }
+        }
+        StructElem scaled(holed, 4, 0);
+        scaled.setScale(3);
+        addTest(new BinaryMorphoTest("Binary image d3 on 1x40", 1, 40, d3));
+        addTest(new BinaryMorphoTest("Binary image d15 on 63x37", 63, 37, d15));
+        addTest(new BinaryMorphoTest("Binary image d15 on 65x20", 65, 20, d15));
+        addTest(new BinaryMorphoTest("Binary image d15 on 200x9", 200, 9, d15));
+        addTest(new BinaryMorphoTest("Binary image scaled element on 129x50", 129, 50, scaled));
     }
 
     void clean() {
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PIXELPIPELINETEST_H
+#define PIXELPIPELINETEST_H
+
+#include <string>
+#include <sstream>
+#include <cmath>
+#include <cstdlib>
+
+#include <Image.h>
+#include <SubImage.h>
+#include <Rectangle.h>
+#include <PixelPipeline.h>
+#include "Test.h"
+
+/*
+ * Applies fused pipeline expressions to a random image, or to a view of it, and compares them with the same operations
+ * written as a loop over the pixels.
+ */
+class PixelPipelineTest : public Test {
+
+  public:
+    typedef imagein::depth_default_t D;
+
+    PixelPipelineTest(std::string name, imagein::Layout layout, bool view)
+        : Test(name), _layout(layout), _view(view), _img(NULL), _failure("") {}
+
+    virtual bool init() {
+        srand(13);
+        _img = new imagein::Image(97, 61, 3, NULL, _layout, true);
+        for(imagein::Image::iterator it = _img->begin(); it < _img->end(); ++it) {
+            *it = static_cast<D>(rand());
+        }
+        return true;
+    }
+
+    virtual bool test() {
+        using namespace imagein::pipeline;
+        const imagein::Rectangle rect = _view ? imagein::Rectangle(5, 3, 77, 50) : imagein::Rectangle(0, 0, _img->getWidth(), _img->getHeight());
+        imagein::Image target(*_img);
+        const imagein::SubImage source(*_img, rect);
+        imagein::SubImage targetView(target, rect);
+
+        //Value operations, on each channel.
+        imagein::Image* values = apply(source, Inversion<D>() >> BitPlane<D>(0x3C) >> Binarization<D>(10, 40, true));
+        applyInPlace(targetView, Inversion<D>() >> BitPlane<D>(0x3C) >> Binarization<D>(10, 40, true));
+        //A reduction of the channels, followed by value operations.
+        imagein::GrayscaleImage* gray = apply(source, Grayscale<D>() >> Inversion<D>() >> Binarization<D>(100));
+
+        const int wr = static_cast<int>(std::floor(0.299 * 16384. + 0.5));
+        const int wg = static_cast<int>(std::floor(0.587 * 16384. + 0.5));
+        const int wb = static_cast<int>(std::floor(0.114 * 16384. + 0.5));
+        std::ostringstream oss;
+        for(unsigned int j = 0; j < rect.h && oss.str().empty(); ++j) {
+            for(unsigned int i = 0; i < rect.w && oss.str().empty(); ++i) {
+                for(unsigned int c = 0; c < 3; ++c) {
+                    const D masked = static_cast<D>(~_img->getPixel(rect.x + i, rect.y + j, c)) & 0x3C;
+                    //As algorithm::Binarization_t, the values in the band are white when blackBand is true.
+                    const D expected = (masked > 10 && masked < 40) ? 255 : 0;
+                    if(values->getPixel(i, j, c) != expected) {
+                        oss << "values at (" << i << ", " << j << ", " << c << ")";
+                        break;
+                    }
+                    if(target.getPixel(rect.x + i, rect.y + j, c) != expected) {
+                        oss << "in place at (" << i << ", " << j << ", " << c << ")";
+                        break;
+                    }
+                }
+                const int sum = (wr * _img->getPixel(rect.x + i, rect.y + j, 0) + wg * _img->getPixel(rect.x + i, rect.y + j, 1)
+                              + wb * _img->getPixel(rect.x + i, rect.y + j, 2)) >> 14;
+                const D inverted = static_cast<D>(~static_cast<D>(std::min(sum, 255)));
+                if(gray->getPixel(i, j) != (inverted <= 100 ? 0 : 255)) {
+                    oss << "reduction at (" << i << ", " << j << ")";
+                }
+            }
+        }
+        //The values out of the view must not change.
+        for(unsigned int j = 0; j < _img->getHeight() && oss.str().empty(); ++j) {
+            for(unsigned int i = 0; i < _img->getWidth(); ++i) {
+                const bool inside = i >= rect.x && i < rect.x + rect.w && j >= rect.y && j < rect.y + rect.h;
+                if(!inside && target.getPixel(i, j, 1) != _img->getPixel(i, j, 1)) {
+                    oss << "in place out of the view at (" << i << ", " << j << ")";
+                    break;
+                }
+            }
+        }
+        delete values;
+        delete gray;
+        _failure = oss.str();
+        return _failure.empty();
+    }
+
+    virtual bool cleanup() {
+        delete _img;
+        return true;
+    }
+
+    virtual std::string info() {
+        return _failure;
+    }
+
+  protected:
+    imagein::Layout _layout;
+    bool _view;
+    imagein::Image* _img;
+    std::string _failure;
+};
+
+#endif //!PIXELPIPELINETEST_H
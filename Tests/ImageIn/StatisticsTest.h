@@ -0,0 +1,112 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef STATISTICSTEST_H
+#define STATISTICSTEST_H
+
+#include <string>
+#include <sstream>
+#include <cmath>
+#include <cstdlib>
+
+#include <Rectangle.h>
+#include <Image.h>
+#include <ImageStatistics.h>
+#include "Test.h"
+
+/*
+ * Compares the statistics of each channel of a random image with a two passes computation over the pixels.
+ */
+template<typename D>
+class StatisticsTest : public Test {
+
+  public:
+
+    StatisticsTest(std::string name, double offset, double spread, imagein::Layout layout, const imagein::Rectangle& rect = imagein::Rectangle())
+        : Test(name), _offset(offset), _spread(spread), _layout(layout), _rect(rect), _img(NULL), _failure("") {}
+
+    virtual bool init() {
+        srand(7);
+        imagein::Image_t<D> img(333, 211, 3, D());
+        for(typename imagein::Image_t<D>::iterator it = img.begin(); it < img.end(); ++it) {
+            *it = static_cast<D>(_offset + _spread * (rand() / static_cast<double>(RAND_MAX)));
+        }
+        _img = new imagein::Image_t<D>(img, _layout, true);
+        return true;
+    }
+
+    virtual bool test() {
+        const imagein::ImageStatistics statistics = _img->getStatistics(_rect);
+        const unsigned int x0 = _rect.x, y0 = _rect.y;
+        const unsigned int x1 = _rect.w > 0 ? _rect.x + _rect.w : _img->getWidth();
+        const unsigned int y1 = _rect.h > 0 ? _rect.y + _rect.h : _img->getHeight();
+        for(unsigned int c = 0; c < _img->getNbChannels(); ++c) {
+            double min = _img->getPixel(x0, y0, c), max = min, sum = 0.;
+            for(unsigned int j = y0; j < y1; ++j) {
+                for(unsigned int i = x0; i < x1; ++i) {
+                    const double value = _img->getPixel(i, j, c);
+                    min = std::min(min, value);
+                    max = std::max(max, value);
+                    sum += value;
+                }
+            }
+            const unsigned int count = (x1 - x0) * (y1 - y0);
+            const double mean = sum / count;
+            double deviations = 0.;
+            for(unsigned int j = y0; j < y1; ++j) {
+                for(unsigned int i = x0; i < x1; ++i) {
+                    const double delta = _img->getPixel(i, j, c) - mean;
+                    deviations += delta * delta;
+                }
+            }
+            const double deviation = std::sqrt(deviations / count);
+
+            const imagein::ChannelStatistics& stats = statistics[c];
+            std::ostringstream oss;
+            if(stats.count != count) oss << "count " << stats.count << " != " << count;
+            else if(stats.min != min || stats.max != max) oss << "extrema " << stats.min << ":" << stats.max << " != " << min << ":" << max;
+            else if(std::abs(stats.mean() - mean) > 1e-9 * (std::abs(mean) + 1.)) oss << "mean " << stats.mean() << " != " << mean;
+            else if(std::abs(stats.deviation() - deviation) > 1e-6 * (deviation + 1e-9)) oss << "deviation " << stats.deviation() << " != " << deviation;
+            if(!oss.str().empty()) {
+                _failure = oss.str();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    virtual bool cleanup() {
+        delete _img;
+        return true;
+    }
+
+    virtual std::string info() {
+        return _failure;
+    }
+
+  protected:
+    double _offset;
+    double _spread;
+    imagein::Layout _layout;
+    imagein::Rectangle _rect;
+    imagein::Image_t<D>* _img;
+    std::string _failure;
+};
+
+#endif //!STATISTICSTEST_H
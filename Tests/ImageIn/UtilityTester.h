@@ -23,6 +23,8 @@
 #include "Tester.h"
 #include "AlgorithmTest.h"
 #include "BitPlaneTest.h"
+#include "LookupTableTest.h"
+#include "PixelPipelineTest.h"
 #include <Algorithm/Identity.h>
 #include <Algorithm/Inversion.h>
 #include <Algorithm/Average.h>
@@ -47,6 +49,11 @@ class UtilityTester : public Tester {
         addTest(new AlgorithmTest<D, 2>("Difference", new Difference<Image_t<D> >(), "res/lena_white.png", "res/lena_inverted.png", "res/lena.png", nodiff));
         addTest(new AlgorithmTest<D, 2>("Average", new Average<Image_t<D>, 2>(), "res/lena.png", "res/lena_inverted.png", "res/lena_gray127.png", nodiff));
         addTest(new BitPlaneTest<D>(_refImg));
+        addTest(new LookupTableTest("Lookup table (planar)", LAYOUT_PLANAR, true));
+        addTest(new LookupTableTest("Lookup table (interleaved)", LAYOUT_INTERLEAVED, false));
+        addTest(new PixelPipelineTest("Pixel pipeline (planar view)", LAYOUT_PLANAR, true));
+        addTest(new PixelPipelineTest("Pixel pipeline (interleaved)", LAYOUT_INTERLEAVED, false));
+        addTest(new PixelPipelineTest("Pixel pipeline (interleaved view)", LAYOUT_INTERLEAVED, true));
     }
 
     void clean() {
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2011-2012 Benoit Averty, Samuel Babin, Matthieu Bergere, Thomas Letan, Sacha Percot-Tétu, Florian Teyssier
+ * 
+ * This file is part of DETIQ-T.
+ * 
+ * DETIQ-T is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * DETIQ-T is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with DETIQ-T.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef VIEWTEST_H
+#define VIEWTEST_H
+
+#include <string>
+
+#include <Rectangle.h>
+#include <Image.h>
+#include <SubImage.h>
+#include <Converter.h>
+#include "Test.h"
+
+/*
+ * Checks that writing through a view only changes the image it was made on, when its buffer is shared.
+ */
+class ViewTest : public Test {
+
+  public:
+    typedef unsigned char D;
+    typedef imagein::SubImage_t<imagein::Image_t<D> > View;
+
+    ViewTest()
+        : Test("Views of shared images"), _failure("") {}
+
+    virtual bool init() {
+        return true;
+    }
+
+    virtual bool test() {
+        const imagein::Rectangle rect(2, 2, 4, 4);
+
+        //View of a shared buffer
+        imagein::Image_t<D> a(8, 8, 1, D(10)), b;
+        b.share(a);
+        View v(a, rect);
+        v.setPixel(0, 0, 0, 200);
+        if(a.getPixel(2, 2, 0) != 200 || b.getPixel(2, 2, 0) != 10) _failure = "view of a shared buffer";
+
+        //Buffer shared after a view was made on it
+        imagein::Image_t<D> c(8, 8, 1, D(10)), d;
+        View w(c, rect);
+        d.share(c);
+        w.setPixel(0, 0, 0, 200);
+        if(c.getPixel(2, 2, 0) != 200 || d.getPixel(2, 2, 0) != 10) _failure = "buffer shared after a view";
+
+        //View of the result of an identity conversion
+        imagein::Image_t<D> e(8, 8, 1, D(10));
+        imagein::Image_t<D>* f = imagein::Converter<imagein::Image_t<D> >::convert(e);
+        View x(*f, rect);
+        x.setPixel(0, 0, 0, 200);
+        if(e.getPixel(2, 2, 0) != 10 || f->getPixel(2, 2, 0) != 200) _failure = "view of a converted image";
+        delete f;
+
+        return _failure.empty();
+    }
+
+    virtual bool cleanup() {
+        return true;
+    }
+
+    virtual std::string info() {
+        return _failure;
+    }
+
+  protected:
+    std::string _failure;
+};
+
+#endif //!VIEWTEST_H